@@ -0,0 +1,160 @@
+import time
+from RainPots import PacketDecoder
+from RainPots import SerialSender
+
+
+class Negotiator:
+    """
+    Negotiates the baud rate of the board chain with the 0xEA LINK BAUD command (see documentation.txt).
+    Steps up through the candidate rates: every board switches on TRY, VERIFY checks the links in both
+    directions with test patterns, CONFIRM keeps the rate. Boards go back to the last confirmed rate on their own
+    when the CONFIRM does not arrive, so the first rate that fails ends the search.
+    """
+    # Same table as LINK_BAUD_RATES in the firmware (LinkCtl.h)
+    RATES = [380400, 460800, 921600, 1000000, 1500000, 2000000]
+    ACTION_TRY = 0
+    ACTION_VERIFY = 1
+    ACTION_CONFIRM = 2
+    ACTION_REPORT = 3
+    PATTERN = [0x55, 0x2A, 0x7F, 0x00, 0x33, 0x4C]
+    UPSTREAM_PATTERN = [0x2AAA, 0x1555, 0x3FFF, 0x0000]
+    ERRORS_UART0 = 0x3B
+    ERRORS_UART1 = 0x3C
+    UPSTREAM_PATTERN_CC = 0x3D
+    STATUS_CC = 0x3E
+    STATUS_OK_BIT = 13
+    STATUS_CONFIRMED_BIT = 12
+    SWITCH_DELAY = 0.05  # LINK_BAUD_SWITCH_DELAY_US
+    CONFIRM_TIMEOUT = 1.0  # LINK_BAUD_CONFIRM_TIMEOUT_US
+    ANSWER_TIMEOUT = 0.2
+    CONFIRM_ATTEMPTS = 3  # Verify answers included, well within CONFIRM_TIMEOUT
+
+    def __init__(self, params, serial_port, debug: bool):
+        self.param = params
+        self.serial_port = serial_port
+        self.debug = debug
+        self.units = sorted(int(unit_index) for unit_index in self.param.get_config().keys())
+        self.rate_index = 0
+        self.link_errors = {}
+
+    def negotiate(self, max_rate: int = RATES[-1]) -> int:
+        """
+        Settle the chain on the highest candidate rate up to max_rate that every configured board passes.
+        Returns the baud rate in use
+        """
+        if not self.units:
+            return self.RATES[self.rate_index]
+        for rate_index in range(self.rate_index + 1, len(self.RATES)):
+            if self.RATES[rate_index] > max_rate:
+                break
+            self._send_all(self.ACTION_TRY, rate_index)
+            switch_time = time.time()
+            time.sleep(self.SWITCH_DELAY * 2)
+            self._set_port_rate(rate_index)
+            if self.verify(rate_index) and self.confirm(rate_index):
+                self.rate_index = rate_index
+                if self.debug:
+                    print("Link rate %d verified" % self.RATES[rate_index])
+                continue
+            if self.debug:
+                print("Link rate %d failed" % self.RATES[rate_index])
+            # Boards that confirmed the new rate do not go back on their own, the others do when their
+            # confirm timeout runs out. Both end up at the last rate and have to confirm it again
+            self._send_all(self.ACTION_TRY, self.rate_index)
+            time.sleep(max(0.0, switch_time + self.CONFIRM_TIMEOUT + self.SWITCH_DELAY * 2 - time.time()))
+            self._set_port_rate(self.rate_index)
+            if self.rate_index > 0:
+                self.confirm(self.rate_index)
+            break
+        # Every board has to answer at the settled rate
+        if not self.verify(self.rate_index):
+            self.fallback()
+        return self.RATES[self.rate_index]
+
+    def fallback(self) -> None:
+        """
+        Back to the power up rate: ask the boards at the current rate, then the ones that are at the default already
+        """
+        print("Link rate negotiation failed - using %d baud, power cycle the boards if some stay silent"
+              % self.RATES[0])
+        self._send_all(self.ACTION_TRY, 0)
+        time.sleep(self.SWITCH_DELAY * 2)
+        self.rate_index = 0
+        self._set_port_rate(0)
+        self._send_all(self.ACTION_TRY, 0)
+        time.sleep(self.SWITCH_DELAY * 2)
+
+    def confirm(self, rate_index: int) -> bool:
+        """
+        CONFIRM until every board reports the rate as confirmed, within the confirm timeout of the boards.
+        A board reverting on its own would cut off the boards behind it at the new rate
+        """
+        for _ in range(self.CONFIRM_ATTEMPTS):
+            self._send_all(self.ACTION_CONFIRM, rate_index)
+            if self.verify(rate_index, confirmed=True):
+                return True
+        return False
+
+    def verify(self, rate_index: int, confirmed: bool = False) -> bool:
+        self.serial_port.reset_input_buffer()
+        self._send_all(self.ACTION_VERIFY, rate_index, self.PATTERN)
+        patterns = {unit: [] for unit in self.units}
+        passed = set()
+        for packet in self._read_packets(self.ANSWER_TIMEOUT, lambda: len(passed) == len(self.units)):
+            unit = packet[0] & 0x0f
+            value = (packet[3] << 7) | packet[2]
+            if unit not in patterns:
+                continue
+            if packet[1] == self.UPSTREAM_PATTERN_CC:
+                patterns[unit].append(value)
+            elif packet[1] == self.STATUS_CC:
+                if value & (1 << self.STATUS_OK_BIT) and (value & 0x0f) == rate_index \
+                        and (not confirmed or value & (1 << self.STATUS_CONFIRMED_BIT)) \
+                        and patterns[unit] == self.UPSTREAM_PATTERN:
+                    passed.add(unit)
+        if self.debug and len(passed) != len(self.units):
+            print("No link verification from boards", sorted(set(self.units) - passed))
+        return len(passed) == len(self.units)
+
+    def report_errors(self) -> dict:
+        """
+        Receive error counters of both links of every board: {unit: [towards the Pi, to the previous board]}
+        """
+        self._send_all(self.ACTION_REPORT, self.rate_index)
+        self.link_errors = {}
+        for packet in self._read_packets(self.ANSWER_TIMEOUT, lambda: len(self.link_errors) == len(self.units)
+                                         and all(None not in e for e in self.link_errors.values())):
+            unit = packet[0] & 0x0f
+            value = (packet[3] << 7) | packet[2]
+            if packet[1] in (self.ERRORS_UART0, self.ERRORS_UART1):
+                self.link_errors.setdefault(unit, [None, None])[packet[1] - self.ERRORS_UART0] = value
+        return self.link_errors
+
+    def _send_all(self, action: int, rate_index: int, pattern: list = None) -> None:
+        # One multicast frame for all boards: every board gets its command at the same time
+        command_values = [234,  # 0xEA = LINK BAUD (DECIMAL 234)
+                          action,  # Data Byte 1: Action
+                          rate_index]  # Data Byte 2: Rate Index
+        command_values.extend(pattern if pattern is not None else [0] * len(self.PATTERN))
+        if self.debug:
+            print("Sending Command Link Baud: ", action, rate_index)
+        self.serial_port.write(bytes(SerialSender.Sender.multicast_frame(
+            self.units, SerialSender.Sender.MULTICAST_SEQ_UNTRACKED, command_values)))
+        self.serial_port.flush()
+
+    def _set_port_rate(self, rate_index: int) -> None:
+        self.serial_port.baudrate = self.RATES[rate_index]
+        self.serial_port.reset_input_buffer()
+
+    def _read_packets(self, timeout: float, done):
+        decoder = PacketDecoder.Decoder()
+        deadline = time.time() + timeout
+        while time.time() < deadline and not done():
+            waiting = self.serial_port.inWaiting()
+            if waiting == 0:
+                time.sleep(0.001)
+                continue
+            for int_value in self.serial_port.read(waiting):
+                packet = decoder.feed(int_value)
+                if packet is not None:
+                    yield packet
@@ -0,0 +1,66 @@
+class Decoder:
+    """
+    Decodes the upstream control change stream of the boards. Reads the legacy format, [status, cc, lsb, msb] per
+    message, and the compact format with running status, where a message is either
+        long:  [cc, lsb, msb]                cc 0x00 - 0x3F
+        short: [0x40 | v8_7 << 4 | cc, v6_0]  cc 0x00 - 0x0F, values 0 - 511
+    and the status byte is only sent when it changes, and batch frames
+        [0xA0 | board, count, count messages]
+    with the messages encoded as above. Every decoded message is returned as a legacy packet.
+    """
+    SHORT_FLAG = 0x40
+    WIRE_FORMAT_ACK = 0x3F  # Controller index of the answer to the 0xE9 WIRE FORMAT command
+
+    def __init__(self):
+        self.status = None  # Running status, None: unknown
+        self.message = []
+        self.message_length = 0
+        self.batch_header = False  # Batch frame status received, the count byte is next
+        self.batch_left = 0  # Messages still missing of the batch frame
+
+    def reset(self) -> None:
+        self.status = None
+        self.message = []
+        self.message_length = 0
+        self.batch_header = False
+        self.batch_left = 0
+
+    def feed(self, int_value: int):
+        """
+        Feed one received byte. Returns a packet [status, cc, lsb, msb] when the byte completes a message, else None
+        """
+        if int_value & 0x80:
+            # Status byte: any status ends the message. Only control change (B0 - BF) starts a running status
+            self.message = []
+            self.message_length = 0
+            self.status = int_value if 176 <= int_value <= 191 else None
+            self.batch_header = False
+            self.batch_left = 0
+            if 160 <= int_value <= 175:  # A0 - AF (Batch Frame)
+                self.status = 0xB0 | (int_value & 0x0F)
+                self.batch_header = True
+            return None
+        if self.batch_header:
+            self.batch_header = False
+            self.batch_left = int_value
+            if self.batch_left == 0:
+                self.status = None
+            return None
+        if self.status is None:
+            return None
+        if not self.message:
+            self.message_length = 2 if int_value & self.SHORT_FLAG else 3
+        self.message.append(int_value)
+        if len(self.message) < self.message_length:
+            return None
+        message = self.message
+        self.message = []
+        status = self.status
+        if self.batch_left > 0:
+            self.batch_left -= 1
+            if self.batch_left == 0:
+                # There is no running status after a batch frame
+                self.status = None
+        if self.message_length == 2:
+            return [status, message[0] & 0x0F, message[1], (message[0] >> 4) & 0x03]
+        return [status, message[0], message[1], message[2]]
@@ -14,6 +14,8 @@ class ParamConfig:
         self.PICKUP_VALUE_LOCKED = 0
         self.PICKUP_VALUE_UP = 1
         self.PICKUP_VALUE_DOWN = 2
+        # Knob output resolution in bits (9 - 14), set per parameter with "resolution" in the rainpots meta
+        self.DEFAULT_RESOLUTION = 9
         for i in range(16):
             self.controller_states.append(self.PICKUP_VALUE_LOCKED)
             self.controller_states_sent.append(False)
@@ -61,7 +63,7 @@ class ParamConfig:
             for controller_index, controller_setting in controller_config.items():
                 if self.debug:
                     print("\tCtl: ", controller_index, controller_setting['path'], "center: ",
-                          controller_setting['center'])
+                          controller_setting['center'], "resolution: ", controller_setting['resolution'])
                 self.values_by_path[controller_setting['path']] = None
         if self.debug:
             print()
@@ -89,11 +91,15 @@ class ParamConfig:
                             center = False
                             if 'center' in rainpots_config:
                                 center = (rainpots_config['center'] > 0)
+                            resolution = self.DEFAULT_RESOLUTION
+                            if 'resolution' in rainpots_config:
+                                resolution = int(rainpots_config['resolution'])
                             ctl_index = rainpots_config['ctl']
                             if unit_index not in param_path_dict.keys():
                                 param_path_dict[unit_index] = {}
                             if ctl_index not in param_path_dict[unit_index].keys():
-                                param_path_dict[unit_index][ctl_index] = {'path': full_path, 'center': center}
+                                param_path_dict[unit_index][ctl_index] = {'path': full_path, 'center': center,
+                                                                          'resolution': resolution}
 
             else:
                 sub_dict = self._parse_params(value['CONTENTS'])
@@ -113,7 +119,10 @@ class ParamConfig:
 
         if rainpots_unit in self.config.keys():
             if controller in self.config[rainpots_unit]:
-                normalized_value = value / 511
+                resolution = self.config[rainpots_unit][controller].get('resolution', self.DEFAULT_RESOLUTION)
+                if self.is_button(controller):
+                    resolution = self.DEFAULT_RESOLUTION
+                normalized_value = value / ((1 << resolution) - 1)
                 if self.config[rainpots_unit][controller]['center']:
                     if abs(normalized_value - 0.5) <= center_margin:
                         normalized_value = 0.5
@@ -4,11 +4,30 @@ import sys
 
 
 class Sender:
+    # Upstream wire formats, see documentation.txt (0xE9 = WIRE FORMAT)
+    WIRE_FORMAT_LEGACY = 0
+    WIRE_FORMAT_COMPACT = 1
+    WIRE_FORMAT_BATCH = 2
+    WIRE_FORMAT_ACK_TIMEOUT = 1.0  # Seconds
+    # Multicast frames, see documentation.txt (0xD0 = MULTICAST)
+    MULTICAST_START = 208  # 0xD0
+    MULTICAST_GROUP_SIZE = 7  # Boards per mask byte
+    MULTICAST_SEQ_COUNT = 31  # Sequence numbers 0 - 30 are tracked
+    MULTICAST_SEQ_UNTRACKED = 31  # For commands that are checked otherwise, their acks are ignored
+    MULTICAST_ACK = 0x3A  # Controller index of the merged upstream acks
+    MULTICAST_ACK_TIMEOUT = 1.0  # Seconds
+    CONFIG_COMMIT_ANSWER = 0x39  # Controller index of the answer to 0xEC CONFIG COMMIT
+
     def __init__(self, params, serial_port, debug: bool):
         self.param = params
         self.serial_port = serial_port
         self.debug = debug
         self.meter_state = [0, 0]
+        self.wire_format_requested = self.WIRE_FORMAT_LEGACY
+        self.wire_format_pending = set()
+        self.wire_format_deadline = 0.
+        self.multicast_seq = 0
+        self.multicast_pending = {}  # seq: [units without ack, command, deadline]
 
     def send_button_values(self):
         button_out_states = {}
@@ -62,6 +81,93 @@ class Sender:
 
         pass
 
+    def send_knob_resolutions(self):
+        # Tell the boards the output resolution of every configured knob (controllers 6 - 13). Boards with the same
+        # resolution for a knob get one multicast frame
+        units_by_command = {}
+        for unit_index, unit_data in self.param.get_config().items():
+            for controller_index, controller_data in unit_data.items():
+                if 6 <= controller_index <= 13:
+                    command = (232,  # 0xE8 = KNOB RESOLUTION (DECIMAL 232)
+                               controller_index - 6,  # Data Byte 1: Knob Index
+                               controller_data['resolution'])  # Data Byte 2: Resolution in bits
+                    units_by_command.setdefault(command, set()).add(int(unit_index))
+        for command, units in units_by_command.items():
+            if self.debug:
+                print("Sending Command Knob Resolution: ", sorted(units), list(command))
+            self.send_multicast(units, list(command))
+            time.sleep(0.005)
+
+    def send_wire_format(self, wire_format: int):
+        # Ask every configured board to use the wire format. Every board answers, see wire_format_acknowledged()
+        self.wire_format_requested = wire_format
+        self.wire_format_pending = set(int(unit_index) for unit_index in self.param.get_config().keys())
+        command_values = [233,  # 0xE9 = WIRE FORMAT (DECIMAL 233)
+                          wire_format]  # Data Byte 1: Wire Format
+        if self.debug:
+            print("Sending Command Wire Format: ", command_values)
+        # The wire format answers tell which boards switched, the multicast ack is not needed
+        self.serial_port.write(bytes(self.multicast_frame(self.wire_format_pending, self.MULTICAST_SEQ_UNTRACKED,
+                                                          command_values)))
+        self.wire_format_deadline = time.time() + self.WIRE_FORMAT_ACK_TIMEOUT
+
+    def wire_format_acknowledged(self, unit_index: int, wire_format: int):
+        if wire_format == self.wire_format_requested:
+            self.wire_format_pending.discard(unit_index)
+            if self.debug and not self.wire_format_pending:
+                print("Wire format %d acknowledged by all boards" % wire_format)
+
+    def check_wire_format(self):
+        # A board that did not answer may run older firmware, which cannot forward the compact format:
+        # switch the whole chain back to the legacy format
+        if self.wire_format_pending and time.time() > self.wire_format_deadline:
+            if self.wire_format_requested != self.WIRE_FORMAT_LEGACY:
+                print("No wire format answer from boards", sorted(self.wire_format_pending), "- using legacy format")
+                self.send_wire_format(self.WIRE_FORMAT_LEGACY)
+            else:
+                self.wire_format_pending = set()
+
+    def send_multicast(self, units, command_values: list):
+        """
+        One frame for all boards in units: command_values is the message type and its data bytes. The boards answer
+        with merged acks, boards without an ack get the command again on their own, see check_multicast()
+        """
+        seq = self.multicast_seq
+        self.multicast_seq = (self.multicast_seq + 1) % self.MULTICAST_SEQ_COUNT
+        self.multicast_pending[seq] = [set(units), list(command_values), time.time() + self.MULTICAST_ACK_TIMEOUT]
+        self.serial_port.write(bytes(self.multicast_frame(units, seq, command_values)))
+
+    def multicast_acknowledged(self, ack_value: int):
+        seq = (ack_value >> 9) & 0x1F
+        group = (ack_value >> 7) & 0x03
+        if seq not in self.multicast_pending:
+            return
+        units = self.multicast_pending[seq][0]
+        for bit in range(self.MULTICAST_GROUP_SIZE):
+            if ack_value & (1 << bit):
+                units.discard(group * self.MULTICAST_GROUP_SIZE + bit)
+        if not units:
+            del self.multicast_pending[seq]
+
+    def check_multicast(self):
+        # Boards that did not acknowledge in time get the command addressed to them alone
+        now = time.time()
+        for seq in [seq for seq, pending in self.multicast_pending.items() if now > pending[2]]:
+            units, command_values, _ = self.multicast_pending.pop(seq)
+            if self.debug:
+                print("No multicast ack from boards", sorted(units), "- sending", command_values, "one by one")
+            for unit_index in sorted(units):
+                self.serial_port.write(bytes([240 + unit_index] + command_values))
+                time.sleep(0.005)
+
+    @classmethod
+    def multicast_frame(cls, units, seq: int, command_values: list) -> list:
+        # [0xD0, seq, mask boards 0 - 6, mask boards 7 - 13, mask boards 14 - 15, message type, data bytes]
+        masks = [0, 0, 0]
+        for unit_index in units:
+            masks[int(unit_index) // cls.MULTICAST_GROUP_SIZE] |= 1 << (int(unit_index) % cls.MULTICAST_GROUP_SIZE)
+        return [cls.MULTICAST_START, seq] + masks + list(command_values)
+
     @staticmethod
     def format_value(btn_index: int, raw_value: float) -> int:
         formatted_value = 0
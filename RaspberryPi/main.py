@@ -12,17 +12,14 @@ from RainPots import Parameters
 from RainPots import OscListener
 from RainPots import OscSender
 from RainPots import SerialSender
+from RainPots import PacketDecoder
+from RainPots import LinkNegotiator
 
 
-async def read_serial_port(serial_port, osc_sender, debug: bool = False):
+async def read_serial_port(serial_port, osc_sender, serial_sender, debug: bool = False):
     index = 0
+    decoder = PacketDecoder.Decoder()
     while True:
-        data_bytes = []
-        packet_cc = []
-        controller = 0
-        packet_index_cc = -1
-        rainpots_unit = -1
-        collecting_cc = False
         pgm_number = -1
         pgm_cmd = ''
         # reding serial port in 
@@ -31,22 +28,21 @@ async def read_serial_port(serial_port, osc_sender, debug: bool = False):
             try:
                 received_byte = serial_port.read()
                 int_value = int.from_bytes(received_byte, 'little')
-                if 176 <= int_value <= 191:  # B0 - BF (Control Change)
-                    collecting_cc = True
-                    packet_index_cc = 0
-                    packet_cc = [0, 0, 0, 0]
-                    controller = -1
-                    packet_cc[packet_index_cc] = int_value
-                elif collecting_cc and not collecting_pgm_change:
-                    packet_index_cc = packet_index_cc + 1
-                    if packet_index_cc == 1:
-                        packet_cc[1] = int_value
-                    elif 2 <= packet_index_cc <= 3:
-                        packet_cc[packet_index_cc] = int_value
-                if packet_index_cc == 3 and collecting_cc:
-                    osc_sender.send_packet(packet_cc)
-                    rainpots_unit = -1
-                    collecting_cc = False
+                # Control change messages, legacy or compact format
+                packet_cc = decoder.feed(int_value)
+                if packet_cc is not None:
+                    if packet_cc[1] == PacketDecoder.Decoder.WIRE_FORMAT_ACK:
+                        serial_sender.wire_format_acknowledged(packet_cc[0] & 0x0f, packet_cc[2])
+                    elif packet_cc[1] == SerialSender.Sender.MULTICAST_ACK:
+                        serial_sender.multicast_acknowledged((packet_cc[3] << 7) | packet_cc[2])
+                    elif packet_cc[1] == SerialSender.Sender.CONFIG_COMMIT_ANSWER:
+                        if debug:
+                            print("Config commit answer from board %d:" % (packet_cc[0] & 0x0f),
+                                  (packet_cc[3] << 7) | packet_cc[2])
+                    elif LinkNegotiator.Negotiator.ERRORS_UART0 <= packet_cc[1] <= LinkNegotiator.Negotiator.STATUS_CC:
+                        pass  # Late link negotiation answers are no knob values
+                    else:
+                        osc_sender.send_packet(packet_cc)
 
                 if 192 <= int_value <= 207 or int_value == 244:  # C0 - CF (Program Change) | F4 (Save Preset)
                     collecting_pgm_change = True
@@ -55,7 +51,7 @@ async def read_serial_port(serial_port, osc_sender, debug: bool = False):
                         pgm_cmd = 'save'
                     else:
                         pgm_cmd = 'load'
-                elif collecting_pgm_change and not collecting_cc:
+                elif collecting_pgm_change and int_value < 128:
                     pgm_number = int_value
                     collecting_pgm_change = False
                     if debug:
@@ -63,14 +59,17 @@ async def read_serial_port(serial_port, osc_sender, debug: bool = False):
                     osc_sender.send_pgm_control(pgm_cmd, pgm_number)
                     pgm_number = -1
                     pgm_cmd = ''
+                elif int_value >= 128:
+                    collecting_pgm_change = False
             except Exception as err:
                 print(err)
                 traceback.print_exc()
-                rainpots_unit = -1
-                collecting_cc = False
+                decoder.reset()
                 collecting_pgm_change = False
                 pgm_cmd = ''
                 pass
+        serial_sender.check_wire_format()
+        serial_sender.check_multicast()
         # Limit CPU usage, so we do nit fry on core at 100% all times
         await asyncio.sleep(0.000000001)
 
@@ -95,6 +94,12 @@ async def init_main():
         serial_port.open()
     try:
         serial_sender = SerialSender.Sender(params, serial_port, debug)
+        link_negotiator = LinkNegotiator.Negotiator(params, serial_port, debug)
+        link_rate = link_negotiator.negotiate()
+        if debug:
+            print("Link rate: %d baud, receive errors:" % link_rate, link_negotiator.report_errors())
+        serial_sender.send_knob_resolutions()
+        serial_sender.send_wire_format(SerialSender.Sender.WIRE_FORMAT_COMPACT)
         # osc_sender = OscSender.Sender(1234, params, serial_sender, debug)
 
         osc_listener = OscListener.Listener(9999, params, serial_sender, debug)
@@ -116,7 +121,7 @@ async def init_main():
         server = AsyncIOOSCUDPServer(('127.0.0.1', 9999), dispatcher, asyncio.get_event_loop())
         transport, protocol = await server.create_serve_endpoint()  # Create datagram endpoint and start serving
 
-        await read_serial_port(serial_port, osc_sender, debug)
+        await read_serial_port(serial_port, osc_sender, serial_sender, debug)
 
         transport.close()  # Clean up serve endpoint
 
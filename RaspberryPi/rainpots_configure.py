@@ -40,12 +40,13 @@ def chose_operation(index: int) -> int:
     print("[1] Calibrate Knobs")
     print("[2] Set Button Modes")
     print("[3] Activate/Deactivate Controller")
+    print("[4] Set Knob Filter")
     try:
         op = int(input(bcolors.HEADER + "Operation: " + bcolors.ENDC))
         if op == 0:
             print("Exiting Configuration Tool")
             sys.exit(0)
-        if not 1 <= op <= 3:
+        if not 1 <= op <= 4:
             invalid_choice()
             chose_operation(index)
         return op
@@ -135,6 +136,44 @@ def controller_states() -> list:
     return states
 
 
+def ask_int(question: str, default: int, max_value: int) -> int:
+    answer = input(question + " (default: " + str(default) + ") ")
+    try:
+        value = int(answer)
+    except ValueError:
+        value = default
+    return min(max(value, 0), max_value)
+
+
+def knob_filter() -> list:
+    print(bcolors.WARNING + "\nSelected Operation: " + bcolors.ENDC + "Set Knob Filter\n")
+    knob_index = ask_int("Knob index [0 - 7]", 0, 7)
+    print("[0] Exponential average cascade (default)")
+    print("[1] One-Euro (smoothing follows the knob velocity)")
+    mode = ask_int(bcolors.HEADER + "Filter Mode:" + bcolors.ENDC, 0, 1)
+    min_cutoff = 1000
+    beta = 5000
+    if mode == 1:
+        min_cutoff = ask_int("Min cutoff in mHz [1 - 16383]", min_cutoff, 16383)
+        beta = ask_int("Beta in mHz per full scale per second [0 - 16383]", beta, 16383)
+    return [knob_index, mode, min_cutoff, beta]
+
+
+def get_knob_filter_command(board_index: int, knob_index: int, mode: int, min_cutoff: int, beta: int) -> list:
+    msg_bytes = []
+    status_byte = 240 + board_index  # COMMAND START BYTE
+    msg_bytes.append(status_byte)
+    # MSG_KNOB_FILTER 0xE7 (DECIMAL: 231)
+    msg_bytes.append(231)
+    msg_bytes.append(knob_index)
+    msg_bytes.append(mode)
+    msg_bytes.append(min_cutoff & 0x7F)
+    msg_bytes.append((min_cutoff >> 7) & 0x7F)
+    msg_bytes.append(beta & 0x7F)
+    msg_bytes.append((beta >> 7) & 0x7F)
+    return msg_bytes
+
+
 def get_button_modes_command(board_index: int, modes: list) -> list:
     msg_bytes = []
     status_byte = 240 + board_index  # COMMAND START BYTE
@@ -216,6 +255,12 @@ def main():
             print("Setting Controller States to: ", ctl_states)
             cmd_values = get_controller_states_command(board_index, ctl_states)
             send_command(cmd_values, port)
+
+        if operation == 4:
+            knob_index, mode, min_cutoff, beta = knob_filter()
+            print("Setting Knob Filter of knob %d to mode %d, min cutoff %d mHz, beta %d" % (knob_index, mode, min_cutoff, beta))
+            cmd_values = get_knob_filter_command(board_index, knob_index, mode, min_cutoff, beta)
+            send_command(cmd_values, port)
         repeat = input("Would you like to configure another board? [y/n] ")
         if repeat.lower() == 'y':
             main()
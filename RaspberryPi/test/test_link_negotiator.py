@@ -0,0 +1,156 @@
+import os
+import sys
+import time
+import types
+import unittest
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+if 'serial' not in sys.modules:
+    try:
+        import serial
+    except ImportError:
+        # SerialSender imports pyserial, the simulated chain below replaces the port
+        sys.modules['serial'] = types.ModuleType('serial')
+
+from RainPots import LinkNegotiator
+
+
+class Params:
+    def __init__(self, board_count: int):
+        self.board_count = board_count
+
+    def get_config(self) -> dict:
+        return {str(unit): {} for unit in range(self.board_count)}
+
+
+class Board:
+    """
+    Link rate state of one board as in LinkCtl: TRY switches after the switch delay, a rate without CONFIRM goes back
+    to the last confirmed rate after the confirm timeout, the power up rate needs no CONFIRM
+    """
+    def __init__(self, index: int, max_rate: int, drop_confirms: int = 0):
+        self.index = index
+        self.max_rate = max_rate
+        self.drop_confirms = drop_confirms  # CONFIRM commands lost on the way, -1: all of them
+        self.active = 0
+        self.confirmed = 0
+        self.pending = None
+        self.switch_at = None
+        self.confirm_by = None
+
+    def tick(self, now: float) -> None:
+        if self.pending is not None and now >= self.switch_at:
+            self.active = self.pending
+            self.pending = None
+            self.confirm_by = None if self.active == 0 else self.switch_at + LinkNegotiator.Negotiator.CONFIRM_TIMEOUT
+            if self.active == 0:
+                self.confirmed = 0
+        if self.confirm_by is not None and now >= self.confirm_by:
+            self.active = self.confirmed
+            self.confirm_by = None
+
+    def handle(self, action: int, rate_index: int, pattern: list, answers: bytearray) -> None:
+        negotiator = LinkNegotiator.Negotiator
+        if action == negotiator.ACTION_TRY:
+            self.pending = rate_index
+            self.switch_at = time.time() + negotiator.SWITCH_DELAY
+        elif action == negotiator.ACTION_CONFIRM:
+            if self.drop_confirms > 0:
+                self.drop_confirms -= 1
+            elif self.drop_confirms == 0:
+                self.confirmed = self.active
+                self.confirm_by = None
+        elif action == negotiator.ACTION_VERIFY:
+            for value in negotiator.UPSTREAM_PATTERN:
+                answers += bytes([0xB0 | self.index, negotiator.UPSTREAM_PATTERN_CC, value & 0x7f, value >> 7])
+            status = (pattern == negotiator.PATTERN) << negotiator.STATUS_OK_BIT
+            status |= (self.confirm_by is None) << negotiator.STATUS_CONFIRMED_BIT
+            status |= len(negotiator.RATES) << 4 | self.active
+            answers += bytes([0xB0 | self.index, negotiator.STATUS_CC, status & 0x7f, status >> 7])
+        elif action == negotiator.ACTION_REPORT:
+            for cc in (negotiator.ERRORS_UART0, negotiator.ERRORS_UART1):
+                answers += bytes([0xB0 | self.index, cc, 0, 0])
+
+
+class Chain:
+    """
+    Serial port of the Pi with the boards behind it. A command reaches board i only if the Pi and boards 0 - i all
+    run the same rate and none of them is above its limit, the answers take the same way back
+    """
+    def __init__(self, boards: list):
+        self.boards = boards
+        self.baudrate = LinkNegotiator.Negotiator.RATES[0]
+        self.answers = bytearray()
+
+    def tick(self) -> None:
+        for board in self.boards:
+            board.tick(time.time())
+
+    def path_ok(self, index: int) -> bool:
+        for board in self.boards[:index + 1]:
+            if LinkNegotiator.Negotiator.RATES[board.active] != self.baudrate or self.baudrate > board.max_rate:
+                return False
+        return True
+
+    def write(self, data: bytes) -> None:
+        self.tick()
+        # Multicast frame: [0xD0, seq, mask 0 - 6, mask 7 - 13, mask 14 - 15, 0xEA, action, rate index, pattern]
+        mask = data[2] | (data[3] << 7) | (data[4] << 14)
+        for board in self.boards:
+            if (mask >> board.index) & 1 and self.path_ok(board.index):
+                board.handle(data[6], data[7], list(data[8:14]), self.answers)
+
+    def flush(self) -> None:
+        pass
+
+    def reset_input_buffer(self) -> None:
+        self.answers = bytearray()
+
+    def inWaiting(self) -> int:
+        return len(self.answers)
+
+    def read(self, size: int) -> bytes:
+        data = bytes(self.answers[:size])
+        del self.answers[:size]
+        return data
+
+
+class LinkNegotiatorTest(unittest.TestCase):
+    """
+    The chain has to settle on the highest rate every board and the Pi pass, with every board at the rate of the
+    Pi port. Runs in real time: the negotiation waits for the switch delay and the confirm timeout of the boards
+    """
+    def negotiate(self, boards: list, pi_max_rate: int = LinkNegotiator.Negotiator.RATES[-1]) -> int:
+        chain = Chain(boards)
+        negotiator = LinkNegotiator.Negotiator(Params(len(boards)), chain, False)
+        rate = negotiator.negotiate(pi_max_rate)
+        chain.tick()
+        self.assertEqual(rate, chain.baudrate)
+        self.assertEqual([LinkNegotiator.Negotiator.RATES[board.active] for board in boards], [rate] * len(boards))
+        return rate
+
+    def test_all_boards_fastest_rate(self):
+        self.assertEqual(self.negotiate([Board(i, 2000000) for i in range(4)]), 2000000)
+
+    def test_slow_board_in_the_middle(self):
+        self.assertEqual(self.negotiate([Board(i, 921600 if i == 2 else 2000000) for i in range(4)]), 921600)
+
+    def test_first_board_power_up_rate_only(self):
+        self.assertEqual(self.negotiate([Board(i, 380400 if i == 0 else 2000000) for i in range(3)]), 380400)
+
+    def test_pi_limit(self):
+        self.assertEqual(self.negotiate([Board(i, 2000000) for i in range(2)], 1000000), 1000000)
+
+    def test_first_confirm_lost(self):
+        self.assertEqual(self.negotiate([Board(i, 2000000, 1 if i == 1 else 0) for i in range(3)]), 2000000)
+
+    def test_every_confirm_lost(self):
+        self.assertEqual(self.negotiate([Board(i, 2000000, -1 if i == 1 else 0) for i in range(3)]), 380400)
+
+    def test_every_confirm_lost_and_slow_board(self):
+        boards = [Board(i, 921600 if i == 2 else 2000000, -1 if i == 1 else 0) for i in range(3)]
+        self.assertEqual(self.negotiate(boards), 380400)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -20,6 +20,42 @@ void __isr pio_handler()
     }
 }
 
+/**
+ * @brief GPIO interrupt for the ADS1015 ALERT/RDY pins: a conversion is finished
+ *
+ * @param gpio
+ * @param events
+ */
+void gpio_adc_alert_handler(uint gpio, uint32_t events)
+{
+    if (adc_sampler_0 != NULL && gpio == adc_sampler_0->getAlertPin())
+    {
+        adc_sampler_0->onAlert();
+    }
+    else if (adc_sampler_1 != NULL && gpio == adc_sampler_1->getAlertPin())
+    {
+        adc_sampler_1->onAlert();
+    }
+}
+
+/**
+ * @brief uart0 RX interrupt (core0): commands from the Pi
+ *
+ */
+void __isr uart0_rx_handler()
+{
+    uart_cmd_rx->onRxIrq();
+}
+
+/**
+ * @brief uart1 TX interrupt (core0): forwarded bytes that did not fit into the TX FIFO
+ *
+ */
+void __isr uart1_tx_handler()
+{
+    uart_cmd_rx->onTxIrq();
+}
+
 /**
  * @brief entry poinmt core1
  *
@@ -49,72 +85,23 @@ void main_core1()
     uart_set_irq_enables(uart1, false, false);
 
     sleep_ms(100);
+    // The uart0 RX and uart1 TX interrupts are handled by core0
+    multicore_fifo_push_blocking(CORE1_UARTS_READY);
 
-    queue_entry_t entry;
-    DataFormatter dataFormatter(board_index);
-    uint8_t formatted_data[4] = {0, 0, 0, 0};
-
-    bool collect_bytes_from_prev = false;
-    uint8_t packet_forward[4] = {0, 0, 0, 0};
-    uint8_t packet_forward_index = 8;
+    // Upstream packets are appended to the ring and sent by DMA, core1 never waits for the line
+    UartTxRing uartTxRingObj(uart0);
+    uartTxRingObj.init();
+    // Bytes from the previous board are received by DMA
+    UartRxRing uartRxRingObj(uart1);
+    uartRxRingObj.init();
 
-    uint8_t queue_sent = 0;
-    uint8_t forward_sent = 0;
+    Uplink uplinkObj(board_index, &message_queue, &knob_mailbox, &uartTxRingObj, &uartRxRingObj);
+    uplink = &uplinkObj;
 
     while (true)
     {
-        while (!queue_is_empty(&message_queue))
-        {
-            queue_remove_blocking(&message_queue, &entry);
-#ifdef DEBUG
-            printf("%d - %d\n", entry.index, entry.value);
-#endif
-            // Format to 'MIDI-like' bytes
-            dataFormatter.formatData(entry.index, entry.value, formatted_data);
-            for (uint8_t i = 0; i < 4; i++)
-            {
-                uart_putc(uart0, formatted_data[i]);
-            }
-            queue_sent++;
-            // if (queue_sent > 50)
-            // { // Make sure that we don't block the forwarding
-            //     queue_sent = 0;
-            //     break;
-            // }
-        }
-
-        while (uart_is_readable(uart1))
-        {
-            uint8_t c = uart_getc(uart1);
-            // // Check For status byte
-            if ((c & 0xf0) == MIDI_MASK_STAUS_CC)
-            {
-                collect_bytes_from_prev = true;
-                packet_forward_index = 0;
-                packet_forward[0] = c;
-                packet_forward[1] = 0;
-                packet_forward[2] = 0;
-                packet_forward[3] = 0;
-            }
-            else if (collect_bytes_from_prev)
-            {
-                if (packet_forward_index < 4)
-                {
-                    packet_forward_index++;
-                    packet_forward[packet_forward_index] = c;
-                }
-                if (packet_forward_index == 3)
-                {
-                    // send packet
-                    collect_bytes_from_prev = false;
-
-                    for (uint8_t i = 0; i < 4; i++)
-                    {
-                        uart_putc(uart0, packet_forward[i]);
-                    }
-                }
-            }
-        }
+        uplinkObj.setWireFormat(inputCtl->getWireFormat());
+        uplinkObj.service();
     }
 }
 
@@ -170,6 +157,9 @@ int main()
     Eeprom24LC32 storageObj(&i2cController_0);
     storage = &storageObj;
 
+#ifdef DEBUG
+    uint32_t config_load_start_us = time_us_32();
+#endif
     RpConfig configObj(storage, FORCE_CONFIG_INIT);
     config = &configObj;
 
@@ -178,29 +168,82 @@ int main()
     PotiCtl potiCtl_1(adc_1, config, 10);
     potiCtl_1.init();
 
+#if ADC_ACQUISITION_MODE != ADC_ACQUISITION_POLLING
+#if ADC_0_BACKEND == ADC_BACKEND_RP2040
+    Rp2040AdcSampler rp2040SamplerObj;
+    rp2040SamplerObj.init();
+    knob_sampler_0 = &rp2040SamplerObj;
+#else
+    AdcSampler adcSamplerObj_0(adc_0, ADC_ACQUISITION_MODE, PIN_ADC_0_ALERT);
+    adc_sampler_0 = &adcSamplerObj_0;
+    knob_sampler_0 = adc_sampler_0;
+#endif
+    AdcSampler adcSamplerObj_1(adc_1, ADC_ACQUISITION_MODE, PIN_ADC_1_ALERT);
+    adc_sampler_1 = &adcSamplerObj_1;
+    knob_sampler_1 = adc_sampler_1;
+
+#if ADC_ACQUISITION_MODE == ADC_ACQUISITION_ALERT_RDY
+    gpio_set_irq_enabled_with_callback(PIN_ADC_0_ALERT, GPIO_IRQ_EDGE_FALL, true, &gpio_adc_alert_handler);
+    gpio_set_irq_enabled(PIN_ADC_1_ALERT, GPIO_IRQ_EDGE_FALL, true);
+#endif
+    if (adc_sampler_0 != NULL)
+    {
+        adc_sampler_0->init();
+    }
+    adc_sampler_1->init();
+
+    potiCtl_0.setSampler(knob_sampler_0);
+    potiCtl_1.setSampler(knob_sampler_1);
+
+    AdcScheduler adcSchedulerObj(knob_sampler_0, knob_sampler_1);
+    adc_scheduler = &adcSchedulerObj;
+#endif
+#if ADC_SAMPLE_CLOCK
+    AdcSampleClock adcSampleClockObj(knob_sampler_0, knob_sampler_1, ADC_SAMPLE_CLOCK_RATE_HZ);
+    adc_sample_clock = &adcSampleClockObj;
+#endif
+
     InputCtl inputCtlObj(config, &message_queue, pio_in_out, sm_out, led_pins, &potiCtl_0, &potiCtl_1);
     inputCtl = &inputCtlObj;
     inputCtl->init();
+#ifdef DEBUG
+    config_load_us = time_us_32() - config_load_start_us;
+#endif
 
     queue_init(&message_queue, sizeof(queue_entry_t), 300);
     queue_init(&callback_queue, sizeof(queue_entry_t), 50);
 
+    // Baud rate of the chain links, negotiated by the Pi. Both UARTs are initialized by core1
+    LinkCtl linkCtlObj(uart0, uart1, &message_queue);
+    link_ctl = &linkCtlObj;
+    inputCtl->setLinkCtl(link_ctl);
+
+    // Commands from the Pi arrive by interrupt, the main loop only executes complete ones
+    RemoteCmdEngine uartCmdEngineObj(InputCtl::remote_commands, InputCtl::remote_command_count, REMOTE_CMD_TRANSPORT_UART, board_index, inputCtl);
+    uart_cmd_engine = &uartCmdEngineObj;
+    uart_cmd_engine->setAckHandler(InputCtl::remote_multicast_ack);
+    UartCmdRx uartCmdRxObj(uart0, uart1, uart_cmd_engine);
+    uart_cmd_rx = &uartCmdRxObj;
+    // Commands from the configuration tool, the USB cable addresses the board
+    RemoteCmdEngine usbCmdEngine(InputCtl::remote_commands, InputCtl::remote_command_count, REMOTE_CMD_TRANSPORT_USB, REMOTE_CMD_ADDRESS_ANY, inputCtl);
+    uint8_t usb_eot_pending = 0; // Commands framed on USB, EOT is sent once they are executed and finished
+
     multicore_launch_core1(main_core1);
     sleep_ms(100);
 
-    uint8_t remote_command_bytes[REMOTE_COMMAND_MAX_DATA_BYTES];
-    init_remote_data_bytes_array(remote_command_bytes);
-
-    uint8_t remote_command_bytes_usb[REMOTE_COMMAND_MAX_DATA_BYTES];
-    init_remote_data_bytes_array(remote_command_bytes_usb);
-
-    bool msg_collect_bytes = false;
-    uint8_t msg_byte_index = 0;
-    uint8_t msg_byte_length = 0;
-
-    bool msg_collect_bytes_usb = false;
-    uint8_t msg_byte_index_usb = 0;
-    uint8_t msg_byte_length_usb = 0;
+    // uart_init() of core1 resets the UARTs, enable the interrupts afterwards
+    while (multicore_fifo_pop_blocking() != CORE1_UARTS_READY)
+    {
+    }
+    irq_set_exclusive_handler(UART0_IRQ, uart0_rx_handler);
+    irq_set_exclusive_handler(UART1_IRQ, uart1_tx_handler);
+    irq_set_enabled(UART0_IRQ, true);
+    irq_set_enabled(UART1_IRQ, true);
+    uart_cmd_rx->init();
+
+#if ADC_SAMPLE_CLOCK
+    adc_sample_clock->start();
+#endif
 
     while (true)
     {
@@ -209,133 +252,72 @@ int main()
         int chrUsb = getchar_timeout_us(0);
         if (chrUsb != PICO_ERROR_TIMEOUT)
         {
-            if (!msg_collect_bytes_usb)
+            switch (usbCmdEngine.feed((uint8_t)chrUsb))
             {
-                if ((chrUsb >> 4) == 0x0F)
-                {
-                    putchar(0x01); // ASCII for: Start of Header (SOH)
-                    init_remote_data_bytes_array(remote_command_bytes_usb);
-                    msg_collect_bytes_usb = true;
-                    msg_byte_index_usb = 0;
-                    msg_byte_length_usb = 0;
-                }
-            }
-            else
-            {
-                if (msg_byte_index_usb == 0)
-                {
-                    remote_command_bytes_usb[msg_byte_index_usb] = chrUsb;
-                    switch (remote_command_bytes_usb[msg_byte_index_usb])
-                    {
-                    case MSG_CONTROLLER_MODE:
-                        msg_byte_length_usb = MSG_CONTROLLER_MODE_DATA_BYTE_COUNT + 1;
-                        break;
-                    case MSG_CONTROLLER_STATUS:
-                        msg_byte_length_usb = MSG_CONTROLLER_STATUS_DATA_BYTE_COUNT + 1;
-                        break;
-                    case MSG_SET_BUTTON_VALUES:
-                        msg_byte_length_usb = MSG_SET_BUTTON_VALUES_DATA_BYTE_COUNT + 1;
-                        break;
-                    default:
-                        msg_byte_length_usb = MSG_DEFAULT_DATA_BYTE_COUNT + 1;
-                        break;
-                    }
-                    msg_byte_index_usb++;
-                }
-                else if (msg_byte_index_usb < msg_byte_length_usb)
-                {
-                    remote_command_bytes_usb[msg_byte_index_usb] = chrUsb;
-                    msg_byte_index_usb++;
-                }
-                if (msg_byte_index_usb >= msg_byte_length_usb)
-                {
-                    msg_collect_bytes_usb = false;
-                    inputCtl->executeRemoteCommand(remote_command_bytes_usb);
-                    putchar(0x04); // ASCII for: End of Transmission (EOT)
-                }
+            case REMOTE_CMD_EVENT_START:
+                putchar(0x01); // ASCII for: Start of Header (SOH)
+                break;
+            case REMOTE_CMD_EVENT_END:
+                usb_eot_pending++;
+                break;
+            default:
+                break;
             }
         }
 
-        while (uart_is_readable(uart0))
+        // Long running commands advance one step per pass. Other commands wait for them to keep their order
+        inputCtl->serviceJobs();
+        if (!inputCtl->isBusy() && !usbCmdEngine.executeNext())
         {
-            uint8_t c = uart_getc(uart0);
-            // Forward bytes to other boards in the chain
-            uart_putc(uart1, c);
-            if (!msg_collect_bytes)
+            for (; usb_eot_pending > 0; usb_eot_pending--)
             {
-                if ((c >> 4) == 0x0F && (c & 0x0F) == board_index)
-                {
-                    init_remote_data_bytes_array(remote_command_bytes);
-                    msg_collect_bytes = true;
-                    msg_byte_index = 0;
-                    msg_byte_length = 0;
-                }
-            }
-            else
-            {
-                if (msg_byte_index == 0)
-                {
-                    remote_command_bytes[msg_byte_index] = c;
-                    switch (remote_command_bytes[msg_byte_index])
-                    {
-                    case MSG_CONTROLLER_MODE:
-                        msg_byte_length = MSG_CONTROLLER_MODE_DATA_BYTE_COUNT + 1;
-                        break;
-                    case MSG_CONTROLLER_STATUS:
-                        msg_byte_length = MSG_CONTROLLER_STATUS_DATA_BYTE_COUNT + 1;
-                        break;
-                    case MSG_SET_BUTTON_VALUES:
-                        msg_byte_length = MSG_SET_BUTTON_VALUES_DATA_BYTE_COUNT + 1;
-                        break;
-                    default:
-                        msg_byte_length = MSG_DEFAULT_DATA_BYTE_COUNT + 1;
-                        break;
-                    }
-                    msg_byte_index++;
-                }
-                else if (msg_byte_index < msg_byte_length)
-                {
-                    remote_command_bytes[msg_byte_index] = c;
-                    msg_byte_index++;
-                }
-                if (msg_byte_index >= msg_byte_length)
-                {
-                    msg_collect_bytes = false;
-                    inputCtl->executeRemoteCommand(remote_command_bytes);
-                }
+                putchar(0x04); // ASCII for: End of Transmission (EOT)
             }
         }
+        while (!inputCtl->isBusy() && uart_cmd_engine->executeNext())
+        {
+        }
+        // Configuration changes and the button state are written back to the EEPROM when no command or job is pending
+        if (!inputCtl->isBusy() && usb_eot_pending == 0)
+        {
+            inputCtl->storeRuntimeState();
+            config->flushStep();
+        }
 
+        link_ctl->service();
+
+#if ADC_ACQUISITION_MODE != ADC_ACQUISITION_POLLING
+        adc_scheduler->service();
+#endif
+#ifdef DEBUG
+        _printSampleRates();
+#endif
         // Read the two ADCs
-        for (uint8_t channel_index = 0; channel_index < 4; channel_index++)
+#if ADC_SAMPLE_CLOCK
+        // One filter step per sample clock tick, no matter how long this loop iteration took. Ticks without a new
+        // sample of the knob (acquisition stalled with the main loop) are skipped
+        adc_sample_frame_t frame;
+        while (adc_sample_clock->pop(&frame))
         {
-            if (inputCtl->getControllerStatus(channel_index + potiCtl_0.getChannelStartIndex()))
+            for (uint8_t channel_index = 0; channel_index < 4; channel_index++)
             {
-                if (potiCtl_0.uppdate(channel_index))
+                if (frame.fresh[0] & (1 << channel_index))
                 {
-                    if (inputCtl->getUiMode() == UI_MODE_PERFORM)
-                    {
-                        queue_entry_t q_entry;
-                        q_entry.index = channel_index + 6;
-                        q_entry.value = potiCtl_0.getValue(channel_index);
-                        queue_add_blocking(&message_queue, &q_entry);
-                    }
+                    process_knob(&potiCtl_0, knob_sampler_0, channel_index, &frame.value[0][channel_index], frame.timestamp_us);
                 }
-            }
-            if (inputCtl->getControllerStatus(channel_index + potiCtl_1.getChannelStartIndex()))
-            {
-                if (potiCtl_1.uppdate(channel_index))
+                if (frame.fresh[1] & (1 << channel_index))
                 {
-                    if (inputCtl->getUiMode() == UI_MODE_PERFORM)
-                    {
-                        queue_entry_t q_entry;
-                        q_entry.index = channel_index + 10;
-                        q_entry.value = potiCtl_1.getValue(channel_index);
-                        queue_add_blocking(&message_queue, &q_entry);
-                    }
+                    process_knob(&potiCtl_1, knob_sampler_1, channel_index, &frame.value[1][channel_index], frame.timestamp_us);
                 }
             }
         }
+#else
+        for (uint8_t channel_index = 0; channel_index < 4; channel_index++)
+        {
+            process_knob(&potiCtl_0, knob_sampler_0, channel_index, NULL, 0);
+            process_knob(&potiCtl_1, knob_sampler_1, channel_index, NULL, 0);
+        }
+#endif
     }
 }
 
@@ -435,12 +417,43 @@ void core_0_start_up_sequence()
     }
 }
 
-void init_remote_data_bytes_array(uint8_t *byte_array)
+/**
+ * @brief Run the filter of one knob and post its value to the knob mailbox when it changed
+ *
+ * @param potiCtl
+ * @param sampler NULL with ADC_ACQUISITION_POLLING
+ * @param channel_index
+ * @param sample sample taken by the AdcSampleClock, NULL to let PotiCtl fetch the sample itself
+ * @param sample_us time the sample was taken
+ */
+void process_knob(PotiCtl *potiCtl, KnobSampler *sampler, uint8_t channel_index, uint16_t *sample, uint32_t sample_us)
 {
-    for (uint8_t i = 0; i < REMOTE_COMMAND_MAX_DATA_BYTES; i++)
+    uint8_t controller_index = channel_index + potiCtl->getChannelStartIndex();
+    bool enabled = inputCtl->getControllerStatus(controller_index);
+#ifdef DEBUG
+    if (first_sample_us == 0)
+    {
+        first_sample_us = time_us_32();
+    }
+#endif
+    if (enabled)
     {
-        byte_array[i] = 0;
+        bool changed = (sample != NULL) ? potiCtl->uppdateFromSample(channel_index, *sample, sample_us) : potiCtl->uppdate(channel_index);
+        if (changed)
+        {
+            if (inputCtl->getUiMode() == UI_MODE_PERFORM)
+            {
+                knob_mailbox.put(controller_index, potiCtl->getValue(channel_index));
+#if ADC_ACQUISITION_MODE != ADC_ACQUISITION_POLLING
+                sampler->messageSent(channel_index);
+#endif
+            }
+        }
     }
+#if ADC_ACQUISITION_MODE != ADC_ACQUISITION_POLLING
+    // Locked or disabled knobs are only sampled at the background rate
+    sampler->setChannelLocked(channel_index, !enabled || potiCtl->isLocked(channel_index));
+#endif
 }
 
 #ifdef DEBUG
@@ -468,4 +481,129 @@ void _printBitField(uint32_t bitField)
     }
     printf("\n");
 }
+
+/**
+ * @brief Dev/Debug helper function: print the effective samples per second of each knob every few seconds
+ *
+ */
+void _printSampleRates()
+{
+    static bool boot_printed = false;
+    if (!boot_printed && first_sample_us != 0)
+    {
+        boot_printed = true;
+        printf("Boot: config load %luus (image %luus), first knob filter step after %luus\n", (unsigned long)config_load_us, (unsigned long)config->getLoadUs(), (unsigned long)first_sample_us);
+    }
+#if ADC_ACQUISITION_MODE != ADC_ACQUISITION_POLLING
+    static uint32_t last_print_ms = 0;
+    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+    if (now_ms - last_print_ms < 5000)
+    {
+        return;
+    }
+    last_print_ms = now_ms;
+    printf("SPS per knob:");
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        printf(" %d", knob_sampler_0->getSamplesPerSecond(i));
+    }
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        printf(" %d", knob_sampler_1->getSamplesPerSecond(i));
+    }
+    printf(" - scan period: %luus\n", (unsigned long)adc_scheduler->getScanPeriodUs());
+    printf("Move to first message max latency per knob (us):");
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        printf(" %lu", (unsigned long)knob_sampler_0->getWakeLatencyMaxUs(i));
+    }
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        printf(" %lu", (unsigned long)knob_sampler_1->getWakeLatencyMaxUs(i));
+    }
+    printf("\n");
+#endif
+#if ADC_SAMPLE_CLOCK
+    printf(
+        "Sample clock: period %luus, jitter %ldus / +%ldus, max lag %luus, dropped %lu\n",
+        (unsigned long)adc_sample_clock->getPeriodUs(),
+        (long)adc_sample_clock->getJitterMinUs(),
+        (long)adc_sample_clock->getJitterMaxUs(),
+        (unsigned long)adc_sample_clock->getLagMaxUs(),
+        (unsigned long)adc_sample_clock->getDroppedCount());
+    adc_sample_clock->resetStatistics();
+#endif
+    printf(
+        "Config: %lu dirty bytes, %lu page writes, max flush step %luus, max dirty to flushed %luus\n",
+        (unsigned long)config->getDirtyByteCount(),
+        (unsigned long)config->getFlushPageWrites(),
+        (unsigned long)config->getFlushStepMaxUs(),
+        (unsigned long)config->getFlushLatencyMaxUs());
+    config->resetFlushStatistics();
+    printf(
+        "Journal: sequence %lu, %lu entries written, boot scan %luus\n",
+        (unsigned long)config->getJournalSequence(),
+        (unsigned long)config->getJournalAppends(),
+        (unsigned long)config->getJournalRecoverUs());
+    if (uplink != NULL)
+    {
+        printf(
+            "Uplink: local sent %lu dropped %lu, forwarded %lu truncated %lu overruns %lu lost %lu bytes, max round %luus\n",
+            (unsigned long)uplink->getLocalSent(),
+            (unsigned long)uplink->getLocalDropped(),
+            (unsigned long)uplink->getForwardSent(),
+            (unsigned long)uplink->getForwardTruncated(),
+            (unsigned long)uplink->getForwardOverruns(),
+            (unsigned long)uplink->getForwardLostBytes(),
+            (unsigned long)uplink->getRoundMaxUs());
+        uplink->resetRoundMax();
+        printf(
+            "Multicast acks: merged %lu, sent %lu, dropped %lu\n",
+            (unsigned long)uplink->getAckMerged(),
+            (unsigned long)uplink->getAckSent(),
+            (unsigned long)uplink->getAckDropped());
+        printf(
+            "Uart0 TX ring: high water %lu/%d bytes, stalls %lu, stall time %luus (max %luus)\n",
+            (unsigned long)uplink->getTxRing()->getHighWater(),
+            UART_TX_RING_SIZE,
+            (unsigned long)uplink->getTxRing()->getStallCount(),
+            (unsigned long)uplink->getTxRing()->getStallUs(),
+            (unsigned long)uplink->getTxRing()->getStallMaxUs());
+        printf(
+            "Uart1 RX ring: high water %lu/%d bytes\n",
+            (unsigned long)uplink->getRxRing()->getHighWater(),
+            UART_RX_RING_SIZE);
+    }
+    printf(
+        "Links: %lu baud, rx errors uart0 %lu uart1 %lu (framing %lu / %lu, overrun %lu / %lu), reverted %lu\n",
+        (unsigned long)link_ctl->getBaudRate(),
+        (unsigned long)link_ctl->getErrorTotal(0),
+        (unsigned long)link_ctl->getErrorTotal(1),
+        (unsigned long)link_ctl->getErrors(0)->framing,
+        (unsigned long)link_ctl->getErrors(1)->framing,
+        (unsigned long)link_ctl->getErrors(0)->overrun,
+        (unsigned long)link_ctl->getErrors(1)->overrun,
+        (unsigned long)link_ctl->getRevertCount());
+    printf(
+        "Uart0 commands: received %lu bytes, rx fifo overruns %lu, forward high water %u/%d, dropped %lu bytes, commands %lu (dropped %lu, unknown %lu)\n",
+        (unsigned long)uart_cmd_rx->getReceivedCount(),
+        (unsigned long)uart_cmd_rx->getOverrunCount(),
+        uart_cmd_rx->getForwardHighWater(),
+        UART_CMD_RX_FORWARD_RING_SIZE,
+        (unsigned long)uart_cmd_rx->getForwardDropCount(),
+        (unsigned long)uart_cmd_engine->getCommandCount(),
+        (unsigned long)uart_cmd_engine->getDropCount(),
+        (unsigned long)uart_cmd_engine->getUnknownCount());
+    printf(
+        "Jobs: %lu done, %lu dropped, longest step %luus\n",
+        (unsigned long)inputCtl->getJobScheduler()->getJobCount(),
+        (unsigned long)inputCtl->getJobScheduler()->getDropCount(),
+        (unsigned long)inputCtl->getJobScheduler()->getStepMaxUs());
+    inputCtl->getJobScheduler()->resetStepMax();
+    printf(
+        "Knob mailbox: put %lu, sent %lu, coalesced %lu\n",
+        (unsigned long)knob_mailbox.getPutCount(),
+        (unsigned long)knob_mailbox.getTakeCount(),
+        (unsigned long)knob_mailbox.getCoalescedCount());
+}
 #endif
\ No newline at end of file
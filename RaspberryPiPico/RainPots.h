@@ -18,10 +18,17 @@
 #include "I2cController.h"
 #include "24LC32.h"
 #include "ADS1X15.h"
+#include "AdcSampler.h"
+#include "AdcScheduler.h"
+#include "AdcSampleClock.h"
+#include "Rp2040AdcSampler.h"
 #include "PotiCtl.h"
 #include "InputCtl.h"
 #include "24LC32.h"
 #include "DataFormatter.h"
+#include "ValueMailbox.h"
+#include "Uplink.h"
+#include "UartCmdRx.h"
 #include "shift_in_out.pio.h"
 
 // #define DEBUG
@@ -56,6 +63,43 @@
 #define PIN_I2C_1_SDA 6
 #define PIN_I2C_1_SCL 7
 
+// ADS1015 ALERT/RDY Pins (only used with ADC_ACQUISITION_ALERT_RDY)
+#define PIN_ADC_0_ALERT 27
+#define PIN_ADC_1_ALERT 28
+
+// ADC_ACQUISITION_POLLING: blocking read of each channel from the main loop
+// ADC_ACQUISITION_ALERT_RDY: conversions are fetched by the ALERT/RDY interrupt. Requires the ALERT/RDY pins
+// of both ADS1015 to be wired to PIN_ADC_0_ALERT and PIN_ADC_1_ALERT
+// ADC_ACQUISITION_CONTINUOUS: the ADS1015 convert continuously, the main loop rotates the mux through the channels
+// ADC_ACQUISITION_INTERLEAVED: single-shot conversions on both buses overlap, results are read after the conversion time
+#define ADC_ACQUISITION_MODE ADC_ACQUISITION_INTERLEAVED
+
+// Run the knob filters once per tick of a fixed rate sample clock instead of once per main loop iteration,
+// so the filter time constants do not depend on the main loop load. Not available with ADC_ACQUISITION_POLLING.
+// CONTINUOUS and INTERLEAVED acquire from the main loop: while it is blocked there are no new samples and the ticks
+// are skipped, only ALERT_RDY keeps sampling through a blocked main loop
+#define ADC_SAMPLE_CLOCK true
+#define ADC_SAMPLE_CLOCK_RATE_HZ 200
+#if ADC_SAMPLE_CLOCK && ADC_ACQUISITION_MODE == ADC_ACQUISITION_POLLING
+#error "ADC_SAMPLE_CLOCK requires an ADC_ACQUISITION_MODE other than ADC_ACQUISITION_POLLING"
+#endif
+
+// Acquisition backend of the knobs 6 - 9 (potiCtl_0). The knobs 10 - 13 always use the ADS1015 on i2c1
+// ADC_BACKEND_ADS1X15: external ADS1015 on i2c0
+// ADC_BACKEND_RP2040: on-chip ADC, free running round robin with DMA. Needs the knobs wired to GPIO26 - GPIO29
+// (ADC0 - ADC3), so LED_3 has to move off GPIO26, and a module that does not use GPIO29 for VSYS sensing
+#define ADC_BACKEND_ADS1X15 0
+#define ADC_BACKEND_RP2040 1
+#define ADC_0_BACKEND ADC_BACKEND_ADS1X15
+#if ADC_0_BACKEND == ADC_BACKEND_RP2040
+#if ADC_ACQUISITION_MODE == ADC_ACQUISITION_POLLING || ADC_ACQUISITION_MODE == ADC_ACQUISITION_ALERT_RDY
+#error "ADC_BACKEND_RP2040 needs ADC_ACQUISITION_CONTINUOUS or ADC_ACQUISITION_INTERLEAVED (GPIO27/28 are ADC inputs)"
+#endif
+#if PIN_LED_3 >= RP2040_ADC_FIRST_GPIO
+#error "ADC_BACKEND_RP2040: PIN_LED_3 is on an ADC input"
+#endif
+#endif
+
 #define PIN_JP_INDEX_0 21
 #define PIN_JP_INDEX_1 20
 #define PIN_JP_INDEX_2 19
@@ -67,7 +111,8 @@
 #define UART_TX_PIN_PREV_POT 4
 #define UART_RX_PIN_PREV_POT 5
 
-#define BAUD_RATE_INTERCOM 380400
+#define BAUD_RATE_INTERCOM 380400 // Power up rate of the chain links, the Pi may negotiate a faster one (LinkCtl)
+#define CORE1_UARTS_READY 0x01    // Multicore FIFO: core1 has initialized both UARTs
 
 #define SHIFT_IN_BASE_PIN 13
 // Pin Mapping SHIFT IN
@@ -94,8 +139,6 @@
 // +-------------------+----------+-----------+---------+
 
 
-#define REMOTE_COMMAND_MAX_DATA_BYTES 24
-
 
 #ifndef __QUEUE_ENTRY_T__
 #define __QUEUE_ENTRY_T__
@@ -116,19 +159,36 @@ uint8_t board_index;
 ADS1X15 *adc_0 = NULL;
 ADS1X15 *adc_1 = NULL;
 
+AdcSampler *adc_sampler_0 = NULL;
+AdcSampler *adc_sampler_1 = NULL;
+KnobSampler *knob_sampler_0 = NULL; // Acquisition backend of potiCtl_0 (AdcSampler or Rp2040AdcSampler)
+KnobSampler *knob_sampler_1 = NULL;
+AdcScheduler *adc_scheduler = NULL;
+AdcSampleClock *adc_sample_clock = NULL;
+
 Eeprom24LC32 *storage;
 RpConfig *config;
 InputCtl *inputCtl;
+LinkCtl *link_ctl;
+UartCmdRx *uart_cmd_rx = NULL; // Commands from the Pi, received and forwarded by the uart0 RX interrupt of core0
+RemoteCmdEngine *uart_cmd_engine = NULL;
 
 uint led_pins[4] = {PIN_LED_0, PIN_LED_1, PIN_LED_2, PIN_LED_3};
 
-queue_t message_queue;
+queue_t message_queue; // Button values, every state change is sent
 queue_t callback_queue;
+ValueMailbox knob_mailbox; // Knob values, only the newest value of each knob is sent
+Uplink *uplink = NULL; // Owned by core1, core0 only reads the statistics
+#ifdef DEBUG
+uint32_t config_load_us = 0;  // RpConfig, PotiCtl and InputCtl init, all configuration reads of the boot
+uint32_t first_sample_us = 0; // Time since boot of the first knob filter step
+#endif
 
 void core_0_init_led_pins();
 void core_0_init_board_index();
 void core_0_start_up_sequence();
-void init_remote_data_bytes_array(uint8_t *byte_array);
+void process_knob(PotiCtl *potiCtl, KnobSampler *sampler, uint8_t channel_index, uint16_t *sample, uint32_t sample_us);
 #ifdef DEBUG
 void _printBitField(uint32_t bits);
+void _printSampleRates();
 #endif
\ No newline at end of file
@@ -1,5 +1,7 @@
 MACRO(HEADER_DIRECTORIES return_list)
     FILE(GLOB_RECURSE new_list *.h)
+    # Host tests bring their own stubbed SDK headers, keep them out of the firmware
+    LIST(FILTER new_list EXCLUDE REGEX "/test/")
     SET(dir_list "")
     FOREACH(file_path ${new_list})
         GET_FILENAME_COMPONENT(dir_path ${file_path} PATH)
@@ -13,6 +15,7 @@ MACRO(EXECUTABLE_FILES return_list search_dir_list)
         SET(dir_list "")
         FOREACH(search_dir ${search_dir_list})
             FILE(GLOB_RECURSE new_list ${search_dir}/*.c*)
+            LIST(FILTER new_list EXCLUDE REGEX "/test/")
             FOREACH(file_path ${new_list})
                  SET(dir_list ${dir_list} ${file_path})
             ENDFOREACH()
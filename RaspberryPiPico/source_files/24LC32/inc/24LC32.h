@@ -58,6 +58,7 @@ public:
     void writeByte(uint32_t memoryAddress, uint8_t dataToWrite);
     void write(uint32_t memoryAddress, uint8_t *dataToWrite, uint16_t blockSize);
     void writePage(uint16_t pageIndex, uint8_t *buff);
+    bool startWrite(uint32_t memoryAddress, uint8_t *dataToWrite, uint16_t bufferSize);
     bool isConnected();
     bool isBusy();
     void erase(uint8_t toWrite = 0x00); //Erase the entire memory. Optional: write a given byte to each spot.
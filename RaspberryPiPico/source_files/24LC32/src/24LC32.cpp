@@ -318,6 +318,40 @@ void Eeprom24LC32::write(uint32_t memoryAddress, uint8_t *dataToWrite, uint16_t
     }
 }
 
+/**
+ * @brief Write inside one page without waiting for the write cycle to complete. The EEPROM is probed once first
+ *
+ * @param memoryAddress
+ * @param dataToWrite
+ * @param bufferSize up to one page, must not cross a page line
+ * @return true write sent
+ * @return false EEPROM still busy or the block crosses a page line, nothing was written
+ */
+bool Eeprom24LC32::startWrite(uint32_t memoryAddress, uint8_t *dataToWrite, uint16_t bufferSize)
+{
+    if (bufferSize == 0 || memoryAddress + bufferSize > settings.memorySize_bytes)
+    {
+        return false;
+    }
+    if (memoryAddress / settings.pageSize_bytes != (memoryAddress + bufferSize - 1) / settings.pageSize_bytes)
+    {
+        return false;
+    }
+    if (isBusy())
+    {
+        return false;
+    }
+    uint8_t allData[bufferSize + 2];
+    allData[0] = (uint8_t)(memoryAddress >> 8);   // MSB
+    allData[1] = (uint8_t)(memoryAddress & 0xFF); // LSB
+    for (size_t i = 0; i < bufferSize; i++)
+    {
+        allData[i + 2] = dataToWrite[i];
+    }
+    settings.i2cPort->write(settings.deviceAddress, allData, bufferSize + 2, false);
+    return true;
+}
+
 /**
  * @brief
  *
@@ -93,6 +93,13 @@
 #define ADS1X15_REG_CONFIG_CQUE_NONE (0x0003)       ///< Disable the comparator and put ALERT/RDY in high state (default)
 /*=========================================================================*/
 
+/*=========================================================================
+    CONVERSION READY SIGNALLING
+    -----------------------------------------------------------------------*/
+#define ADS1X15_CONVERSION_READY_HI_THRESH (0x8000) ///< Hi_thresh MSB = 1 enables the conversion ready function
+#define ADS1X15_CONVERSION_READY_LO_THRESH (0x0000) ///< Lo_thresh MSB = 0 enables the conversion ready function
+/*=========================================================================*/
+
 /** Gain settings */
 typedef enum
 {
@@ -144,6 +151,9 @@ public:
   int16_t readDifferentialA0A1();
   int16_t readDifferentialA2A3();
   void startComparatorSingleEnded(uint8_t channel, int16_t threshold);
+  void enableConversionReadyPin();
+  void startSingleEnded(uint8_t channel);
+  void startContinuousSingleEnded(uint8_t channel);
   int16_t getLastConversionResults();
   float computeVolts(int16_t counts);
   void setGain(adsGain_t gain);
@@ -155,6 +165,7 @@ public:
   bool conversionComplete();
   void writeRegister(uint8_t reg, uint16_t value);
   uint16_t readRegister(uint8_t reg);
+  I2cController *getI2cController();
 
 
 private:
@@ -311,6 +311,96 @@ void PICO_ADS1X15::startComparatorSingleEnded(uint8_t channel,
   writeRegister(ADS1X15_REG_POINTER_CONFIG, config);
 }
 
+/**************************************************************************/
+/*!
+    @brief  Turns the comparator into a conversion ready signal. With
+            Hi_thresh MSB set and Lo_thresh MSB cleared the ALERT/RDY pin
+            asserts at the end of every conversion, so the result can be
+            fetched from a GPIO interrupt instead of polling the OS bit.
+*/
+/**************************************************************************/
+void PICO_ADS1X15::enableConversionReadyPin()
+{
+  writeRegister(ADS1X15_REG_POINTER_HITHRESH, ADS1X15_CONVERSION_READY_HI_THRESH);
+  writeRegister(ADS1X15_REG_POINTER_LOWTHRESH, ADS1X15_CONVERSION_READY_LO_THRESH);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Starts a single-ended single-shot conversion and returns
+            without waiting for the result. The ALERT/RDY pin asserts when
+            the conversion is complete (see enableConversionReadyPin()),
+            the result is then read with getLastConversionResults().
+
+    @param channel ADC channel to convert
+*/
+/**************************************************************************/
+void PICO_ADS1X15::startSingleEnded(uint8_t channel)
+{
+  if (channel > 3)
+  {
+    return;
+  }
+
+  uint16_t config =
+      ADS1X15_REG_CONFIG_CQUE_1CONV |   // Assert ALERT/RDY after each conversion
+      ADS1X15_REG_CONFIG_CLAT_NONLAT |  // Non-latching (default val)
+      ADS1X15_REG_CONFIG_CPOL_ACTVLOW | // Alert/Rdy active low   (default val)
+      ADS1X15_REG_CONFIG_CMODE_TRAD |   // Traditional comparator (default val)
+      ADS1X15_REG_CONFIG_MODE_SINGLE;   // Single-shot mode (default)
+
+  // Set PGA/voltage range
+  config |= m_gain;
+
+  // Set data rate
+  config |= m_dataRate;
+
+  // Set single-ended input channel (MUX_SINGLE_0 - MUX_SINGLE_3 are consecutive)
+  config |= ADS1X15_REG_CONFIG_MUX_SINGLE_0 + (channel << 12);
+
+  // Set 'start single-conversion' bit
+  config |= ADS1X15_REG_CONFIG_OS_SINGLE;
+
+  writeRegister(ADS1X15_REG_POINTER_CONFIG, config);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Puts the ADC in continuous conversion mode on a single-ended
+            input. The running conversion is read with
+            getLastConversionResults() without any status polls. A
+            conversion in progress while the mux changes may still finish
+            on the old input, the caller has to discard it.
+
+    @param channel ADC channel to convert
+*/
+/**************************************************************************/
+void PICO_ADS1X15::startContinuousSingleEnded(uint8_t channel)
+{
+  if (channel > 3)
+  {
+    return;
+  }
+
+  uint16_t config =
+      ADS1X15_REG_CONFIG_CQUE_NONE |    // Disable the comparator (default val)
+      ADS1X15_REG_CONFIG_CLAT_NONLAT |  // Non-latching (default val)
+      ADS1X15_REG_CONFIG_CPOL_ACTVLOW | // Alert/Rdy active low   (default val)
+      ADS1X15_REG_CONFIG_CMODE_TRAD |   // Traditional comparator (default val)
+      ADS1X15_REG_CONFIG_MODE_CONTIN;   // Continuous conversion mode
+
+  // Set PGA/voltage range
+  config |= m_gain;
+
+  // Set data rate
+  config |= m_dataRate;
+
+  // Set single-ended input channel (MUX_SINGLE_0 - MUX_SINGLE_3 are consecutive)
+  config |= ADS1X15_REG_CONFIG_MUX_SINGLE_0 + (channel << 12);
+
+  writeRegister(ADS1X15_REG_POINTER_CONFIG, config);
+}
+
 /**************************************************************************/
 /*!
     @brief  In order to clear the comparator, we need to read the
@@ -424,6 +514,15 @@ uint16_t PICO_ADS1X15::readRegister(uint8_t reg)
   return ((buffer[0] << 8) | buffer[1]);
 }
 
+/**************************************************************************/
+/*!
+    @brief  Gets the I2C controller of the bus the ADC is connected to
+
+    @return the I2C controller instance
+*/
+/**************************************************************************/
+I2cController *PICO_ADS1X15::getI2cController() { return m_i2c; }
+
 void PICO_ADS1X15::testWrite()
 {
   uint8_t testBuf[] = {0xAA, 0xCC, 0x33};
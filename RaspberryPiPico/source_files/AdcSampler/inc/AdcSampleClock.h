@@ -0,0 +1,74 @@
+#ifndef __ADC_SAMPLE_CLOCK_H__
+#define __ADC_SAMPLE_CLOCK_H__
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "KnobSampler.h"
+#include "AdcSampler.h"
+
+#define ADC_SAMPLE_CLOCK_SAMPLER_COUNT 2
+#define ADC_SAMPLE_CLOCK_BUFFER_SIZE 32 // Frames, power of two. 160ms at 200Hz before frames get dropped
+
+typedef struct
+{
+    uint32_t timestamp_us;
+    uint16_t value[ADC_SAMPLE_CLOCK_SAMPLER_COUNT][ADC_SAMPLER_CHANNEL_COUNT];
+    uint8_t fresh[ADC_SAMPLE_CLOCK_SAMPLER_COUNT]; // Bit per channel: a new sample since the previous frame
+} adc_sample_frame_t;
+
+/**
+ * @brief Fixed rate sample clock. A repeating timer takes a snapshot of the latest sample of every knob
+ * at the configured rate and pushes it with its timestamp into a ring buffer. The main loop drains the buffer,
+ * so the filters in PotiCtl see one sample per clock tick no matter how long a loop iteration takes.
+ *
+ * The samplers deliver at their own rate, and with a main loop driven acquisition not at all while the main loop is
+ * blocked. A tick without a new sample repeats the last one: the fresh bits mark the channels that really got a new
+ * one, so the filters skip the repeats.
+ *
+ */
+class AdcSampleClock
+{
+protected:
+    KnobSampler *samplers[ADC_SAMPLE_CLOCK_SAMPLER_COUNT];
+    uint32_t period_us;
+    repeating_timer_t timer;
+
+    adc_sample_frame_t frames[ADC_SAMPLE_CLOCK_BUFFER_SIZE];
+    volatile uint32_t head = 0; // Written by the timer callback only
+    volatile uint32_t tail = 0; // Written by the main loop only
+    uint32_t sample_count[ADC_SAMPLE_CLOCK_SAMPLER_COUNT][ADC_SAMPLER_CHANNEL_COUNT] = {}; // At the previous tick
+
+    // Timing statistics
+    uint32_t last_tick_us = 0;
+    volatile uint32_t tick_count = 0;
+    volatile uint32_t dropped_count = 0;
+    volatile int32_t jitter_min_us = 0;
+    volatile int32_t jitter_max_us = 0;
+    uint32_t lag_max_us = 0;
+
+    void tick();
+
+public:
+    AdcSampleClock(KnobSampler *sampler_0, KnobSampler *sampler_1, uint32_t rate_hz);
+    bool start();
+    bool pop(adc_sample_frame_t *frame);
+    uint32_t getPeriodUs();
+    uint32_t getTickCount();
+    uint32_t getDroppedCount();
+    int32_t getJitterMinUs();
+    int32_t getJitterMaxUs();
+    uint32_t getLagMaxUs();
+    void resetStatistics();
+
+    static bool callback_tick(repeating_timer_t *rt)
+    {
+        AdcSampleClock *thisClock = reinterpret_cast<AdcSampleClock *>(rt->user_data);
+        thisClock->tick();
+        return true;
+    }
+};
+
+#endif
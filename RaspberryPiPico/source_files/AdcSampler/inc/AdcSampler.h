@@ -0,0 +1,115 @@
+#ifndef __ADC_SAMPLER_H__
+#define __ADC_SAMPLER_H__
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+#include "ADS1X15.h"
+#include "KnobSampler.h"
+
+#define ADC_SAMPLER_CHANNEL_COUNT 4
+#define ADC_SAMPLER_CONVERSION_TIMEOUT_US 5000 // Recover if an ALERT/RDY edge got lost
+#define ADC_SAMPLER_MUX_SETTLE_US 50           // Extra time after a mux change in continuous mode
+#define ADC_SAMPLER_CONTINUOUS_PERIODS 2       // The conversion running at a mux change may still use the old input
+#define ADC_SAMPLER_CLOCK_TOLERANCE_PERCENT 10 // ADS1015 internal oscillator, the data rate is only +-10% accurate
+#define ADC_SAMPLER_WAKE_UP_US 50              // Single-shot power-up before the conversion starts, with margin
+#define ADC_SAMPLER_RATE_WINDOW_US 1000000     // Window for the effective samples per second
+#define ADC_SAMPLER_IDLE_DIVIDER 8             // Idle channels get one of ADC_SAMPLER_IDLE_DIVIDER conversion slots
+#define ADC_SAMPLER_WAKE_THRESHOLD 6           // Raw deviation from the idle value that promotes an idle channel
+#define ADC_SAMPLER_WAKE_HOLD_US 250000        // Demote a promoted channel again if PotiCtl did not unlock in time
+// Oversampling: every sample is the sum of 4^n conversions shifted right by n, adding n bits of resolution
+// (the noise of the ADC acts as dither). Costs a factor 4^n in sample rate. 0 disables the stage
+#define ADC_SAMPLER_OVERSAMPLE_BITS 1
+#define ADC_SAMPLER_OVERSAMPLE_RATIO (1 << (2 * ADC_SAMPLER_OVERSAMPLE_BITS))
+
+#ifndef __ADC_ACQUISITION_MODES__
+#define __ADC_ACQUISITION_MODES__
+#define ADC_ACQUISITION_POLLING 0    // Blocking single-shot conversion, polling the OS bit until finished
+#define ADC_ACQUISITION_ALERT_RDY 1  // Single-shot conversions signalled by the ALERT/RDY pin
+#define ADC_ACQUISITION_CONTINUOUS 2 // Continuous conversion, rotating the mux through AIN0 - AIN3 on a fixed schedule
+#define ADC_ACQUISITION_INTERLEAVED 3 // Single-shot conversions collected after the conversion time, both buses interleaved
+#endif
+
+/**
+ * @brief Non-blocking sample acquisition for one ADS1X15 filling a per-channel sample buffer.
+ * The main loop only consumes finished samples.
+ *
+ * ADC_ACQUISITION_ALERT_RDY: The ALERT/RDY pin of the ADC is configured as conversion ready signal. When a
+ * conversion is finished the GPIO interrupt fetches the result and starts the conversion of the next channel.
+ *
+ * ADC_ACQUISITION_CONTINUOUS: The ADC converts continuously. service() reads the result once
+ * ADC_SAMPLER_CONTINUOUS_PERIODS conversion periods have passed since the mux change was written, so the
+ * conversion that was running during the change is discarded, and switches the mux to the next channel.
+ *
+ * ADC_ACQUISITION_INTERLEAVED: service() starts a single-shot conversion and returns. The result is read
+ * once the slowest conversion the oscillator tolerance allows plus the power-up time has passed since the config
+ * write, so the CPU can serve the ADC on the other bus in the meantime (see AdcScheduler).
+ *
+ * Conversions are oversampled and decimated by ADC_SAMPLER_OVERSAMPLE_RATIO before they are handed out as a sample,
+ * so samples carry ADC_SAMPLER_OVERSAMPLE_BITS fractional bits.
+ *
+ * Channels reported as locked (idle) by setChannelLocked() are only sampled in one of ADC_SAMPLER_IDLE_DIVIDER
+ * conversion slots, the other slots go to the channels that are moving. An idle channel is promoted as soon as
+ * one of its samples deviates from the idle value.
+ *
+ */
+class AdcSampler : public KnobSampler
+{
+protected:
+    ADS1X15 *adc;
+    uint8_t mode;
+    uint alert_pin;
+    uint32_t conversion_period_us = 0;
+    uint32_t result_wait_us = 0; // From the end of the config write until the result belongs to the new channel
+    volatile uint8_t current_channel = 0;
+    volatile bool conversion_running = false;
+    volatile bool result_pending = false;
+    volatile uint32_t conversion_start_us = 0;
+    volatile uint16_t sample[ADC_SAMPLER_CHANNEL_COUNT] = {0, 0, 0, 0};
+    volatile uint32_t sample_count[ADC_SAMPLER_CHANNEL_COUNT] = {0, 0, 0, 0};
+    uint32_t consumed_count[ADC_SAMPLER_CHANNEL_COUNT] = {0, 0, 0, 0};
+    uint32_t oversample_sum[ADC_SAMPLER_CHANNEL_COUNT] = {0, 0, 0, 0};
+    uint16_t oversample_count[ADC_SAMPLER_CHANNEL_COUNT] = {0, 0, 0, 0};
+
+    uint32_t rate_window_start_us = 0;
+    uint32_t rate_window_start_count[ADC_SAMPLER_CHANNEL_COUNT] = {0, 0, 0, 0};
+    uint16_t samples_per_second[ADC_SAMPLER_CHANNEL_COUNT] = {0, 0, 0, 0};
+
+    volatile bool channel_locked[ADC_SAMPLER_CHANNEL_COUNT] = {false, false, false, false};
+    volatile bool channel_awake[ADC_SAMPLER_CHANNEL_COUNT] = {false, false, false, false};
+    volatile uint32_t wake_us[ADC_SAMPLER_CHANNEL_COUNT] = {0, 0, 0, 0};
+    volatile bool wake_latency_pending[ADC_SAMPLER_CHANNEL_COUNT] = {false, false, false, false};
+    uint16_t idle_reference[ADC_SAMPLER_CHANNEL_COUNT] = {0, 0, 0, 0};
+    uint8_t idle_skips[ADC_SAMPLER_CHANNEL_COUNT] = {0, 0, 0, 0};
+    uint32_t wake_latency_last_us[ADC_SAMPLER_CHANNEL_COUNT] = {0, 0, 0, 0};
+    uint32_t wake_latency_max_us[ADC_SAMPLER_CHANNEL_COUNT] = {0, 0, 0, 0};
+
+    void fetchResultAndStartNext();
+    uint8_t nextChannel(uint8_t channel_index);
+    bool isChannelIdle(uint8_t channel_index);
+    void checkWake(uint8_t channel_index, uint16_t conversion);
+    void updateSampleRates();
+    uint32_t dataRateToSamplesPerSecond(uint16_t data_rate);
+
+public:
+    AdcSampler(ADS1X15 *adc, uint8_t mode, uint alert_pin = 0);
+    void init();
+    void onAlert();
+    void service();
+    bool isSampleDue();
+    uint getAlertPin();
+    bool hasNewSample(uint8_t channel_index);
+    uint16_t takeSample(uint8_t channel_index);
+    uint16_t getLatestSample(uint8_t channel_index);
+    uint8_t getOversampleBits();
+    uint32_t getSampleCount(uint8_t channel_index);
+    uint16_t getSamplesPerSecond(uint8_t channel_index);
+    void setChannelLocked(uint8_t channel_index, bool locked);
+    void messageSent(uint8_t channel_index);
+    uint32_t getWakeLatencyUs(uint8_t channel_index);
+    uint32_t getWakeLatencyMaxUs(uint8_t channel_index);
+};
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef __ADC_SCHEDULER_H__
+#define __ADC_SCHEDULER_H__
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "pico/stdlib.h"
+#include "KnobSampler.h"
+#include "AdcSampler.h"
+
+#define ADC_SCHEDULER_SAMPLER_COUNT 2
+
+/**
+ * @brief Interleaves the acquisition of the two ADCs on their independent I2C buses.
+ * While the ADC on one bus converts, the scheduler reads and restarts the ADC on the other bus, so
+ * the conversion times of both ADCs overlap instead of adding up.
+ *
+ */
+class AdcScheduler
+{
+protected:
+    KnobSampler *samplers[ADC_SCHEDULER_SAMPLER_COUNT];
+    uint8_t next_sampler = 0;
+
+    uint32_t window_start_us = 0;
+    uint32_t window_start_samples = 0;
+    uint32_t scan_period_us = 0;
+
+    uint32_t getTotalSampleCount();
+    void updateScanPeriod();
+
+public:
+    AdcScheduler(KnobSampler *sampler_0, KnobSampler *sampler_1);
+    void service();
+    uint32_t getScanPeriodUs();
+};
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef __KNOB_SAMPLER_H__
+#define __KNOB_SAMPLER_H__
+
+#include <stdint.h>
+
+/**
+ * @brief Acquisition backend interface behind PotiCtl. A backend delivers the knob samples of one group of
+ * four knobs (ADC channels 0 - 3) in ADC counts of the ADS1015 at GAIN_TWOTHIRDS, with getOversampleBits()
+ * fractional bits.
+ *
+ * Implementations: AdcSampler (external ADS1X15 over I2C), Rp2040AdcSampler (on-chip ADC with DMA)
+ *
+ */
+class KnobSampler
+{
+public:
+    virtual ~KnobSampler() {}
+    virtual void service() = 0;
+    virtual bool isSampleDue() = 0;
+    virtual bool hasNewSample(uint8_t channel_index) = 0;
+    virtual uint16_t takeSample(uint8_t channel_index) = 0;
+    virtual uint16_t getLatestSample(uint8_t channel_index) = 0;
+    virtual uint8_t getOversampleBits() = 0;
+    virtual uint32_t getSampleCount(uint8_t channel_index) = 0;
+    virtual uint16_t getSamplesPerSecond(uint8_t channel_index) = 0;
+    virtual void setChannelLocked(uint8_t channel_index, bool locked) = 0;
+    virtual void messageSent(uint8_t channel_index) = 0;
+    virtual uint32_t getWakeLatencyMaxUs(uint8_t channel_index) = 0;
+};
+
+#endif
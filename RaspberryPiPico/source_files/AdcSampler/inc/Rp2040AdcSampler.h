@@ -0,0 +1,61 @@
+#ifndef __RP2040_ADC_SAMPLER_H__
+#define __RP2040_ADC_SAMPLER_H__
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "pico/stdlib.h"
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#include "KnobSampler.h"
+
+#define RP2040_ADC_CHANNEL_COUNT 4       // ADC inputs 0 - 3 (GPIO26 - GPIO29) are knob channels 0 - 3
+#define RP2040_ADC_FIRST_GPIO 26
+#define RP2040_ADC_SAMPLE_RATE_HZ 20000  // Conversions per second over all channels (max 500000)
+#define RP2040_ADC_OVERSAMPLE_BITS 2     // Each sample averages 4^n conversions of its channel
+#define RP2040_ADC_OVERSAMPLE_RATIO (1 << (2 * RP2040_ADC_OVERSAMPLE_BITS))
+#define RP2040_ADC_RING_BITS 9           // Ring buffer of 2^9 bytes = 256 conversions, 12.8ms at 20 kSPS
+#define RP2040_ADC_RING_SIZE ((1 << RP2040_ADC_RING_BITS) / sizeof(uint16_t))
+// Scale the 12 bit conversions (3.3V reference) to ADS1015 counts at GAIN_TWOTHIRDS (3mV per count):
+// count * 3300 / 4096 / 3 = count * 275 / 1024. Keeps calibration limits and defaults of PotiCtl valid
+#define RP2040_ADC_SCALE_NUMERATOR 275
+#define RP2040_ADC_SCALE_SHIFT 10
+
+/**
+ * @brief Acquisition backend using the on-chip ADC. The ADC converts free running in round robin over the four
+ * inputs and two chained DMA channels copy the FIFO into a ring buffer, so samples arrive without any CPU
+ * involvement. A sample is the average of the latest RP2040_ADC_OVERSAMPLE_RATIO conversions of the channel,
+ * read straight from the ring buffer.
+ *
+ * The ring buffer holds a multiple of RP2040_ADC_CHANNEL_COUNT conversions and both DMA channels restart at its
+ * first entry, so entry i always belongs to channel i % RP2040_ADC_CHANNEL_COUNT.
+ *
+ */
+class Rp2040AdcSampler : public KnobSampler
+{
+protected:
+    uint dma_channel_a;
+    uint dma_channel_b;
+    uint32_t start_us = 0;
+    uint32_t sample_period_us;
+    uint32_t taken_us[RP2040_ADC_CHANNEL_COUNT] = {0, 0, 0, 0};
+
+    uint32_t ringWriteIndex();
+
+public:
+    Rp2040AdcSampler();
+    void init();
+    void service();
+    bool isSampleDue();
+    bool hasNewSample(uint8_t channel_index);
+    uint16_t takeSample(uint8_t channel_index);
+    uint16_t getLatestSample(uint8_t channel_index);
+    uint8_t getOversampleBits();
+    uint32_t getSampleCount(uint8_t channel_index);
+    uint16_t getSamplesPerSecond(uint8_t channel_index);
+    void setChannelLocked(uint8_t channel_index, bool locked);
+    void messageSent(uint8_t channel_index);
+    uint32_t getWakeLatencyMaxUs(uint8_t channel_index);
+};
+
+#endif
@@ -0,0 +1,152 @@
+#include "AdcSampleClock.h"
+
+AdcSampleClock::AdcSampleClock(KnobSampler *sampler_0, KnobSampler *sampler_1, uint32_t rate_hz)
+{
+    this->samplers[0] = sampler_0;
+    this->samplers[1] = sampler_1;
+    this->period_us = 1000000 / rate_hz;
+}
+
+/**
+ * @brief Start the repeating timer. A negative delay makes the SDK schedule the ticks relative to the
+ * previous tick start, so a late callback does not shift the following ticks
+ *
+ * @return true if the timer was added
+ */
+bool AdcSampleClock::start()
+{
+    this->last_tick_us = time_us_32();
+    return add_repeating_timer_us(-(int64_t)this->period_us, AdcSampleClock::callback_tick, this, &this->timer);
+}
+
+/**
+ * @brief Take the oldest frame from the buffer
+ *
+ * @param frame
+ * @return true if a frame was available
+ */
+bool AdcSampleClock::pop(adc_sample_frame_t *frame)
+{
+    uint32_t tail = this->tail;
+    if (tail == this->head)
+    {
+        return false;
+    }
+    __compiler_memory_barrier();
+    *frame = this->frames[tail % ADC_SAMPLE_CLOCK_BUFFER_SIZE];
+    __compiler_memory_barrier();
+    this->tail = tail + 1;
+
+    uint32_t lag_us = time_us_32() - frame->timestamp_us;
+    if (lag_us > this->lag_max_us)
+    {
+        this->lag_max_us = lag_us;
+    }
+    return true;
+}
+
+uint32_t AdcSampleClock::getPeriodUs()
+{
+    return this->period_us;
+}
+
+uint32_t AdcSampleClock::getTickCount()
+{
+    return this->tick_count;
+}
+
+/**
+ * @brief Frames dropped because the main loop did not drain the buffer in time
+ *
+ * @return uint32_t
+ */
+uint32_t AdcSampleClock::getDroppedCount()
+{
+    return this->dropped_count;
+}
+
+/**
+ * @brief Smallest deviation of the tick interval from the configured period (negative: early)
+ *
+ * @return int32_t
+ */
+int32_t AdcSampleClock::getJitterMinUs()
+{
+    return this->jitter_min_us;
+}
+
+/**
+ * @brief Largest deviation of the tick interval from the configured period (positive: late)
+ *
+ * @return int32_t
+ */
+int32_t AdcSampleClock::getJitterMaxUs()
+{
+    return this->jitter_max_us;
+}
+
+/**
+ * @brief Largest time between taking a frame and the main loop processing it
+ *
+ * @return uint32_t
+ */
+uint32_t AdcSampleClock::getLagMaxUs()
+{
+    return this->lag_max_us;
+}
+
+void AdcSampleClock::resetStatistics()
+{
+    uint32_t irq_status = save_and_disable_interrupts();
+    this->jitter_min_us = 0;
+    this->jitter_max_us = 0;
+    this->dropped_count = 0;
+    restore_interrupts(irq_status);
+    this->lag_max_us = 0;
+}
+
+// Protected Methods
+
+/**
+ * @brief Timer callback: snapshot the latest sample of all knobs and mark the ones the samplers finished since
+ * the previous tick
+ *
+ */
+void AdcSampleClock::tick()
+{
+    uint32_t now_us = time_us_32();
+    int32_t jitter_us = (int32_t)(now_us - this->last_tick_us) - (int32_t)this->period_us;
+    this->last_tick_us = now_us;
+    if (this->tick_count > 0)
+    {
+        this->jitter_min_us = (jitter_us < this->jitter_min_us) ? jitter_us : this->jitter_min_us;
+        this->jitter_max_us = (jitter_us > this->jitter_max_us) ? jitter_us : this->jitter_max_us;
+    }
+    this->tick_count = this->tick_count + 1;
+
+    uint32_t head = this->head;
+    if (head - this->tail >= ADC_SAMPLE_CLOCK_BUFFER_SIZE)
+    {
+        this->dropped_count = this->dropped_count + 1;
+        return;
+    }
+    adc_sample_frame_t *frame = &this->frames[head % ADC_SAMPLE_CLOCK_BUFFER_SIZE];
+    frame->timestamp_us = now_us;
+    for (uint8_t i = 0; i < ADC_SAMPLE_CLOCK_SAMPLER_COUNT; i++)
+    {
+        frame->fresh[i] = 0;
+        for (uint8_t channel = 0; channel < ADC_SAMPLER_CHANNEL_COUNT; channel++)
+        {
+            // Count before value: a sample finishing in between is taken now and only repeated at the next tick
+            uint32_t count = this->samplers[i]->getSampleCount(channel);
+            frame->value[i][channel] = this->samplers[i]->getLatestSample(channel);
+            if (count != this->sample_count[i][channel])
+            {
+                this->sample_count[i][channel] = count;
+                frame->fresh[i] |= 1 << channel;
+            }
+        }
+    }
+    __compiler_memory_barrier();
+    this->head = head + 1;
+}
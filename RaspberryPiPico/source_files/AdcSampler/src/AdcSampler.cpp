@@ -0,0 +1,390 @@
+#include "AdcSampler.h"
+
+AdcSampler::AdcSampler(ADS1X15 *adc, uint8_t mode, uint alert_pin)
+{
+    this->adc = adc;
+    this->mode = mode;
+    this->alert_pin = alert_pin;
+}
+
+/**
+ * @brief Start the acquisition.
+ * In ADC_ACQUISITION_ALERT_RDY mode the GPIO interrupt has to be routed to onAlert() by the caller,
+ * because the SDK only supports one GPIO callback per core.
+ *
+ */
+void AdcSampler::init()
+{
+    this->current_channel = 0;
+    this->rate_window_start_us = time_us_32();
+    this->conversion_period_us = 1000000 / this->dataRateToSamplesPerSecond(this->adc->getDataRate()) + 1;
+    // The results are only collected by time, wait for the slowest conversion the oscillator allows
+    uint32_t slow_period_us = this->conversion_period_us * (100 + ADC_SAMPLER_CLOCK_TOLERANCE_PERCENT) / 100;
+    this->result_wait_us = slow_period_us + ADC_SAMPLER_WAKE_UP_US;
+    if (this->mode == ADC_ACQUISITION_CONTINUOUS)
+    {
+        this->result_wait_us = ADC_SAMPLER_CONTINUOUS_PERIODS * slow_period_us + ADC_SAMPLER_MUX_SETTLE_US;
+    }
+
+    switch (this->mode)
+    {
+    case ADC_ACQUISITION_INTERLEAVED:
+        this->conversion_running = true;
+        this->adc->startSingleEnded(this->current_channel);
+        this->conversion_start_us = time_us_32();
+        break;
+
+    case ADC_ACQUISITION_ALERT_RDY:
+        gpio_init(this->alert_pin);
+        gpio_set_dir(this->alert_pin, GPIO_IN);
+        gpio_pull_up(this->alert_pin);
+
+        this->adc->enableConversionReadyPin();
+        this->conversion_running = true;
+        this->adc->startSingleEnded(this->current_channel);
+        this->conversion_start_us = time_us_32();
+        break;
+
+    case ADC_ACQUISITION_CONTINUOUS:
+        this->conversion_running = true;
+        this->adc->startContinuousSingleEnded(this->current_channel);
+        this->conversion_start_us = time_us_32();
+        break;
+    }
+}
+
+/**
+ * @brief Called from the GPIO interrupt when ALERT/RDY asserts.
+ * If the main loop is in the middle of a transfer on the same bus (i.e. EEPROM access) the result
+ * is left in the ADC and fetched by the next call of service()
+ *
+ */
+void AdcSampler::onAlert()
+{
+    if (!this->conversion_running || this->mode != ADC_ACQUISITION_ALERT_RDY)
+    {
+        return;
+    }
+    if (this->adc->getI2cController()->isTransferActive())
+    {
+        this->result_pending = true;
+        return;
+    }
+    this->fetchResultAndStartNext();
+}
+
+/**
+ * @brief Main loop hook.
+ * ADC_ACQUISITION_ALERT_RDY: completes conversions that could not be handled in the interrupt
+ * ADC_ACQUISITION_CONTINUOUS: reads the current channel and rotates the mux when the conversion period has passed
+ * ADC_ACQUISITION_INTERLEAVED: reads the result and starts the next conversion when the conversion time has passed
+ *
+ */
+void AdcSampler::service()
+{
+    uint32_t elapsed_us = time_us_32() - this->conversion_start_us;
+    switch (this->mode)
+    {
+    case ADC_ACQUISITION_ALERT_RDY:
+    {
+        bool timed_out = this->conversion_running && elapsed_us > ADC_SAMPLER_CONVERSION_TIMEOUT_US;
+        if (this->result_pending || timed_out)
+        {
+            // Keep the ALERT/RDY interrupt from fetching the same result
+            uint32_t irq_status = save_and_disable_interrupts();
+            this->result_pending = false;
+            this->fetchResultAndStartNext();
+            restore_interrupts(irq_status);
+        }
+        break;
+    }
+    case ADC_ACQUISITION_CONTINUOUS:
+    case ADC_ACQUISITION_INTERLEAVED:
+        if (this->conversion_running && elapsed_us >= this->result_wait_us)
+        {
+            this->fetchResultAndStartNext();
+        }
+        break;
+    }
+
+    // A promoted channel that PotiCtl did not pick up (i.e. a single noisy sample) goes back to idle
+    for (uint8_t i = 0; i < ADC_SAMPLER_CHANNEL_COUNT; i++)
+    {
+        if (this->channel_awake[i] && this->channel_locked[i] && (time_us_32() - this->wake_us[i]) > ADC_SAMPLER_WAKE_HOLD_US)
+        {
+            this->channel_awake[i] = false;
+            this->wake_latency_pending[i] = false;
+            this->idle_reference[i] = this->sample[i];
+        }
+    }
+    this->updateSampleRates();
+}
+
+/**
+ * @brief True when the next call of service() will read a result
+ *
+ * @return true
+ * @return false
+ */
+bool AdcSampler::isSampleDue()
+{
+    uint32_t elapsed_us = time_us_32() - this->conversion_start_us;
+    switch (this->mode)
+    {
+    case ADC_ACQUISITION_ALERT_RDY:
+        return this->result_pending || (this->conversion_running && elapsed_us > ADC_SAMPLER_CONVERSION_TIMEOUT_US);
+    default:
+        return this->conversion_running && elapsed_us >= this->result_wait_us;
+    }
+}
+
+uint AdcSampler::getAlertPin()
+{
+    return this->alert_pin;
+}
+
+bool AdcSampler::hasNewSample(uint8_t channel_index)
+{
+    return this->sample_count[channel_index] != this->consumed_count[channel_index];
+}
+
+uint16_t AdcSampler::takeSample(uint8_t channel_index)
+{
+    this->consumed_count[channel_index] = this->sample_count[channel_index];
+    return this->sample[channel_index];
+}
+
+/**
+ * @brief Latest sample of the channel without consuming it (used by AdcSampleClock)
+ *
+ * @param channel_index
+ * @return uint16_t
+ */
+uint16_t AdcSampler::getLatestSample(uint8_t channel_index)
+{
+    return this->sample[channel_index];
+}
+
+/**
+ * @brief Number of fractional bits of the samples (see ADC_SAMPLER_OVERSAMPLE_BITS)
+ *
+ * @return uint8_t
+ */
+uint8_t AdcSampler::getOversampleBits()
+{
+    return ADC_SAMPLER_OVERSAMPLE_BITS;
+}
+
+uint32_t AdcSampler::getSampleCount(uint8_t channel_index)
+{
+    return this->sample_count[channel_index];
+}
+
+/**
+ * @brief Effective samples per second of one channel after decimation, measured over the last ADC_SAMPLER_RATE_WINDOW_US
+ *
+ * @param channel_index
+ * @return uint16_t
+ */
+uint16_t AdcSampler::getSamplesPerSecond(uint8_t channel_index)
+{
+    return this->samples_per_second[channel_index];
+}
+
+/**
+ * @brief Report the lock state of the PotiCtl channel. Locked channels are sampled at a low background rate
+ *
+ * @param channel_index
+ * @param locked
+ */
+void AdcSampler::setChannelLocked(uint8_t channel_index, bool locked)
+{
+    if (locked && !this->channel_locked[channel_index])
+    {
+        this->idle_reference[channel_index] = this->sample[channel_index];
+    }
+    if (!locked)
+    {
+        // PotiCtl picked up the movement
+        this->channel_awake[channel_index] = false;
+    }
+    this->channel_locked[channel_index] = locked;
+}
+
+/**
+ * @brief Called when a value of the channel was sent. Completes the move-to-first-message latency measurement
+ *
+ * @param channel_index
+ */
+void AdcSampler::messageSent(uint8_t channel_index)
+{
+    if (!this->wake_latency_pending[channel_index])
+    {
+        return;
+    }
+    this->wake_latency_pending[channel_index] = false;
+    uint32_t latency_us = time_us_32() - this->wake_us[channel_index];
+    this->wake_latency_last_us[channel_index] = latency_us;
+    if (latency_us > this->wake_latency_max_us[channel_index])
+    {
+        this->wake_latency_max_us[channel_index] = latency_us;
+    }
+}
+
+/**
+ * @brief Time from the first sample showing the movement of an idle knob to the first message sent
+ *
+ * @param channel_index
+ * @return uint32_t
+ */
+uint32_t AdcSampler::getWakeLatencyUs(uint8_t channel_index)
+{
+    return this->wake_latency_last_us[channel_index];
+}
+
+uint32_t AdcSampler::getWakeLatencyMaxUs(uint8_t channel_index)
+{
+    return this->wake_latency_max_us[channel_index];
+}
+
+// Protected Methods
+
+void AdcSampler::fetchResultAndStartNext()
+{
+    uint8_t channel = this->current_channel;
+    // Single ended results can be slightly negative close to ground
+    int16_t result = this->adc->getLastConversionResults();
+    uint16_t conversion = (result < 0) ? 0 : (uint16_t)result;
+    this->checkWake(channel, conversion);
+
+    // Decimate: hand out the sum of ADC_SAMPLER_OVERSAMPLE_RATIO conversions with ADC_SAMPLER_OVERSAMPLE_BITS extra bits
+    this->oversample_sum[channel] += conversion;
+    this->oversample_count[channel]++;
+    if (this->oversample_count[channel] >= ADC_SAMPLER_OVERSAMPLE_RATIO)
+    {
+        this->sample[channel] = (uint16_t)(this->oversample_sum[channel] >> ADC_SAMPLER_OVERSAMPLE_BITS);
+        this->sample_count[channel] = this->sample_count[channel] + 1;
+        this->oversample_sum[channel] = 0;
+        this->oversample_count[channel] = 0;
+    }
+
+    this->current_channel = this->nextChannel(channel);
+    if (this->mode == ADC_ACQUISITION_CONTINUOUS)
+    {
+        this->adc->startContinuousSingleEnded(this->current_channel);
+    }
+    else
+    {
+        this->adc->startSingleEnded(this->current_channel);
+    }
+    // The new input is only selected once the config write is on the chip
+    this->conversion_start_us = time_us_32();
+}
+
+/**
+ * @brief Pick the channel for the next conversion slot: an idle channel that waited ADC_SAMPLER_IDLE_DIVIDER slots,
+ * otherwise the next channel that is not idle
+ *
+ * @param channel_index channel of the current slot
+ * @return uint8_t
+ */
+uint8_t AdcSampler::nextChannel(uint8_t channel_index)
+{
+    uint8_t next = ADC_SAMPLER_CHANNEL_COUNT;
+    for (uint8_t i = 1; i <= ADC_SAMPLER_CHANNEL_COUNT; i++)
+    {
+        uint8_t channel = (channel_index + i) % ADC_SAMPLER_CHANNEL_COUNT;
+        if (this->isChannelIdle(channel))
+        {
+            this->idle_skips[channel]++;
+            if (this->idle_skips[channel] >= ADC_SAMPLER_IDLE_DIVIDER && next == ADC_SAMPLER_CHANNEL_COUNT)
+            {
+                next = channel;
+            }
+        }
+    }
+    if (next == ADC_SAMPLER_CHANNEL_COUNT)
+    {
+        for (uint8_t i = 1; i <= ADC_SAMPLER_CHANNEL_COUNT; i++)
+        {
+            uint8_t channel = (channel_index + i) % ADC_SAMPLER_CHANNEL_COUNT;
+            if (!this->isChannelIdle(channel))
+            {
+                next = channel;
+                break;
+            }
+        }
+    }
+    if (next == ADC_SAMPLER_CHANNEL_COUNT)
+    {
+        // All channels idle: plain round robin
+        next = (channel_index + 1) % ADC_SAMPLER_CHANNEL_COUNT;
+    }
+    this->idle_skips[next] = 0;
+    return next;
+}
+
+bool AdcSampler::isChannelIdle(uint8_t channel_index)
+{
+    return this->channel_locked[channel_index] && !this->channel_awake[channel_index];
+}
+
+/**
+ * @brief Promote an idle channel as soon as a conversion deviates from the value it was locked at.
+ * Checked on every conversion, so oversampling does not delay the promotion
+ *
+ * @param channel_index
+ * @param conversion raw conversion result
+ */
+void AdcSampler::checkWake(uint8_t channel_index, uint16_t conversion)
+{
+    if (!this->isChannelIdle(channel_index))
+    {
+        return;
+    }
+    int deviation = ((int)conversion << ADC_SAMPLER_OVERSAMPLE_BITS) - (int)this->idle_reference[channel_index];
+    if (abs(deviation) > (ADC_SAMPLER_WAKE_THRESHOLD << ADC_SAMPLER_OVERSAMPLE_BITS))
+    {
+        this->channel_awake[channel_index] = true;
+        this->wake_us[channel_index] = time_us_32();
+        this->wake_latency_pending[channel_index] = true;
+    }
+}
+
+void AdcSampler::updateSampleRates()
+{
+    uint32_t window_us = time_us_32() - this->rate_window_start_us;
+    if (window_us < ADC_SAMPLER_RATE_WINDOW_US)
+    {
+        return;
+    }
+    for (uint8_t i = 0; i < ADC_SAMPLER_CHANNEL_COUNT; i++)
+    {
+        uint32_t count = this->sample_count[i];
+        this->samples_per_second[i] = (uint16_t)(((uint64_t)(count - this->rate_window_start_count[i]) * 1000000) / window_us);
+        this->rate_window_start_count[i] = count;
+    }
+    this->rate_window_start_us += window_us;
+}
+
+uint32_t AdcSampler::dataRateToSamplesPerSecond(uint16_t data_rate)
+{
+    // ADS1015 data rates
+    switch (data_rate)
+    {
+    case RATE_ADS1015_128SPS:
+        return 128;
+    case RATE_ADS1015_250SPS:
+        return 250;
+    case RATE_ADS1015_490SPS:
+        return 490;
+    case RATE_ADS1015_920SPS:
+        return 920;
+    case RATE_ADS1015_1600SPS:
+        return 1600;
+    case RATE_ADS1015_2400SPS:
+        return 2400;
+    default:
+        return 3300;
+    }
+}
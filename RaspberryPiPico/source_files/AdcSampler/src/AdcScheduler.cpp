@@ -0,0 +1,67 @@
+#include "AdcScheduler.h"
+
+AdcScheduler::AdcScheduler(KnobSampler *sampler_0, KnobSampler *sampler_1)
+{
+    this->samplers[0] = sampler_0;
+    this->samplers[1] = sampler_1;
+    this->window_start_us = time_us_32();
+}
+
+/**
+ * @brief Main loop hook: serve the sampler whose result is due first, then the other one.
+ * The start order alternates, so when both are due neither bus is always served last.
+ *
+ */
+void AdcScheduler::service()
+{
+    uint8_t first = this->next_sampler;
+    uint8_t second = first ^ 0x01;
+    if (!this->samplers[first]->isSampleDue() && this->samplers[second]->isSampleDue())
+    {
+        first = second;
+        second = first ^ 0x01;
+    }
+    this->samplers[first]->service();
+    this->samplers[second]->service();
+    this->next_sampler = second;
+    this->updateScanPeriod();
+}
+
+/**
+ * @brief Average time for a full scan of all knobs on both ADCs, measured over the last ADC_SAMPLER_RATE_WINDOW_US
+ *
+ * @return uint32_t
+ */
+uint32_t AdcScheduler::getScanPeriodUs()
+{
+    return this->scan_period_us;
+}
+
+// Protected Methods
+
+uint32_t AdcScheduler::getTotalSampleCount()
+{
+    uint32_t count = 0;
+    for (uint8_t i = 0; i < ADC_SCHEDULER_SAMPLER_COUNT; i++)
+    {
+        for (uint8_t channel = 0; channel < ADC_SAMPLER_CHANNEL_COUNT; channel++)
+        {
+            count += this->samplers[i]->getSampleCount(channel);
+        }
+    }
+    return count;
+}
+
+void AdcScheduler::updateScanPeriod()
+{
+    uint32_t window_us = time_us_32() - this->window_start_us;
+    if (window_us < ADC_SAMPLER_RATE_WINDOW_US)
+    {
+        return;
+    }
+    uint32_t samples = this->getTotalSampleCount();
+    uint32_t scans = (samples - this->window_start_samples) / (ADC_SCHEDULER_SAMPLER_COUNT * ADC_SAMPLER_CHANNEL_COUNT);
+    this->scan_period_us = (scans > 0) ? window_us / scans : 0;
+    this->window_start_samples = samples;
+    this->window_start_us += window_us;
+}
@@ -0,0 +1,160 @@
+#include "Rp2040AdcSampler.h"
+
+// DMA ring buffers have to be aligned to their size
+static uint16_t rp2040_adc_ring[RP2040_ADC_RING_SIZE] __attribute__((aligned(1 << RP2040_ADC_RING_BITS)));
+
+Rp2040AdcSampler::Rp2040AdcSampler()
+{
+    // A new sample needs RP2040_ADC_OVERSAMPLE_RATIO fresh conversions of the channel
+    this->sample_period_us = (uint32_t)(((uint64_t)RP2040_ADC_OVERSAMPLE_RATIO * RP2040_ADC_CHANNEL_COUNT * 1000000) / RP2040_ADC_SAMPLE_RATE_HZ);
+}
+
+/**
+ * @brief Configure the ADC in free running round robin mode and start the DMA ring
+ *
+ */
+void Rp2040AdcSampler::init()
+{
+    adc_init();
+    for (uint8_t i = 0; i < RP2040_ADC_CHANNEL_COUNT; i++)
+    {
+        adc_gpio_init(RP2040_ADC_FIRST_GPIO + i);
+    }
+    adc_select_input(0);
+    adc_set_round_robin((1 << RP2040_ADC_CHANNEL_COUNT) - 1);
+    // FIFO with DREQ, one conversion per request, no error bit, full 12 bit
+    adc_fifo_setup(true, true, 1, false, false);
+    // 96 cycles per conversion at 48MHz: the divider sets the time between the start of two conversions
+    adc_set_clkdiv(48000000.f / RP2040_ADC_SAMPLE_RATE_HZ - 1);
+
+    // Two channels each fill the ring once and trigger each other: the ring is refilled forever without CPU
+    this->dma_channel_a = dma_claim_unused_channel(true);
+    this->dma_channel_b = dma_claim_unused_channel(true);
+    uint channels[2] = {this->dma_channel_a, this->dma_channel_b};
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        dma_channel_config config = dma_channel_get_default_config(channels[i]);
+        channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+        channel_config_set_read_increment(&config, false);
+        channel_config_set_write_increment(&config, true);
+        channel_config_set_ring(&config, true, RP2040_ADC_RING_BITS);
+        channel_config_set_dreq(&config, DREQ_ADC);
+        channel_config_set_chain_to(&config, channels[i ^ 0x01]);
+        dma_channel_configure(channels[i], &config, rp2040_adc_ring, &adc_hw->fifo, RP2040_ADC_RING_SIZE, false);
+    }
+    adc_fifo_drain();
+    dma_channel_start(this->dma_channel_a);
+    adc_run(true);
+    this->start_us = time_us_32();
+}
+
+/**
+ * @brief Nothing to do: the DMA keeps the ring buffer up to date
+ *
+ */
+void Rp2040AdcSampler::service()
+{
+}
+
+bool Rp2040AdcSampler::isSampleDue()
+{
+    return false;
+}
+
+bool Rp2040AdcSampler::hasNewSample(uint8_t channel_index)
+{
+    return (time_us_32() - this->taken_us[channel_index]) >= this->sample_period_us;
+}
+
+uint16_t Rp2040AdcSampler::takeSample(uint8_t channel_index)
+{
+    this->taken_us[channel_index] = time_us_32();
+    return this->getLatestSample(channel_index);
+}
+
+/**
+ * @brief Average of the latest RP2040_ADC_OVERSAMPLE_RATIO conversions of the channel, scaled to ADS1015 counts
+ * with RP2040_ADC_OVERSAMPLE_BITS fractional bits
+ *
+ * @param channel_index
+ * @return uint16_t
+ */
+uint16_t Rp2040AdcSampler::getLatestSample(uint8_t channel_index)
+{
+    // Latest finished conversion of the channel
+    uint32_t last = (this->ringWriteIndex() + RP2040_ADC_RING_SIZE - 1) % RP2040_ADC_RING_SIZE;
+    uint32_t offset = (last + RP2040_ADC_CHANNEL_COUNT - channel_index) % RP2040_ADC_CHANNEL_COUNT;
+    uint32_t index = (last + RP2040_ADC_RING_SIZE - offset) % RP2040_ADC_RING_SIZE;
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < RP2040_ADC_OVERSAMPLE_RATIO; i++)
+    {
+        sum += rp2040_adc_ring[index] & 0x0FFF;
+        index = (index + RP2040_ADC_RING_SIZE - RP2040_ADC_CHANNEL_COUNT) % RP2040_ADC_RING_SIZE;
+    }
+    // sum / 4^n * 2^n = sum >> n
+    return (uint16_t)((sum * RP2040_ADC_SCALE_NUMERATOR) >> (RP2040_ADC_SCALE_SHIFT + RP2040_ADC_OVERSAMPLE_BITS));
+}
+
+uint8_t Rp2040AdcSampler::getOversampleBits()
+{
+    return RP2040_ADC_OVERSAMPLE_BITS;
+}
+
+/**
+ * @brief Independent samples of the channel since init(). The ADC runs at a fixed rate, so this is derived from the time
+ *
+ * @return uint32_t
+ */
+uint32_t Rp2040AdcSampler::getSampleCount(uint8_t)
+{
+    return (time_us_32() - this->start_us) / this->sample_period_us;
+}
+
+uint16_t Rp2040AdcSampler::getSamplesPerSecond(uint8_t)
+{
+    return (uint16_t)(1000000 / this->sample_period_us);
+}
+
+/**
+ * @brief All channels convert at the full rate, there is no bandwidth to hand to the moving knobs
+ *
+ */
+void Rp2040AdcSampler::setChannelLocked(uint8_t, bool)
+{
+}
+
+void Rp2040AdcSampler::messageSent(uint8_t)
+{
+}
+
+uint32_t Rp2040AdcSampler::getWakeLatencyMaxUs(uint8_t)
+{
+    return 0;
+}
+
+// Protected Methods
+
+/**
+ * @brief Ring buffer entry the DMA writes next
+ *
+ * @return uint32_t
+ */
+uint32_t Rp2040AdcSampler::ringWriteIndex()
+{
+    while (true)
+    {
+        bool a_busy = dma_channel_is_busy(this->dma_channel_a);
+        if (!a_busy && !dma_channel_is_busy(this->dma_channel_b))
+        {
+            // Between the end of one channel and the chained start of the other: the ring was just filled
+            return 0;
+        }
+        uint channel = a_busy ? this->dma_channel_a : this->dma_channel_b;
+        uint32_t write_addr = dma_hw->ch[channel].write_addr;
+        // Busy before and after the read: the address is not one that already wrapped at the end of the ring
+        if (dma_channel_is_busy(channel))
+        {
+            return ((write_addr - (uint32_t)(uintptr_t)rp2040_adc_ring) / sizeof(uint16_t)) % RP2040_ADC_RING_SIZE;
+        }
+    }
+}
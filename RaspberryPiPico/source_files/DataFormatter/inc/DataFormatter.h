@@ -20,18 +20,50 @@
 #endif
 #define BIT_MASK_0_7  (0b0000000001111111)
 #define BIT_MASK_8_14 (0b0011111110000000)
+#define DATA_FORMATTER_VALUE_MAX 0x3FFF // 14 bit: two 7 bit data bytes
+
+// Wire formats of the upstream packets
+// LEGACY: every message is [status, cc, lsb, msb]
+// COMPACT: MIDI style running status, the status byte is only sent when it changes. A message is either
+//  long:  [cc, lsb, msb]             cc 0x00 - 0x3F, any 14 bit value
+//  short: [0x40 | v8_7 << 4 | cc, v6_0] cc 0x00 - 0x0F, values 0 - 511
+// A legacy packet is a status byte followed by a long message, so a compact parser reads both formats
+// BATCH: everything one board sends in one pass goes into one frame [0xA0 | board, count, count messages], the
+// messages are encoded as in the compact format. There is no running status around the frames
+#define DATA_FORMATTER_WIRE_LEGACY 0
+#define DATA_FORMATTER_WIRE_COMPACT 1
+#define DATA_FORMATTER_WIRE_BATCH 2
+#define DATA_FORMATTER_STATUS_BATCH 0xA0
+#define DATA_FORMATTER_BATCH_MAX 16 // Messages per batch frame (count byte < 0x80)
+#define DATA_FORMATTER_BATCH_HEADER_BYTES 2
+#define DATA_FORMATTER_SHORT_FLAG 0x40
+#define DATA_FORMATTER_SHORT_CC_MAX 0x0F
+#define DATA_FORMATTER_SHORT_VALUE_MAX 0x1FF
+#define DATA_FORMATTER_MAX_BYTES 4        // Longest output of one formatData() call
+#define DATA_FORMATTER_MESSAGE_MAX_BYTES 3 // Longest message without status byte
+#define DATA_FORMATTER_STATUS_REFRESH 16 // Repeat the running status after this many messages, lets a receiver resync
 
 class DataFormatter
 {
 protected:
     uint8_t board_index = 0;
+    uint8_t wire_format = DATA_FORMATTER_WIRE_LEGACY;
+    uint8_t running_status = 0x00; // 0x00: the receiver does not know the running status
+    uint8_t status_messages = 0;   // Messages since the running status was sent
     void _printBitField32(uint32_t bitField);
      void _printBitField16(uint16_t bitField);
     void _printBitField8(uint8_t bitField, bool linbreak = false);
 
 public:
     DataFormatter(uint8_t board_index);
-    void formatData(uint8_t cc_num, uint16_t value, uint8_t *formatted);
+    uint8_t formatData(uint8_t cc_num, uint16_t value, uint8_t *formatted);
+    uint8_t formatMessage(uint8_t cc_num, uint16_t value, uint8_t *formatted);
+    uint8_t formatStatus(uint8_t status_byte, uint8_t *formatted);
+    uint8_t formatBatchHeader(uint8_t board_index, uint8_t count, uint8_t *formatted);
+    void setWireFormat(uint8_t wire_format);
+    uint8_t getWireFormat();
+    void invalidateRunningStatus();
+    static uint8_t messageLength(uint8_t first_byte);
     void test();
 
 };
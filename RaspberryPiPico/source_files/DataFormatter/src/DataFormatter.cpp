@@ -5,10 +5,33 @@ DataFormatter::DataFormatter(uint8_t board_index)
     this->board_index = board_index;
 }
 
-void DataFormatter::formatData(uint8_t cc_num, uint16_t value, uint8_t *formatted)
+/**
+ * @brief Format one controller value with its status byte, legacy or compact format
+ *
+ * @param cc_num
+ * @param value
+ * @param formatted at least DATA_FORMATTER_MAX_BYTES
+ * @return uint8_t number of bytes
+ */
+uint8_t DataFormatter::formatData(uint8_t cc_num, uint16_t value, uint8_t *formatted)
 {
-    // Clip value to allowed maximum
-    value = (value > 511) ? 511 : value;
+    uint8_t status_byte = (MIDI_MASK_STAUS_CC | this->board_index);
+    uint8_t length = this->formatStatus(status_byte, formatted);
+    return length + this->formatMessage(cc_num, value, &formatted[length]);
+}
+
+/**
+ * @brief Format one controller value without status byte. Short form, if the wire format and the value allow it
+ *
+ * @param cc_num
+ * @param value
+ * @param formatted at least DATA_FORMATTER_MESSAGE_MAX_BYTES
+ * @return uint8_t number of bytes
+ */
+uint8_t DataFormatter::formatMessage(uint8_t cc_num, uint16_t value, uint8_t *formatted)
+{
+    // Clip value to allowed maximum. Knobs send 9 - 14 bit values depending on their resolution
+    value = (value > DATA_FORMATTER_VALUE_MAX) ? DATA_FORMATTER_VALUE_MAX : value;
 
     // byte 0 contains bits 0-7
     // byte 1 contains bits 8-14
@@ -17,11 +40,86 @@ void DataFormatter::formatData(uint8_t cc_num, uint16_t value, uint8_t *formatte
     byte_lsb = value & BIT_MASK_0_7;        // MSB
     byte_msb = (value >> 7) & BIT_MASK_0_7; // LSB
 
-    uint8_t status_byte = (MIDI_MASK_STAUS_CC | this->board_index);
+    if (this->wire_format != DATA_FORMATTER_WIRE_LEGACY && cc_num <= DATA_FORMATTER_SHORT_CC_MAX && value <= DATA_FORMATTER_SHORT_VALUE_MAX)
+    {
+        formatted[0] = DATA_FORMATTER_SHORT_FLAG | (byte_msb << 4) | cc_num;
+        formatted[1] = byte_lsb;
+        return 2;
+    }
+    formatted[0] = cc_num;
+    formatted[1] = byte_lsb;
+    formatted[2] = byte_msb;
+    return 3;
+}
+
+/**
+ * @brief Header of a batch frame. The frame ends the running status of the line
+ *
+ * @param board_index board the messages of the frame belong to
+ * @param count messages following, 1 - DATA_FORMATTER_BATCH_MAX
+ * @param formatted at least DATA_FORMATTER_BATCH_HEADER_BYTES
+ * @return uint8_t number of bytes
+ */
+uint8_t DataFormatter::formatBatchHeader(uint8_t board_index, uint8_t count, uint8_t *formatted)
+{
+    this->invalidateRunningStatus();
+    formatted[0] = DATA_FORMATTER_STATUS_BATCH | (board_index & 0x0F);
+    formatted[1] = count;
+    return DATA_FORMATTER_BATCH_HEADER_BYTES;
+}
+
+/**
+ * @brief Status byte to send ahead of the next message with this status. Counts the message
+ *
+ * @param status_byte
+ * @param formatted
+ * @return uint8_t 1: status byte written, 0: running status still valid (compact format only)
+ */
+uint8_t DataFormatter::formatStatus(uint8_t status_byte, uint8_t *formatted)
+{
+    if (this->wire_format == DATA_FORMATTER_WIRE_COMPACT && status_byte == this->running_status && this->status_messages < DATA_FORMATTER_STATUS_REFRESH)
+    {
+        this->status_messages++;
+        return 0;
+    }
+    this->running_status = status_byte;
+    this->status_messages = 1;
     formatted[0] = status_byte;
-    formatted[1] = cc_num;
-    formatted[2] = byte_lsb;
-    formatted[3] = byte_msb;
+    return 1;
+}
+
+void DataFormatter::setWireFormat(uint8_t wire_format)
+{
+    if (wire_format != this->wire_format)
+    {
+        this->wire_format = wire_format;
+        this->invalidateRunningStatus();
+    }
+}
+
+uint8_t DataFormatter::getWireFormat()
+{
+    return this->wire_format;
+}
+
+/**
+ * @brief Send the status byte with the next message. Needed after a message was cut short on the line
+ *
+ */
+void DataFormatter::invalidateRunningStatus()
+{
+    this->running_status = 0x00;
+}
+
+/**
+ * @brief Length of a message from its first data byte, without the status byte
+ *
+ * @param first_byte
+ * @return uint8_t
+ */
+uint8_t DataFormatter::messageLength(uint8_t first_byte)
+{
+    return (first_byte & DATA_FORMATTER_SHORT_FLAG) ? 2 : 3;
 }
 
 void DataFormatter::test()
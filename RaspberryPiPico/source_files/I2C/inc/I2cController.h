@@ -27,6 +27,8 @@ class I2cController
 {
 private:
     bool _initialized = false;
+    volatile bool _transfer_active = false;
+    volatile uint32_t _transaction_count = 0;
 
 protected:
     // Instance-specific properties
@@ -53,6 +55,8 @@ public:
     int write(uint8_t address, uint8_t *data, size_t size, bool nostop);
     int read(uint8_t address, uint8_t *data, size_t size, bool nostop);
     bool isInitialized();
+    bool isTransferActive();
+    uint32_t getTransactionCount();
     void scanBus();
     void test();
 };
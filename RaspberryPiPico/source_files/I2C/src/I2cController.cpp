@@ -165,7 +165,11 @@ uint I2cController::setClock(uint baudrate)
  */
 int I2cController::write(uint8_t address, uint8_t *data, size_t size, bool nostop)
 {
-    return i2c_write_blocking(m_i2c_bus, address, data, size, nostop);
+    _transfer_active = true;
+    int result = i2c_write_blocking(m_i2c_bus, address, data, size, nostop);
+    _transaction_count++;
+    _transfer_active = false;
+    return result;
 }
 
 /**
@@ -179,7 +183,33 @@ int I2cController::write(uint8_t address, uint8_t *data, size_t size, bool nosto
  */
 int I2cController::read(uint8_t address, uint8_t *data, size_t size, bool nostop)
 {
-    return i2c_read_blocking(m_i2c_bus, address, data, size, nostop);
+    _transfer_active = true;
+    int result = i2c_read_blocking(m_i2c_bus, address, data, size, nostop);
+    _transaction_count++;
+    _transfer_active = false;
+    return result;
+}
+
+/**
+ * @brief True while a write or read is running on the bus. Used by interrupt handlers
+ * to avoid starting a transfer in the middle of a transfer of the main loop.
+ *
+ * @return true
+ * @return false
+ */
+bool I2cController::isTransferActive()
+{
+    return _transfer_active;
+}
+
+/**
+ * @brief Number of write and read transactions since start up
+ *
+ * @return uint32_t
+ */
+uint32_t I2cController::getTransactionCount()
+{
+    return _transaction_count;
 }
 
 /**
@@ -10,6 +10,10 @@
 #include "hardware/pio.h"
 #include "RpConfig.h"
 #include "PotiCtl.h"
+#include "DataFormatter.h"
+#include "LinkCtl.h"
+#include "RemoteCmdEngine.h"
+#include "JobScheduler.h"
 
 #ifndef __BIT_MACROS__
 #define __BIT_MACROS__
@@ -46,6 +50,16 @@ typedef struct
 
 #define LONG_PRESS_INTERVAL 1000
 
+// LED feedback, run as jobs
+#define INDICATE_BLINK_STEPS 12 // 6 times on and off
+#define INDICATE_BLINK_US 100000
+#define INDICATE_LEDS_MODE_CHANGE 0x0F // Indicator LEDs lit by a blink (bit mask)
+#define INDICATE_LEDS_POTI_MIN 0x03
+#define INDICATE_LEDS_POTI_CENTER 0x06
+#define INDICATE_LEDS_POTI_MAX 0x0C
+#define CONTROLLER_STATUS_BLINK_STEPS 10
+#define CONTROLLER_STATUS_BLINK_US 80000
+
 // External Message definitions
 #define MSG_CALIBRATION_MIN 0xE0
 #define MSG_CALIBRATION_CENTER 0xE1
@@ -57,7 +71,24 @@ typedef struct
 #define MSG_SET_BUTTON_VALUES 0xE5
 #define MSG_SET_BUTTON_VALUES_DATA_BYTE_COUNT 6
 #define MSG_SET_BUTTON_VALUE_UNCHANGED 0x0F
-#define MSG_DEFAULT_DATA_BYTE_COUNT 0
+#define MSG_METER 0xE6 // For the meter module on board index 0, consumed without action
+#define MSG_METER_DATA_BYTE_COUNT 2
+#define MSG_KNOB_FILTER 0xE7
+#define MSG_KNOB_FILTER_DATA_BYTE_COUNT 6
+#define MSG_KNOB_RESOLUTION 0xE8
+#define MSG_KNOB_RESOLUTION_DATA_BYTE_COUNT 2
+#define MSG_WIRE_FORMAT 0xE9
+#define MSG_WIRE_FORMAT_DATA_BYTE_COUNT 1
+#define MSG_UPSTREAM_WIRE_FORMAT_ACK 0x3F // Controller index of the upstream answer to MSG_WIRE_FORMAT
+#define MSG_LINK_BAUD 0xEA
+#define MSG_LINK_BAUD_DATA_BYTE_COUNT (2 + LINK_BAUD_PATTERN_LENGTH)
+#define MSG_CONFIG_DATA 0xEB
+#define MSG_CONFIG_DATA_DATA_BYTE_COUNT 20 // Block index, CONFIG_IMAGE_BLOCK_SIZE bytes packed to 7 bit (19 bytes)
+#define MSG_CONFIG_COMMIT 0xEC
+#define MSG_CONFIG_COMMIT_DATA_BYTE_COUNT 3 // CRC-16 of the image: bits 0 - 6, 7 - 13, 14 - 15
+#define MSG_UPSTREAM_CONFIG_COMMIT 0x39    // Answer to MSG_CONFIG_COMMIT
+#define CONFIG_COMMIT_OK_BIT 13            // Set: bits 0 - 12 commit time in ms. Clear: bits 0 - 12 CONFIG_IMAGE_* error
+#define CONFIG_COMMIT_BUSY 0x10            // Error: the job queue is full
 
 
 
@@ -75,7 +106,10 @@ protected:
     RpConfig *config;
     PotiCtl *poti_ctl_0;
     PotiCtl *poti_ctl_1;
+    LinkCtl *link_ctl = NULL;
+    JobScheduler job_scheduler; // Long running commands, one step per main loop pass
     uint8_t ui_mode = UI_MODE_PERFORM;
+    volatile uint8_t wire_format = 0; // Upstream wire format requested by the Pi, applied by core1
     uint32_t button_led_states = 0x00;
     uint8_t indicator_led_value = 0x00;
     uint8_t button_mode[6] = {CONTROLLER_MODE_TOGGLE, CONTROLLER_MODE_INCREMENT, CONTROLLER_MODE_TOGGLE, CONTROLLER_MODE_TOGGLE, CONTROLLER_MODE_TOGGLE, CONTROLLER_MODE_MOMENTARY};
@@ -103,10 +137,15 @@ protected:
     void updateIndicatorLeds();
     void setUiMode(uint8_t ui_mode);
     void setAllIndicatorLEDs(bool state);
-    void indicateModeChange();
-    void indicateSetPotiMin();
-    void indicateSetPotiMax();
-    void indicateSetPotiCenter();
+    uint32_t indicateStep(uint8_t led_mask, uint16_t step);
+    uint32_t stepModeChange(job_t *job);
+    uint32_t stepCalibrate(job_t *job);
+    uint32_t stepButtonConfig(job_t *job);
+    uint32_t stepControllerModes(job_t *job);
+    uint32_t stepControllerStatus(job_t *job);
+    uint32_t stepMulticastAck(job_t *job);
+    uint32_t stepConfigCommit(job_t *job);
+    void answerConfigCommit(uint16_t value);
     void pushBottonStateToQueue(uint8_t button_index);
     uint8_t getButtonIncrementMaxValue();
 
@@ -122,7 +161,25 @@ public:
     bool getControllerStatus(uint8_t ctl_index);
     void setControllerStatus(uint8_t ctl_index, bool active);
     void setAllControllerStatus(uint8_t *status_bytes);
-    void executeRemoteCommand(uint8_t *cmd_bytes);
+    void setControllerModes(uint8_t *mode_bytes);
+    void setButtonValues(uint8_t *value_bytes);
+    void setKnobFilter(uint8_t *filter_bytes);
+    void setKnobResolution(uint8_t *resolution_bytes);
+    void setWireFormat(uint8_t wire_format);
+    void setLinkCtl(LinkCtl *link_ctl);
+    void setLinkBaud(uint8_t *link_bytes);
+    void acknowledgeMulticast(uint16_t ack_value);
+    void loadConfigBlock(uint8_t *block_bytes);
+    void commitConfig(uint8_t *crc_bytes);
+    uint8_t getWireFormat();
+    void serviceJobs();
+    bool isBusy();
+    void storeRuntimeState();
+    JobScheduler *getJobScheduler();
+
+    // Remote commands from the Pi, context of the handlers is the InputCtl
+    static const remote_command_descriptor_t remote_commands[];
+    static const uint8_t remote_command_count;
 
     static int64_t callback_btn_0_long_press(alarm_id_t id, void *user_data)
     {
@@ -137,6 +194,46 @@ public:
         thisCtl->executeLongPress(1);
         return 0;
     }
+
+    static uint32_t job_mode_change(void *context, job_t *job)
+    {
+        return reinterpret_cast<InputCtl *>(context)->stepModeChange(job);
+    }
+
+    static uint32_t job_calibrate(void *context, job_t *job)
+    {
+        return reinterpret_cast<InputCtl *>(context)->stepCalibrate(job);
+    }
+
+    static uint32_t job_button_config(void *context, job_t *job)
+    {
+        return reinterpret_cast<InputCtl *>(context)->stepButtonConfig(job);
+    }
+
+    static uint32_t job_controller_modes(void *context, job_t *job)
+    {
+        return reinterpret_cast<InputCtl *>(context)->stepControllerModes(job);
+    }
+
+    static uint32_t job_controller_status(void *context, job_t *job)
+    {
+        return reinterpret_cast<InputCtl *>(context)->stepControllerStatus(job);
+    }
+
+    static uint32_t job_multicast_ack(void *context, job_t *job)
+    {
+        return reinterpret_cast<InputCtl *>(context)->stepMulticastAck(job);
+    }
+
+    static uint32_t job_config_commit(void *context, job_t *job)
+    {
+        return reinterpret_cast<InputCtl *>(context)->stepConfigCommit(job);
+    }
+
+    static void remote_multicast_ack(void *context, uint16_t ack_value)
+    {
+        reinterpret_cast<InputCtl *>(context)->acknowledgeMulticast(ack_value);
+    }
 };
 
 #endif
\ No newline at end of file
@@ -110,16 +110,14 @@ uint8_t InputCtl::getUiMode()
     return this->ui_mode;
 }
 
+/**
+ * @brief Blink the mode change and switch between UI_MODE_PERFORM and the target mode, as a job
+ *
+ * @param target_mode
+ */
 void InputCtl::toggleUiMode(uint8_t target_mode)
 {
-    if (this->ui_mode == UI_MODE_PERFORM)
-    {
-        this->setUiMode(target_mode);
-    }
-    else
-    {
-        this->setUiMode(UI_MODE_PERFORM);
-    }
+    this->job_scheduler.add(InputCtl::job_mode_change, this, &target_mode, 1);
 }
 
 void InputCtl::executeLongPress(uint8_t button_index)
@@ -138,110 +136,28 @@ void InputCtl::executeLongPress(uint8_t button_index)
     // }
 }
 
+/**
+ * @brief Store the current knob positions as min, center or max. Runs as jobs, the knobs are scanned meanwhile
+ *
+ * @param position MSG_CALIBRATION_MIN, MSG_CALIBRATION_CENTER or MSG_CALIBRATION_MAX
+ */
 void InputCtl::calibrate(uint8_t position)
 {
     this->toggleUiMode(UI_MODE_CALIBRATION);
-    busy_wait_ms(200);
-
-    if (position == MSG_CALIBRATION_MIN)
-    {
-        for (uint8_t i = 0; i < 4; i++)
-        {
-            uint8_t ctl_index_pot_0 = i + 6;
-            uint8_t ctl_index_pot_1 = i + 10;
-
-            this->poti_ctl_0->setMinFromRaw(i);
-            this->poti_ctl_1->setMinFromRaw(i);
-
-            this->config->writeControllerMin(ctl_index_pot_0, (uint32_t)poti_ctl_0->getMin(i));
-            this->config->writeControllerMin(ctl_index_pot_1, (uint32_t)poti_ctl_1->getMin(i));
-        }
-        this->indicateSetPotiMin();
-    }
-
-    if (position == MSG_CALIBRATION_CENTER)
-    {
-
-        for (uint8_t i = 0; i < 4; i++)
-        {
-            uint8_t ctl_index_pot_0 = i + 6;
-            uint8_t ctl_index_pot_1 = i + 10;
-
-            this->poti_ctl_0->setCenterFromOutValue(i);
-            this->poti_ctl_1->setCenterFromOutValue(i);
-
-            this->config->writeControllerCenter(ctl_index_pot_0, (uint32_t)poti_ctl_0->getCenter(i));
-            this->config->writeControllerCenter(ctl_index_pot_1, (uint32_t)poti_ctl_1->getCenter(i));
-        }
-        this->indicateSetPotiCenter();
-    }
-
-    if (position == MSG_CALIBRATION_MAX)
-    {
-        for (uint8_t i = 0; i < 4; i++)
-        {
-            uint8_t ctl_index_pot_0 = i + 6;
-            uint8_t ctl_index_pot_1 = i + 10;
-
-            this->poti_ctl_0->setMaxFromRaw(i);
-            this->poti_ctl_1->setMaxFromRaw(i);
-
-            this->config->writeControllerMax(ctl_index_pot_0, (uint32_t)poti_ctl_0->getMax(i));
-            this->config->writeControllerMax(ctl_index_pot_1, (uint32_t)poti_ctl_1->getMax(i));
-        }
-        this->indicateSetPotiMax();
-    }
+    this->job_scheduler.add(InputCtl::job_calibrate, this, &position, 1);
     this->toggleUiMode(UI_MODE_CALIBRATION);
 }
 
+/**
+ * @brief Set the button modes and the increment steps with LED feedback in UI_MODE_CONFIG. Runs as jobs
+ *
+ * @param button_config MSG_CONTROLLER_MODE_DATA_BYTE_COUNT - 2 bytes
+ */
 void InputCtl::setButtonConfig(uint8_t *button_config)
 {
     this->toggleUiMode(UI_MODE_CONFIG);
-    busy_wait_ms(200);
-    for (uint8_t i = 0; i < MSG_CONTROLLER_MODE_DATA_BYTE_COUNT - 2; i++)
-    {
-        this->button_value[i] = 0;
-        if (i == 1)
-        {
-            this->button_mode[i] = CONTROLLER_MODE_INCREMENT;
-            this->button_inc_steps = button_config[i];
-            this->config->writeIncSteps(this->button_inc_steps);
-            this->config->writeControllerMode(1, this->button_mode[1]);
-            this->setButtonLed(1, this->button_inc_steps > 1);
-            this->updateButtonLeds();
-            this->setIndicatorLEDsValue(this->button_inc_steps - 1);
-            this->updateIndicatorLeds();
-            busy_wait_ms(300);
-        }
-        else
-        {
-            uint8_t button_mode;
-            switch (button_config[i])
-            {
-            case 0x00:
-                button_mode = CONTROLLER_MODE_TOGGLE;
-                break;
-            case 0x01:
-                button_mode = CONTROLLER_MODE_MOMENTARY;
-                break;
-            case 0x04:
-                button_mode = CONTROLLER_MODE_RADIO_GROUP;
-                break;
-            default:
-                button_mode = CONTROLLER_MODE_TOGGLE;
-                break;
-            }
-            this->button_mode[i] = button_mode;
-            // TODO: FIND LED PATTERN TO display CONTROLLER_MODE_RADIO_GROUP
-            this->setButtonLed(i, !(bool)this->button_mode[i]);
-            this->updateButtonLeds();
-            this->config->writeControllerMode(i, this->button_mode[i]);
-        }
-        busy_wait_ms(30);
-    }
-    busy_wait_ms(100);
+    this->job_scheduler.add(InputCtl::job_button_config, this, button_config, MSG_CONTROLLER_MODE_DATA_BYTE_COUNT - 2);
     this->toggleUiMode(UI_MODE_CONFIG);
-    busy_wait_ms(200);
 }
 
 bool InputCtl::getControllerStatus(uint8_t ctl_index)
@@ -265,104 +181,311 @@ void InputCtl::setControllerStatus(uint8_t ctl_index, bool active)
     this->config->writeControllerStatus(this->controller_status);
 }
 
+/**
+ * @brief Enable or disable all controllers, with a blinking button LED as feedback. Runs as a job
+ *
+ * @param status_bytes MSG_CONTROLLER_STATUS_DATA_BYTE_COUNT bytes, 0x00: disabled
+ */
 void InputCtl::setAllControllerStatus(uint8_t *status_bytes)
 {
-    this->controller_status = 0x0000;
-    for (uint8_t i = 0; i < MSG_CONTROLLER_STATUS_DATA_BYTE_COUNT; i++)
+    this->job_scheduler.add(InputCtl::job_controller_status, this, status_bytes, MSG_CONTROLLER_STATUS_DATA_BYTE_COUNT);
+}
+
+/**
+ * @brief Set the filter of one knob and store it in the config
+ *
+ * @param filter_bytes knob index (0 - 7), filter mode, min cutoff in mHz (lsb7, msb7), beta (lsb7, msb7)
+ */
+void InputCtl::setKnobFilter(uint8_t *filter_bytes)
+{
+    uint8_t knob_index = filter_bytes[0];
+    if (knob_index > 7)
     {
-        bool status = (status_bytes[i] > 0x00);
-        this->setControllerStatus(i, status);
+        return;
     }
-    // Give some visual fedeback
-    bool inidator_led_status = true;
-     this->setButtonLed(0, inidator_led_status);
+    uint8_t mode = filter_bytes[1];
+    uint32_t min_cutoff = (uint32_t)(filter_bytes[2] & 0x7F) | ((uint32_t)(filter_bytes[3] & 0x7F) << 7);
+    uint32_t beta = (uint32_t)(filter_bytes[4] & 0x7F) | ((uint32_t)(filter_bytes[5] & 0x7F) << 7);
+
+    PotiCtl *poti_ctl = (knob_index < 4) ? this->poti_ctl_0 : this->poti_ctl_1;
+    uint8_t channel_index = knob_index % 4;
+    poti_ctl->setFilter(channel_index, mode, min_cutoff, beta);
+
+    uint8_t ctl_index = channel_index + poti_ctl->getChannelStartIndex();
+    this->config->writeControllerFilterMode(ctl_index, poti_ctl->getFilterMode(channel_index));
+    this->config->writeControllerFilterMinCutoff(ctl_index, min_cutoff);
+    this->config->writeControllerFilterBeta(ctl_index, beta);
+}
 
-    for (uint8_t i = 0; i < 10; i++)
+/**
+ * @brief Set the output resolution of one knob and store it in the config
+ *
+ * @param resolution_bytes knob index (0 - 7), resolution in bits (9 - 14)
+ */
+void InputCtl::setKnobResolution(uint8_t *resolution_bytes)
+{
+    uint8_t knob_index = resolution_bytes[0];
+    if (knob_index > 7)
     {
-        this->setButtonLed(0, inidator_led_status);
-        this->updateButtonLeds();
-        busy_wait_ms(80);
-        inidator_led_status = !inidator_led_status;
+        return;
     }
-    this->setButtonLEDsToButtonValue();
-    this->updateButtonLeds();
+    PotiCtl *poti_ctl = (knob_index < 4) ? this->poti_ctl_0 : this->poti_ctl_1;
+    uint8_t channel_index = knob_index % 4;
+    poti_ctl->setResolution(channel_index, resolution_bytes[1]);
+    this->config->writeControllerResolution(channel_index + poti_ctl->getChannelStartIndex(), poti_ctl->getResolution(channel_index));
+}
+
+/**
+ * @brief Switch the upstream wire format and answer with MSG_UPSTREAM_WIRE_FORMAT_ACK. The answer already
+ * uses the new format, the Pi reads both
+ *
+ * @param wire_format DATA_FORMATTER_WIRE_LEGACY, _COMPACT or _BATCH, anything else falls back to legacy
+ */
+void InputCtl::setWireFormat(uint8_t wire_format)
+{
+    this->wire_format = (wire_format <= DATA_FORMATTER_WIRE_BATCH) ? wire_format : DATA_FORMATTER_WIRE_LEGACY;
+    queue_entry_t q_entry;
+    q_entry.index = MSG_UPSTREAM_WIRE_FORMAT_ACK;
+    q_entry.value = this->wire_format;
+    queue_add_blocking(this->message_queue, &q_entry);
+}
+
+uint8_t InputCtl::getWireFormat()
+{
+    return this->wire_format;
+}
+
+void InputCtl::setLinkCtl(LinkCtl *link_ctl)
+{
+    this->link_ctl = link_ctl;
 }
 
-void InputCtl::executeRemoteCommand(uint8_t *cmd_bytes)
+void InputCtl::setLinkBaud(uint8_t *link_bytes)
 {
-    switch (cmd_bytes[0])
+    if (this->link_ctl != NULL)
     {
-    case MSG_CALIBRATION_MIN:
-        this->calibrate(MSG_CALIBRATION_MIN);
-        break;
-    case MSG_CALIBRATION_CENTER:
-        this->calibrate(MSG_CALIBRATION_CENTER);
-        break;
-    case MSG_CALIBRATION_MAX:
-        this->calibrate(MSG_CALIBRATION_MAX);
-        break;
-    case MSG_CONTROLLER_MODE:
-        uint8_t cmd_button_modes[MSG_CONTROLLER_MODE_DATA_BYTE_COUNT - 1];
-        for (uint8_t i = 0; i < MSG_CONTROLLER_MODE_DATA_BYTE_COUNT - 2; i++)
-        {
-            cmd_button_modes[i] = cmd_bytes[i + 1];
-        }
-        this->setButtonConfig(cmd_button_modes);
-        this->button_inc_display_zero = (bool)cmd_bytes[MSG_CONTROLLER_MODE_DATA_BYTE_COUNT - 1];
-        this->config->writeIncrementDisplayZero(this->button_inc_display_zero);
-        this->button_value[1] = 0;
+        this->link_ctl->command(link_bytes);
+    }
+}
 
-        this->button_radio_group_display_zero = (bool)cmd_bytes[MSG_CONTROLLER_MODE_DATA_BYTE_COUNT];
-        this->config->writeRadioGroupDisplayZero(this->button_radio_group_display_zero);
+/**
+ * @brief Acknowledge a multicast command once the jobs it started are done: the ack is queued as a job behind them
+ *
+ * @param ack_value REMOTE_CMD_ACK_VALUE, sent upstream as controller REMOTE_CMD_ACK_CONTROLLER
+ */
+void InputCtl::acknowledgeMulticast(uint16_t ack_value)
+{
+    uint8_t ack_bytes[2] = {(uint8_t)(ack_value & 0xFF), (uint8_t)(ack_value >> 8)};
+    this->job_scheduler.add(InputCtl::job_multicast_ack, this, ack_bytes, 2);
+}
 
-        this->setButtonLEDsToButtonValue();
-        this->setIndicatorLedsToButtonValue();
-        break;
-    case MSG_CONTROLLER_STATUS:
-        uint8_t cmd_ctl_states[MSG_CONTROLLER_STATUS_DATA_BYTE_COUNT];
-        for (uint8_t i = 0; i < MSG_CONTROLLER_STATUS_DATA_BYTE_COUNT; i++)
+/**
+ * @brief MSG_CONFIG_DATA: one block of a complete configuration image, see RpConfig::stageImageBlock()
+ *
+ * @param block_bytes block index, then the packed block
+ */
+void InputCtl::loadConfigBlock(uint8_t *block_bytes)
+{
+    uint8_t block[CONFIG_IMAGE_BLOCK_SIZE];
+    if (RemoteCmdEngine::unpack7Bit(&block_bytes[1], MSG_CONFIG_DATA_DATA_BYTE_COUNT - 1, block) != CONFIG_IMAGE_BLOCK_SIZE)
+    {
+        return;
+    }
+    this->config->stageImageBlock(block_bytes[0], block);
+}
+
+/**
+ * @brief MSG_CONFIG_COMMIT: check the staged image and write it to the EEPROM, page by page as a job. Then the
+ * controllers load it like at power up. Answers with MSG_UPSTREAM_CONFIG_COMMIT
+ *
+ * @param crc_bytes
+ */
+void InputCtl::commitConfig(uint8_t *crc_bytes)
+{
+    uint16_t crc = crc_bytes[0] | (crc_bytes[1] << 7) | (crc_bytes[2] << 14);
+    uint8_t result = this->config->checkStagedImage(crc);
+    if (result != CONFIG_IMAGE_OK)
+    {
+        this->config->discardStagedImage();
+        this->answerConfigCommit(result);
+        return;
+    }
+    if (!this->job_scheduler.add(InputCtl::job_config_commit, this, NULL, 0))
+    {
+        this->config->discardStagedImage();
+        this->answerConfigCommit(CONFIG_COMMIT_BUSY);
+    }
+}
+
+/**
+ * @brief MSG_CONTROLLER_MODE: button modes, increment and radio group display zero. Runs as jobs
+ *
+ * @param mode_bytes MSG_CONTROLLER_MODE_DATA_BYTE_COUNT bytes
+ */
+void InputCtl::setControllerModes(uint8_t *mode_bytes)
+{
+    this->setButtonConfig(mode_bytes);
+    this->job_scheduler.add(InputCtl::job_controller_modes, this, mode_bytes, MSG_CONTROLLER_MODE_DATA_BYTE_COUNT);
+}
+
+/**
+ * @brief Run the next step of the current job. Call it from the main loop
+ *
+ */
+void InputCtl::serviceJobs()
+{
+    this->job_scheduler.service();
+}
+
+/**
+ * @brief A long running command is not finished yet. Remote commands wait meanwhile to keep their order
+ *
+ * @return true
+ * @return false
+ */
+bool InputCtl::isBusy()
+{
+    return this->job_scheduler.isBusy();
+}
+
+JobScheduler *InputCtl::getJobScheduler()
+{
+    return &this->job_scheduler;
+}
+
+/**
+ * @brief Hand the button values and the controller status to the config journal. Call it from the main loop, the
+ * button interrupt only changes the values. Unchanged values cost nothing
+ *
+ */
+void InputCtl::storeRuntimeState()
+{
+    for (uint8_t i = 0; i < 6; i++)
+    {
+        this->config->writeControllerValue(i, this->button_value[i]);
+    }
+    this->config->writeControllerStatus(this->controller_status);
+}
+
+/**
+ * @brief MSG_SET_BUTTON_VALUES
+ *
+ * @param value_bytes MSG_SET_BUTTON_VALUES_DATA_BYTE_COUNT bytes, MSG_SET_BUTTON_VALUE_UNCHANGED keeps a value
+ */
+void InputCtl::setButtonValues(uint8_t *value_bytes)
+{
+    for (uint8_t i = 0; i < MSG_SET_BUTTON_VALUES_DATA_BYTE_COUNT; i++)
+    {
+        uint8_t button_value = value_bytes[i];
+        if (!this->getControllerStatus(i) || button_value == MSG_SET_BUTTON_VALUE_UNCHANGED || this->button_mode[i] == CONTROLLER_MODE_MOMENTARY)
         {
-            cmd_ctl_states[i] = cmd_bytes[i + 1];
+            continue;
         }
-        this->setAllControllerStatus(cmd_ctl_states);
-        break;
-    case MSG_SET_BUTTON_VALUES:
-        for (uint8_t i = 0; i < MSG_SET_BUTTON_VALUES_DATA_BYTE_COUNT; i++)
+        if (this->button_mode[i] == CONTROLLER_MODE_INCREMENT)
         {
-            uint8_t button_value = cmd_bytes[i + 1];
-            if (!this->getControllerStatus(i) || button_value == MSG_SET_BUTTON_VALUE_UNCHANGED || this->button_mode[i] == CONTROLLER_MODE_MOMENTARY)
-            {
-                continue;
-            }
-            if (this->button_mode[i] == CONTROLLER_MODE_INCREMENT)
+            button_value = (button_value > this->getButtonIncrementMaxValue()) ? this->getButtonIncrementMaxValue() : button_value;
+        }
+        if (this->button_mode[i] == CONTROLLER_MODE_RADIO_GROUP)
+        {
+            if (i == 2)
             {
-                button_value = (button_value > this->getButtonIncrementMaxValue()) ? this->getButtonIncrementMaxValue() : button_value;
+                uint8_t max_radio_val = (this->button_radio_group_display_zero) ? 4 : 3;
+                button_value = (button_value > max_radio_val) ? max_radio_val : button_value;
             }
-            if (this->button_mode[i] == CONTROLLER_MODE_RADIO_GROUP)
+            else
             {
-                if (i == 2)
-                {
-                    uint8_t max_radio_val = (this->button_radio_group_display_zero) ? 4 : 3;
-                    button_value = (button_value > max_radio_val) ? max_radio_val : button_value;
-                }
-                else
-                {
-                    button_value = 0;
-                }
+                button_value = 0;
             }
-            this->button_value[i] = button_value;
         }
-        this->setButtonLEDsToButtonValue();
-        this->setIndicatorLedsToButtonValue();
-        this->updateIndicatorLeds();
-        this->updateButtonLeds();
-        break;
-    default:
-        // DO NOTHING
-        break;
+        this->button_value[i] = button_value;
     }
+    this->setButtonLEDsToButtonValue();
+    this->setIndicatorLedsToButtonValue();
+    this->updateIndicatorLeds();
+    this->updateButtonLeds();
+}
+
+// Remote command handlers
+
+static void remote_calibration_min(void *context, uint8_t *)
+{
+    reinterpret_cast<InputCtl *>(context)->calibrate(MSG_CALIBRATION_MIN);
+}
+
+static void remote_calibration_center(void *context, uint8_t *)
+{
+    reinterpret_cast<InputCtl *>(context)->calibrate(MSG_CALIBRATION_CENTER);
 }
 
+static void remote_calibration_max(void *context, uint8_t *)
+{
+    reinterpret_cast<InputCtl *>(context)->calibrate(MSG_CALIBRATION_MAX);
+}
+
+static void remote_controller_mode(void *context, uint8_t *data_bytes)
+{
+    reinterpret_cast<InputCtl *>(context)->setControllerModes(data_bytes);
+}
+
+static void remote_controller_status(void *context, uint8_t *data_bytes)
+{
+    reinterpret_cast<InputCtl *>(context)->setAllControllerStatus(data_bytes);
+}
+
+static void remote_set_button_values(void *context, uint8_t *data_bytes)
+{
+    reinterpret_cast<InputCtl *>(context)->setButtonValues(data_bytes);
+}
+
+static void remote_knob_filter(void *context, uint8_t *data_bytes)
+{
+    reinterpret_cast<InputCtl *>(context)->setKnobFilter(data_bytes);
+}
+
+static void remote_knob_resolution(void *context, uint8_t *data_bytes)
+{
+    reinterpret_cast<InputCtl *>(context)->setKnobResolution(data_bytes);
+}
+
+static void remote_wire_format(void *context, uint8_t *data_bytes)
+{
+    reinterpret_cast<InputCtl *>(context)->setWireFormat(data_bytes[0]);
+}
+
+static void remote_link_baud(void *context, uint8_t *data_bytes)
+{
+    reinterpret_cast<InputCtl *>(context)->setLinkBaud(data_bytes);
+}
+
+static void remote_config_data(void *context, uint8_t *data_bytes)
+{
+    reinterpret_cast<InputCtl *>(context)->loadConfigBlock(data_bytes);
+}
+
+static void remote_config_commit(void *context, uint8_t *data_bytes)
+{
+    reinterpret_cast<InputCtl *>(context)->commitConfig(data_bytes);
+}
+
+// One entry per message type. The wire format and the link rate only concern the chain towards the Pi
+const remote_command_descriptor_t InputCtl::remote_commands[] = {
+    {MSG_CALIBRATION_MIN, 0, REMOTE_CMD_TRANSPORT_ALL, remote_calibration_min},
+    {MSG_CALIBRATION_CENTER, 0, REMOTE_CMD_TRANSPORT_ALL, remote_calibration_center},
+    {MSG_CALIBRATION_MAX, 0, REMOTE_CMD_TRANSPORT_ALL, remote_calibration_max},
+    {MSG_CONTROLLER_MODE, MSG_CONTROLLER_MODE_DATA_BYTE_COUNT, REMOTE_CMD_TRANSPORT_ALL, remote_controller_mode},
+    {MSG_CONTROLLER_STATUS, MSG_CONTROLLER_STATUS_DATA_BYTE_COUNT, REMOTE_CMD_TRANSPORT_ALL, remote_controller_status},
+    {MSG_SET_BUTTON_VALUES, MSG_SET_BUTTON_VALUES_DATA_BYTE_COUNT, REMOTE_CMD_TRANSPORT_ALL, remote_set_button_values},
+    {MSG_METER, MSG_METER_DATA_BYTE_COUNT, REMOTE_CMD_TRANSPORT_UART, NULL},
+    {MSG_KNOB_FILTER, MSG_KNOB_FILTER_DATA_BYTE_COUNT, REMOTE_CMD_TRANSPORT_ALL, remote_knob_filter},
+    {MSG_KNOB_RESOLUTION, MSG_KNOB_RESOLUTION_DATA_BYTE_COUNT, REMOTE_CMD_TRANSPORT_ALL, remote_knob_resolution},
+    {MSG_WIRE_FORMAT, MSG_WIRE_FORMAT_DATA_BYTE_COUNT, REMOTE_CMD_TRANSPORT_UART, remote_wire_format},
+    {MSG_LINK_BAUD, MSG_LINK_BAUD_DATA_BYTE_COUNT, REMOTE_CMD_TRANSPORT_UART, remote_link_baud},
+    {MSG_CONFIG_DATA, MSG_CONFIG_DATA_DATA_BYTE_COUNT, REMOTE_CMD_TRANSPORT_ALL, remote_config_data},
+    {MSG_CONFIG_COMMIT, MSG_CONFIG_COMMIT_DATA_BYTE_COUNT, REMOTE_CMD_TRANSPORT_ALL, remote_config_commit},
+};
+
+const uint8_t InputCtl::remote_command_count = sizeof(InputCtl::remote_commands) / sizeof(InputCtl::remote_commands[0]);
+
 /*
  * Protected methods
  */
@@ -537,7 +660,6 @@ void InputCtl::updateIndicatorLeds()
 
 void InputCtl::setUiMode(uint8_t ui_mode)
 {
-    this->indicateModeChange();
     this->ui_mode = ui_mode;
     switch (this->ui_mode)
     {
@@ -588,49 +710,296 @@ void InputCtl::setAllIndicatorLEDs(bool state)
     }
 }
 
-void InputCtl::indicateModeChange()
+/**
+ * @brief One half period of a blink: the LEDs of the mask on at even steps, all off at odd steps
+ *
+ * @param led_mask indicator LEDs (bit mask)
+ * @param step
+ * @return uint32_t time until the next step
+ */
+uint32_t InputCtl::indicateStep(uint8_t led_mask, uint16_t step)
 {
-    for (uint8_t i = 0; i < 6; i++)
+    for (uint8_t j = 0; j < 4; j++)
     {
-        this->setAllIndicatorLEDs(true);
-        busy_wait_ms(100);
-        this->setAllIndicatorLEDs(false);
-        busy_wait_ms(100);
+        gpio_put(this->led_pins[j], (step % 2 == 0) && BIT_ISSET(led_mask, j));
     }
+    return INDICATE_BLINK_US;
 }
 
-void InputCtl::indicateSetPotiMin()
+/**
+ * @brief Job: blink, then toggle the ui mode (data byte 0: target mode)
+ *
+ * @param job
+ * @return uint32_t
+ */
+uint32_t InputCtl::stepModeChange(job_t *job)
 {
-    for (uint8_t i = 0; i < 6; i++)
+    if (job->step < INDICATE_BLINK_STEPS)
     {
-        gpio_put(this->led_pins[0], 1);
-        gpio_put(this->led_pins[1], 1);
-        busy_wait_ms(100);
-        this->setAllIndicatorLEDs(false);
-        busy_wait_ms(100);
+        return this->indicateStep(INDICATE_LEDS_MODE_CHANGE, job->step);
     }
+    uint8_t target_mode = job->data[0];
+    this->setUiMode((this->ui_mode == UI_MODE_PERFORM) ? target_mode : UI_MODE_PERFORM);
+    return JOB_DONE;
 }
 
-void InputCtl::indicateSetPotiMax()
+/**
+ * @brief Job: wait for the knobs to settle, store one knob per step (data byte 0: position), flush the config, blink
+ *
+ * @param job
+ * @return uint32_t
+ */
+uint32_t InputCtl::stepCalibrate(job_t *job)
 {
-    for (uint8_t i = 0; i < 6; i++)
+    uint8_t position = job->data[0];
+    if (job->step == 0)
+    {
+        return 200000;
+    }
+    if (job->step <= 8)
+    {
+        // Steps 1 - 8: knob i of poti_ctl_0 (controller index i + 6), then of poti_ctl_1 (i + 10)
+        uint8_t i = (job->step - 1) / 2;
+        bool first = ((job->step - 1) % 2) == 0;
+        PotiCtl *poti_ctl = first ? this->poti_ctl_0 : this->poti_ctl_1;
+        uint8_t ctl_index = first ? i + 6 : i + 10;
+        switch (position)
+        {
+        case MSG_CALIBRATION_MIN:
+            poti_ctl->setMinFromRaw(i);
+            this->config->writeControllerMin(ctl_index, (uint32_t)poti_ctl->getMin(i));
+            break;
+        case MSG_CALIBRATION_CENTER:
+            poti_ctl->setCenterFromOutValue(i);
+            this->config->writeControllerCenter(ctl_index, (uint32_t)poti_ctl->getCenter(i));
+            break;
+        case MSG_CALIBRATION_MAX:
+            poti_ctl->setMaxFromRaw(i);
+            this->config->writeControllerMax(ctl_index, (uint32_t)poti_ctl->getMax(i));
+            break;
+        }
+        return 0;
+    }
+    uint16_t blink_step = job->step - 9;
+    if (blink_step == 0)
+    {
+        // The calibration is not finished before it is in the EEPROM, do not wait for an idle main loop
+        this->config->flush();
+    }
+    if (blink_step < INDICATE_BLINK_STEPS)
+    {
+        uint8_t led_mask = INDICATE_LEDS_POTI_CENTER;
+        if (position == MSG_CALIBRATION_MIN)
+        {
+            led_mask = INDICATE_LEDS_POTI_MIN;
+        }
+        else if (position == MSG_CALIBRATION_MAX)
+        {
+            led_mask = INDICATE_LEDS_POTI_MAX;
+        }
+        return this->indicateStep(led_mask, blink_step);
+    }
+    return JOB_DONE;
+}
+
+/**
+ * @brief Job: one button per step (data bytes: button modes, byte 1: increment steps)
+ *
+ * @param job
+ * @return uint32_t
+ */
+uint32_t InputCtl::stepButtonConfig(job_t *job)
+{
+    const uint8_t button_count = MSG_CONTROLLER_MODE_DATA_BYTE_COUNT - 2;
+    if (job->step == 0)
+    {
+        return 200000;
+    }
+    if (job->step > button_count)
+    {
+        return JOB_DONE;
+    }
+    uint8_t i = job->step - 1;
+    uint32_t delay_us = 30000;
+    this->button_value[i] = 0;
+    if (i == 1)
+    {
+        this->button_mode[i] = CONTROLLER_MODE_INCREMENT;
+        this->button_inc_steps = job->data[i];
+        this->config->writeIncSteps(this->button_inc_steps);
+        this->config->writeControllerMode(1, this->button_mode[1]);
+        this->setButtonLed(1, this->button_inc_steps > 1);
+        this->updateButtonLeds();
+        this->setIndicatorLEDsValue(this->button_inc_steps - 1);
+        this->updateIndicatorLeds();
+        // Show the increment steps a little longer
+        delay_us += 300000;
+    }
+    else
+    {
+        uint8_t button_mode;
+        switch (job->data[i])
+        {
+        case 0x00:
+            button_mode = CONTROLLER_MODE_TOGGLE;
+            break;
+        case 0x01:
+            button_mode = CONTROLLER_MODE_MOMENTARY;
+            break;
+        case 0x04:
+            button_mode = CONTROLLER_MODE_RADIO_GROUP;
+            break;
+        default:
+            button_mode = CONTROLLER_MODE_TOGGLE;
+            break;
+        }
+        this->button_mode[i] = button_mode;
+        // TODO: FIND LED PATTERN TO display CONTROLLER_MODE_RADIO_GROUP
+        this->setButtonLed(i, !(bool)this->button_mode[i]);
+        this->updateButtonLeds();
+        this->config->writeControllerMode(i, this->button_mode[i]);
+    }
+    if (i == button_count - 1)
     {
-        gpio_put(this->led_pins[2], 1);
-        gpio_put(this->led_pins[3], 1);
-        busy_wait_ms(100);
-        this->setAllIndicatorLEDs(false);
-        busy_wait_ms(100);
+        delay_us += 100000;
     }
+    return delay_us;
 }
 
-void InputCtl::indicateSetPotiCenter()
+/**
+ * @brief Job: display zero settings after the button config (data bytes: MSG_CONTROLLER_MODE data bytes)
+ *
+ * @param job
+ * @return uint32_t
+ */
+uint32_t InputCtl::stepControllerModes(job_t *job)
 {
-    for (uint8_t i = 0; i < 6; i++)
+    if (job->step == 0)
     {
-        gpio_put(this->led_pins[1], 1);
-        gpio_put(this->led_pins[2], 1);
-        busy_wait_ms(100);
-        this->setAllIndicatorLEDs(false);
-        busy_wait_ms(100);
+        return 200000;
     }
+    this->button_inc_display_zero = (bool)job->data[MSG_CONTROLLER_MODE_DATA_BYTE_COUNT - 2];
+    this->config->writeIncrementDisplayZero(this->button_inc_display_zero);
+    this->button_value[1] = 0;
+
+    this->button_radio_group_display_zero = (bool)job->data[MSG_CONTROLLER_MODE_DATA_BYTE_COUNT - 1];
+    this->config->writeRadioGroupDisplayZero(this->button_radio_group_display_zero);
+
+    this->setButtonLEDsToButtonValue();
+    this->setIndicatorLedsToButtonValue();
+    return JOB_DONE;
+}
+
+/**
+ * @brief Job: apply and store the controller status (data bytes: one per controller), blink button LED 0
+ *
+ * @param job
+ * @return uint32_t
+ */
+uint32_t InputCtl::stepControllerStatus(job_t *job)
+{
+    if (job->step == 0)
+    {
+        this->controller_status = 0x0000;
+        for (uint8_t i = 0; i < MSG_CONTROLLER_STATUS_DATA_BYTE_COUNT; i++)
+        {
+            if (job->data[i] > 0x00)
+            {
+                BIT_SET(this->controller_status, i);
+            }
+        }
+        // One write for all controllers
+        this->config->writeControllerStatus(this->controller_status);
+    }
+    if (job->step < CONTROLLER_STATUS_BLINK_STEPS)
+    {
+        // Give some visual fedeback
+        this->setButtonLed(0, (job->step % 2) == 0);
+        this->updateButtonLeds();
+        return CONTROLLER_STATUS_BLINK_US;
+    }
+    this->setButtonLEDsToButtonValue();
+    this->updateButtonLeds();
+    return JOB_DONE;
+}
+
+/**
+ * @brief Job: send the multicast ack (data bytes: value lsb, msb). Core1 merges the acks of the chain
+ *
+ * @param job
+ * @return uint32_t
+ */
+uint32_t InputCtl::stepMulticastAck(job_t *job)
+{
+    queue_entry_t q_entry;
+    q_entry.index = REMOTE_CMD_ACK_CONTROLLER;
+    q_entry.value = job->data[0] | (job->data[1] << 8);
+    if (!queue_try_add(this->message_queue, &q_entry))
+    {
+        // Queue full, try again with the next step
+        return 1000;
+    }
+    return JOB_DONE;
+}
+
+/**
+ * @brief Job: one page of the staged configuration image per step, then reload the controllers and answer with
+ * the time the pages took (data bytes 0 - 3: start time, after the last page the commit time). The stored
+ * configuration is invalid until page 0 with the init token is written as the last page
+ *
+ * @param job
+ * @return uint32_t
+ */
+uint32_t InputCtl::stepConfigCommit(job_t *job)
+{
+    uint32_t now_us = time_us_32();
+    if (job->step == 0)
+    {
+        memcpy(job->data, &now_us, sizeof(now_us));
+        this->config->beginImageCommit();
+    }
+    if (job->step < CONFIG_IMAGE_PAGE_COUNT)
+    {
+        // Pages 1 - CONFIG_IMAGE_PAGE_COUNT - 1, then page 0
+        this->config->commitImagePage((job->step + 1) % CONFIG_IMAGE_PAGE_COUNT);
+        if (job->step == CONFIG_IMAGE_PAGE_COUNT - 1)
+        {
+            uint32_t start_us;
+            memcpy(&start_us, job->data, sizeof(start_us));
+            uint32_t commit_us = time_us_32() - start_us;
+            memcpy(job->data, &commit_us, sizeof(commit_us));
+        }
+        return 0;
+    }
+    switch (job->step - CONFIG_IMAGE_PAGE_COUNT)
+    {
+    case 0:
+        // Button values and controller status of the image replace the journaled ones
+        this->config->resetRuntimeState();
+        this->init();
+        return 0;
+    case 1:
+        this->poti_ctl_0->init();
+        return 0;
+    case 2:
+        this->poti_ctl_1->init();
+        return 0;
+    }
+    uint32_t commit_us;
+    memcpy(&commit_us, job->data, sizeof(commit_us));
+    uint32_t commit_ms = (commit_us + 999) / 1000;
+#ifdef DEBUG
+    printf("Config commit: %lu us\n", (unsigned long)commit_us);
+#endif
+    this->config->discardStagedImage();
+    this->answerConfigCommit((1 << CONFIG_COMMIT_OK_BIT) | ((commit_ms < 0x1FFF) ? commit_ms : 0x1FFF));
+    return JOB_DONE;
+}
+
+void InputCtl::answerConfigCommit(uint16_t value)
+{
+    queue_entry_t q_entry;
+    q_entry.index = MSG_UPSTREAM_CONFIG_COMMIT;
+    q_entry.value = value;
+    queue_add_blocking(this->message_queue, &q_entry);
 }
@@ -0,0 +1,58 @@
+#ifndef __JOB_SCHEDULER_H__
+#define __JOB_SCHEDULER_H__
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "pico/stdlib.h"
+
+#define JOB_SCHEDULER_QUEUE_LENGTH 8
+#define JOB_DATA_BYTES 24
+#define JOB_DONE 0xFFFFFFFF // Return value of a step function: the job is finished
+
+typedef struct job job_t;
+
+// One step of a job. Returns the time in us until the next step or JOB_DONE
+typedef uint32_t (*job_step_t)(void *context, job_t *job);
+
+struct job
+{
+    job_step_t step_function;
+    void *context;
+    uint16_t step; // Counts the calls of the step function, starting at 0
+    uint8_t data[JOB_DATA_BYTES];
+};
+
+/**
+ * @brief Runs long operations (LED animations, configuration writes) as a sequence of short steps from the main
+ * loop, so knob scanning goes on in between. Jobs run one after the other in the order they were added, a job
+ * is a step function that is called with an increasing step counter until it returns JOB_DONE.
+ *
+ * Only for the main loop of one core.
+ *
+ */
+class JobScheduler
+{
+protected:
+    job_t jobs[JOB_SCHEDULER_QUEUE_LENGTH];
+    uint8_t head = 0;
+    uint8_t tail = 0;
+    uint32_t wake_us = 0;
+
+    // Statistics
+    uint32_t job_count = 0;
+    uint32_t drop_count = 0;
+    uint32_t step_max_us = 0;
+
+public:
+    JobScheduler();
+    bool add(job_step_t step_function, void *context, const uint8_t *data, uint8_t data_length);
+    void service();
+    bool isBusy();
+    uint32_t getJobCount();
+    uint32_t getDropCount();
+    uint32_t getStepMaxUs();
+    void resetStepMax();
+};
+
+#endif
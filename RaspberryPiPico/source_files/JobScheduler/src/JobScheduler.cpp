@@ -0,0 +1,109 @@
+#include "JobScheduler.h"
+
+JobScheduler::JobScheduler()
+{
+}
+
+/**
+ * @brief Queue a job, its first step runs with the next service()
+ *
+ * @param step_function
+ * @param context first argument of the step function
+ * @param data copied into the job, may be NULL
+ * @param data_length up to JOB_DATA_BYTES
+ * @return true
+ * @return false queue full, the job is dropped
+ */
+bool JobScheduler::add(job_step_t step_function, void *context, const uint8_t *data, uint8_t data_length)
+{
+    uint8_t next_head = (this->head + 1) % JOB_SCHEDULER_QUEUE_LENGTH;
+    if (next_head == this->tail)
+    {
+        this->drop_count++;
+        return false;
+    }
+    job_t *job = &this->jobs[this->head];
+    job->step_function = step_function;
+    job->context = context;
+    job->step = 0;
+    for (uint8_t i = 0; i < JOB_DATA_BYTES; i++)
+    {
+        job->data[i] = (data != NULL && i < data_length) ? data[i] : 0;
+    }
+    if (this->tail == this->head)
+    {
+        this->wake_us = time_us_32();
+    }
+    this->head = next_head;
+    return true;
+}
+
+/**
+ * @brief Run the next step of the oldest job when it is due. Call it from the main loop
+ *
+ */
+void JobScheduler::service()
+{
+    if (this->tail == this->head)
+    {
+        return;
+    }
+    uint32_t now_us = time_us_32();
+    if ((int32_t)(now_us - this->wake_us) < 0)
+    {
+        return;
+    }
+    job_t *job = &this->jobs[this->tail];
+    uint32_t delay_us = job->step_function(job->context, job);
+    uint32_t done_us = time_us_32();
+    if (done_us - now_us > this->step_max_us)
+    {
+        this->step_max_us = done_us - now_us;
+    }
+    job->step++;
+    if (delay_us == JOB_DONE)
+    {
+        this->tail = (this->tail + 1) % JOB_SCHEDULER_QUEUE_LENGTH;
+        this->job_count++;
+        // The next job starts right away
+        this->wake_us = done_us;
+        return;
+    }
+    this->wake_us = now_us + delay_us;
+}
+
+/**
+ * @brief A job is queued or running
+ *
+ * @return true
+ * @return false
+ */
+bool JobScheduler::isBusy()
+{
+    return this->tail != this->head;
+}
+
+uint32_t JobScheduler::getJobCount()
+{
+    return this->job_count;
+}
+
+uint32_t JobScheduler::getDropCount()
+{
+    return this->drop_count;
+}
+
+/**
+ * @brief Longest single step since the last reset, the time the main loop was held up
+ *
+ * @return uint32_t
+ */
+uint32_t JobScheduler::getStepMaxUs()
+{
+    return this->step_max_us;
+}
+
+void JobScheduler::resetStepMax()
+{
+    this->step_max_us = 0;
+}
@@ -0,0 +1,95 @@
+#ifndef __LINK_CTL_H__
+#define __LINK_CTL_H__
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "pico/stdlib.h"
+#include "pico/util/queue.h"
+#include "hardware/uart.h"
+
+#ifndef __QUEUE_ENTRY_T__
+#define __QUEUE_ENTRY_T__
+typedef struct
+{
+    uint8_t index;
+    uint16_t value;
+} queue_entry_t;
+#endif
+
+// Candidate rates of the board to board links, index 0 is the power up rate. The Pi uses the same table
+#define LINK_BAUD_RATES {380400, 460800, 921600, 1000000, 1500000, 2000000}
+#define LINK_BAUD_RATE_COUNT 6
+#define LINK_BAUD_SWITCH_DELAY_US 50000     // Time for the TRY command to reach every board before the links switch
+#define LINK_BAUD_CONFIRM_TIMEOUT_US 1000000 // Without CONFIRM a board goes back to the last confirmed rate
+#define LINK_BAUD_PATTERN_LENGTH 6
+#define LINK_BAUD_PATTERN {0x55, 0x2A, 0x7F, 0x00, 0x33, 0x4C}      // Alternating bits and both extremes
+#define LINK_BAUD_UPSTREAM_PATTERN {0x2AAA, 0x1555, 0x3FFF, 0x0000} // 14 bit values of the answer messages
+#define LINK_BAUD_UPSTREAM_PATTERN_LENGTH 4
+
+// Actions of MSG_LINK_BAUD (first data byte)
+#define LINK_BAUD_ACTION_TRY 0     // Switch to the rate index (second data byte) after LINK_BAUD_SWITCH_DELAY_US
+#define LINK_BAUD_ACTION_VERIFY 1  // Check the test pattern (data bytes 3 - 8) and answer
+#define LINK_BAUD_ACTION_CONFIRM 2 // Keep the current rate
+#define LINK_BAUD_ACTION_REPORT 3  // Answer with the error counters of both links
+
+// Controller indices of the upstream answers
+#define LINK_UPSTREAM_ERRORS_UART0 0x3B  // Receive errors on the link towards the Pi
+#define LINK_UPSTREAM_ERRORS_UART1 0x3C  // Receive errors on the link to the previous board
+#define LINK_UPSTREAM_PATTERN 0x3D       // Upstream test pattern, LINK_BAUD_UPSTREAM_PATTERN_LENGTH messages
+#define LINK_UPSTREAM_STATUS 0x3E        // Bit 13: pattern ok, bit 12: rate confirmed, bits 4 - 7: rate count, bits 0 - 3: active rate index
+#define LINK_UPSTREAM_STATUS_OK_BIT 13
+#define LINK_UPSTREAM_STATUS_CONFIRMED_BIT 12
+
+typedef struct
+{
+    uint32_t framing;
+    uint32_t parity;
+    uint32_t break_condition;
+    uint32_t overrun;
+} link_error_count_t;
+
+/**
+ * @brief Baud rate of the two chain links (uart0 towards the Pi, uart1 to the previous board) and their receive
+ * error counters. The Pi drives the negotiation with MSG_LINK_BAUD, a two phase commit per candidate rate:
+ * TRY switches every board at about the same time, VERIFY checks the links in both directions with test patterns,
+ * CONFIRM makes the rate stick. A board that does not get the CONFIRM returns to the last confirmed rate on its
+ * own, so a rate that does not work never locks the chain out. Index 0 (the power up rate) needs no CONFIRM.
+ *
+ * Runs on core0: the commands arrive there and service() has to be called from its main loop.
+ *
+ */
+class LinkCtl
+{
+protected:
+    uart_inst_t *uarts[2];
+    queue_t *message_queue;
+    uint8_t active_index = 0;
+    uint8_t confirmed_index = 0;
+    bool switch_pending = false;
+    uint8_t pending_index = 0;
+    uint32_t switch_at_us = 0;
+    bool confirm_pending = false;
+    uint32_t confirm_deadline_us = 0;
+
+    // Statistics
+    link_error_count_t errors[2];
+    uint32_t revert_count = 0;
+
+    void applyRate(uint8_t rate_index);
+    void pollErrors(uint8_t link_index);
+    void answer(uint8_t controller_index, uint16_t value);
+    uint16_t saturate(uint32_t count);
+
+public:
+    LinkCtl(uart_inst_t *uart_up, uart_inst_t *uart_down, queue_t *message_queue);
+    void service();
+    void command(uint8_t *data_bytes);
+    uint32_t getBaudRate();
+    uint8_t getRateIndex();
+    link_error_count_t *getErrors(uint8_t link_index);
+    uint32_t getErrorTotal(uint8_t link_index);
+    uint32_t getRevertCount();
+};
+
+#endif
@@ -0,0 +1,198 @@
+#include "LinkCtl.h"
+
+static const uint32_t link_baud_rates[LINK_BAUD_RATE_COUNT] = LINK_BAUD_RATES;
+static const uint8_t link_baud_pattern[LINK_BAUD_PATTERN_LENGTH] = LINK_BAUD_PATTERN;
+static const uint16_t link_baud_upstream_pattern[LINK_BAUD_UPSTREAM_PATTERN_LENGTH] = LINK_BAUD_UPSTREAM_PATTERN;
+
+/**
+ * @brief
+ *
+ * @param uart_up link towards the Pi
+ * @param uart_down link to the previous board
+ * @param message_queue upstream answers
+ */
+LinkCtl::LinkCtl(uart_inst_t *uart_up, uart_inst_t *uart_down, queue_t *message_queue)
+{
+    this->uarts[0] = uart_up;
+    this->uarts[1] = uart_down;
+    this->message_queue = message_queue;
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        this->errors[i] = {0, 0, 0, 0};
+    }
+}
+
+/**
+ * @brief Timed rate switches and error counting. Call it from the main loop of core0
+ *
+ */
+void LinkCtl::service()
+{
+    uint32_t now_us = time_us_32();
+    if (this->switch_pending && (int32_t)(now_us - this->switch_at_us) >= 0)
+    {
+        this->switch_pending = false;
+        this->applyRate(this->pending_index);
+        if (this->pending_index == 0)
+        {
+            // The power up rate always works
+            this->confirmed_index = 0;
+        }
+        else
+        {
+            this->confirm_pending = true;
+            this->confirm_deadline_us = now_us + LINK_BAUD_CONFIRM_TIMEOUT_US;
+        }
+    }
+    if (this->confirm_pending && (int32_t)(now_us - this->confirm_deadline_us) >= 0)
+    {
+        // The Pi did not confirm the rate: go back to the last one that worked
+        this->confirm_pending = false;
+        this->applyRate(this->confirmed_index);
+        this->revert_count++;
+    }
+    this->pollErrors(0);
+    this->pollErrors(1);
+}
+
+/**
+ * @brief Execute MSG_LINK_BAUD
+ *
+ * @param data_bytes action, rate index, LINK_BAUD_PATTERN_LENGTH pattern bytes
+ */
+void LinkCtl::command(uint8_t *data_bytes)
+{
+    switch (data_bytes[0])
+    {
+    case LINK_BAUD_ACTION_TRY:
+        if (data_bytes[1] >= LINK_BAUD_RATE_COUNT)
+        {
+            // Not supported by this board: the VERIFY answer tells the Pi
+            break;
+        }
+        this->pending_index = data_bytes[1];
+        this->switch_at_us = time_us_32() + LINK_BAUD_SWITCH_DELAY_US;
+        this->switch_pending = true;
+        break;
+    case LINK_BAUD_ACTION_VERIFY:
+    {
+        bool pattern_ok = (data_bytes[1] == this->active_index);
+        for (uint8_t i = 0; i < LINK_BAUD_PATTERN_LENGTH; i++)
+        {
+            pattern_ok = pattern_ok && (data_bytes[i + 2] == link_baud_pattern[i]);
+        }
+        for (uint8_t i = 0; i < LINK_BAUD_UPSTREAM_PATTERN_LENGTH; i++)
+        {
+            this->answer(LINK_UPSTREAM_PATTERN, link_baud_upstream_pattern[i]);
+        }
+        uint16_t status = (LINK_BAUD_RATE_COUNT << 4) | this->active_index;
+        if (pattern_ok)
+        {
+            status |= (1 << LINK_UPSTREAM_STATUS_OK_BIT);
+        }
+        if (!this->confirm_pending)
+        {
+            status |= (1 << LINK_UPSTREAM_STATUS_CONFIRMED_BIT);
+        }
+        this->answer(LINK_UPSTREAM_STATUS, status);
+        break;
+    }
+    case LINK_BAUD_ACTION_CONFIRM:
+        if (this->confirm_pending)
+        {
+            this->confirm_pending = false;
+            this->confirmed_index = this->active_index;
+        }
+        break;
+    case LINK_BAUD_ACTION_REPORT:
+        this->answer(LINK_UPSTREAM_ERRORS_UART0, this->saturate(this->getErrorTotal(0)));
+        this->answer(LINK_UPSTREAM_ERRORS_UART1, this->saturate(this->getErrorTotal(1)));
+        break;
+    default:
+        break;
+    }
+}
+
+uint32_t LinkCtl::getBaudRate()
+{
+    return link_baud_rates[this->active_index];
+}
+
+uint8_t LinkCtl::getRateIndex()
+{
+    return this->active_index;
+}
+
+/**
+ * @brief Receive errors of a link since power up
+ *
+ * @param link_index 0: uart0 (towards the Pi), 1: uart1 (previous board)
+ * @return link_error_count_t*
+ */
+link_error_count_t *LinkCtl::getErrors(uint8_t link_index)
+{
+    return &this->errors[link_index];
+}
+
+uint32_t LinkCtl::getErrorTotal(uint8_t link_index)
+{
+    link_error_count_t *e = &this->errors[link_index];
+    return e->framing + e->parity + e->break_condition + e->overrun;
+}
+
+/**
+ * @brief Rate switches the Pi did not confirm
+ *
+ * @return uint32_t
+ */
+uint32_t LinkCtl::getRevertCount()
+{
+    return this->revert_count;
+}
+
+// Protected Methods
+
+void LinkCtl::applyRate(uint8_t rate_index)
+{
+    this->active_index = rate_index;
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        uart_set_baudrate(this->uarts[i], link_baud_rates[rate_index]);
+    }
+}
+
+/**
+ * @brief Count the receive errors of a link from the raw interrupt status. An error is counted once per poll,
+ * the DMA reads the data register with 8 bit transfers and drops the error flags of the single characters
+ *
+ * @param link_index
+ */
+void LinkCtl::pollErrors(uint8_t link_index)
+{
+    uart_hw_t *hw = uart_get_hw(this->uarts[link_index]);
+    uint32_t status = hw->ris;
+    uint32_t mask = UART_UARTRIS_FERIS_BITS | UART_UARTRIS_PERIS_BITS | UART_UARTRIS_BERIS_BITS | UART_UARTRIS_OERIS_BITS;
+    if ((status & mask) == 0)
+    {
+        return;
+    }
+    link_error_count_t *e = &this->errors[link_index];
+    e->framing += (status & UART_UARTRIS_FERIS_BITS) ? 1 : 0;
+    e->parity += (status & UART_UARTRIS_PERIS_BITS) ? 1 : 0;
+    e->break_condition += (status & UART_UARTRIS_BERIS_BITS) ? 1 : 0;
+    e->overrun += (status & UART_UARTRIS_OERIS_BITS) ? 1 : 0;
+    hw->icr = UART_UARTICR_FEIC_BITS | UART_UARTICR_PEIC_BITS | UART_UARTICR_BEIC_BITS | UART_UARTICR_OEIC_BITS;
+}
+
+void LinkCtl::answer(uint8_t controller_index, uint16_t value)
+{
+    queue_entry_t q_entry;
+    q_entry.index = controller_index;
+    q_entry.value = value;
+    queue_add_blocking(this->message_queue, &q_entry);
+}
+
+uint16_t LinkCtl::saturate(uint32_t count)
+{
+    return (count > 0x3FFF) ? 0x3FFF : (uint16_t)count;
+}
@@ -8,6 +8,7 @@
 #include <time.h>
 #include <math.h>
 #include "ADS1X15.h"
+#include "KnobSampler.h"
 #include "RpConfig.h"
 
 #define ADC_CHANNEL_COUNT 4
@@ -16,16 +17,55 @@
 #define ADC_OUT_MAX_STEP 10
 #define CENTER_LOCK_MARGIN 10
 
+// The RP2040 has no FPU: run the filter chain in fixed point instead of soft-float double math.
+// Set to false to use the original double precision chain
+#define POTI_CTL_FIXED_POINT true
+#define POTI_Q_BITS 24 // Q8.24: 1.0 = 2^24 leaves enough headroom for 64 bit products
+#define POTI_Q_ONE ((int32_t)1 << POTI_Q_BITS)
+#define POTI_Q_HALF ((int32_t)1 << (POTI_Q_BITS - 1))
+#define POTI_Q_NORMALIZE_511 2101256 // round(2^30 / 511): (mapped * POTI_Q_NORMALIZE_511) >> 6 = mapped / 511 in Q24
+// Lookup tables (built once in init(), center tables again when the center changes)
+// Memory budget: linearization 513 x uint16_t = 1026 Bytes shared by all instances,
+// center remap 4 x 512 x uint16_t = 4096 Bytes per instance (8 KB for both ADCs)
+#define POTI_LINEARIZE_TABLE_BITS 9 // 512 segments over 0.0 - 1.0, linear interpolation between the entries
+#define POTI_LINEARIZE_TABLE_SIZE ((1 << POTI_LINEARIZE_TABLE_BITS) + 1)
+#define POTI_LINEARIZE_FRACTION_BITS (POTI_Q_BITS - POTI_LINEARIZE_TABLE_BITS)
+#define POTI_LINEARIZE_VALUE_BITS 7 // Table entries are the output value 0 - 511 with 7 fractional bits
+#define POTI_OUT_RANGE 512
+// Output resolution per knob. 9 bit (0 - 511) runs the original chain, wider outputs map the raw value
+// without the 9 bit quantization and scale thresholds and the center dead zone to the output range
+#define POTI_RESOLUTION_BITS_MIN 9
+#define POTI_RESOLUTION_BITS_MAX 14 // Limited by the 14 bit value of the upstream packets
+// Exponential average smoothing coefficients (1 - smooth) in Q24
+#define POTI_Q_SMOOTH_0 ((int32_t)((1. - 0.93) * POTI_Q_ONE + 0.5))
+#define POTI_Q_SMOOTH_1 ((int32_t)((1. - 0.9) * POTI_Q_ONE + 0.5))
+#define POTI_Q_SMOOTH_2 ((int32_t)((1. - 0.88) * POTI_Q_ONE + 0.5))
+// One-Euro filter (FILTER_MODE_ONE_EURO): the cutoff follows the estimated knob velocity.
+// Slow moves get heavy smoothing, fast sweeps almost none. Always runs in fixed point
+#define POTI_ONE_EURO_TAU_SCALE 159154943       // 10^9 / (2 * pi): tau in us = POTI_ONE_EURO_TAU_SCALE / cutoff in mHz
+#define POTI_ONE_EURO_DERIVATE_CUTOFF_MHZ 1000  // Cutoff for the velocity estimate
+#define POTI_ONE_EURO_MAX_CUTOFF_MHZ 1000000    // Upper limit for the adaptive cutoff
+#define POTI_ONE_EURO_MAX_DT_US 100000          // Limit the time step after a pause in the sampling
+#define POTI_ONE_EURO_MAX_VELOCITY (1 << 30)    // Velocity limit (Q24 full scale per second) to keep the math in 32 bit
+
 class PotiCtl
 {
 private:
     ADS1X15 *adc;
+    KnobSampler *sampler = NULL;
     RpConfig *config;
     uint8_t controller_start_index = 6;
 
     long _clip(double x, double min, double max);
     long _map(double x, double in_min, double in_max, double out_min, double out_max);
     double _smooth(double new_val, double old_val, double smooth);
+    long _mapInt(long x, long in_min, long in_max, long out_min, long out_max);
+    int32_t _smoothFixed(int32_t new_val, int32_t old_val, int32_t coefficient);
+    int32_t _oneEuroAlpha(uint32_t cutoff_mhz, uint32_t dt_us);
+
+    static uint16_t linearize_table[POTI_LINEARIZE_TABLE_SIZE];
+    static bool linearize_table_ready;
+    static void buildLinearizeTable();
 
 protected:
     double min[4] = {2., 1., 1., 1.};
@@ -34,20 +74,46 @@ protected:
     double old_0[4] = {0., 0., 0., 0.};
     double old_1[4] = {0., 0., 0., 0.};
     double old_2[4] = {0., 0., 0., 0.};
+    int32_t min_int[4] = {2, 1, 1, 1};
+    int32_t max_int[4] = {990, 985, 975, 977};
+    int32_t old_q_0[4] = {0, 0, 0, 0};
+    int32_t old_q_1[4] = {0, 0, 0, 0};
+    int32_t old_q_2[4] = {0, 0, 0, 0};
+    uint8_t filter_mode[4] = {FILTER_MODE_CASCADE, FILTER_MODE_CASCADE, FILTER_MODE_CASCADE, FILTER_MODE_CASCADE};
+    uint32_t euro_min_cutoff[4] = {FILTER_DEFAULT_MIN_CUTOFF_MHZ, FILTER_DEFAULT_MIN_CUTOFF_MHZ, FILTER_DEFAULT_MIN_CUTOFF_MHZ, FILTER_DEFAULT_MIN_CUTOFF_MHZ};
+    uint32_t euro_beta[4] = {FILTER_DEFAULT_BETA, FILTER_DEFAULT_BETA, FILTER_DEFAULT_BETA, FILTER_DEFAULT_BETA};
+    int32_t euro_x[4] = {0, 0, 0, 0};
+    int32_t euro_dx[4] = {0, 0, 0, 0};
+    uint32_t euro_last_us[4] = {0, 0, 0, 0};
+    uint8_t resolution[4] = {POTI_RESOLUTION_BITS_MIN, POTI_RESOLUTION_BITS_MIN, POTI_RESOLUTION_BITS_MIN, POTI_RESOLUTION_BITS_MIN};
+    uint8_t sample_bits = 0; // Fractional bits of the samples delivered by the sampler (oversampling)
 
     double raw_val[4] = {0, 0, 0, 0};
     int out_val[4] = {0, 0, 0, 0};
     uint16_t out_val_centered[4] = {0, 0, 0, 0};
+    uint16_t center_table[4][POTI_OUT_RANGE];
     bool locked[4] = {false, false, false, false};
     uint8_t adc_same_val_count[4] = {0, 0, 0, 0};
     uint16_t centerValue(uint8_t controller_channel);
+    uint16_t centerValueCalculated(uint8_t controller_channel, uint16_t out_val);
+    void buildCenterTable(uint8_t controller_channel);
+    int filterDouble(uint8_t channel_index, uint16_t result);
+    int filterFixed(uint8_t channel_index, uint16_t result);
+    int filterOneEuro(uint8_t channel_index, uint16_t result, uint32_t sample_us);
+    int linearizeFixed(int32_t value, int out_max);
+    uint8_t resolutionShift(uint8_t channel_index);
+    int outMax(uint8_t channel_index);
+    int32_t normalizeFixed(uint8_t channel_index, uint16_t result);
 
 public:
     PotiCtl(ADS1X15 *adc, RpConfig *config, uint8_t controller_start_index);
     void init();
+    void setSampler(KnobSampler *sampler);
     bool uppdate(uint8_t channel_index);
+    bool uppdateFromSample(uint8_t channel_index, uint16_t result, uint32_t sample_us);
     bool uppdate2(uint8_t channel_index);
     uint16_t getValue(uint8_t channel_index);
+    bool isLocked(uint8_t channel_index);
     double getRawValue(uint8_t channel_index);
     void setMinFromRaw(uint8_t controller_index, double margin = 3);
     void setCenterFromRaw(uint8_t controller_index);
@@ -56,6 +122,10 @@ public:
     double getMin(uint8_t controller_index);
     double getCenter(uint8_t controller_index);
     double getMax(uint8_t controller_index);
+    void setFilter(uint8_t controller_index, uint8_t mode, uint32_t min_cutoff, uint32_t beta);
+    uint8_t getFilterMode(uint8_t controller_index);
+    void setResolution(uint8_t controller_index, uint8_t bits);
+    uint8_t getResolution(uint8_t controller_index);
     uint8_t getChannelStartIndex();
 };
 
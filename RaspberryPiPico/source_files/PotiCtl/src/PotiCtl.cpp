@@ -1,11 +1,19 @@
 #include "PotiCtl.h"
 // #define DEBUG
 
+uint16_t PotiCtl::linearize_table[POTI_LINEARIZE_TABLE_SIZE];
+bool PotiCtl::linearize_table_ready = false;
+
 PotiCtl::PotiCtl(ADS1X15 *adc, RpConfig *config, uint8_t controller_start_index)
 {
     this->adc = adc;
     this->config = config;
     this->controller_start_index = controller_start_index;
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        this->buildCenterTable(i);
+    }
+    PotiCtl::buildLinearizeTable();
 }
 
 void PotiCtl::init()
@@ -15,9 +23,29 @@ void PotiCtl::init()
         this->min[i] = (double)this->config->readControllerMin(i + this->controller_start_index);
         this->max[i] = (double)this->config->readControllerMax(i + this->controller_start_index);
         this->center[i] = (int)this->config->readControllerCenter(i + this->controller_start_index);
+        this->min_int[i] = (int32_t)this->min[i];
+        this->max_int[i] = (int32_t)this->max[i];
+        this->buildCenterTable(i);
+        this->setFilter(
+            i,
+            this->config->readControllerFilterMode(i + this->controller_start_index),
+            this->config->readControllerFilterMinCutoff(i + this->controller_start_index),
+            this->config->readControllerFilterBeta(i + this->controller_start_index));
+        this->setResolution(i, this->config->readControllerResolution(i + this->controller_start_index));
     }
 }
 
+/**
+ * @brief Take the samples from an acquisition backend instead of reading the ADC in uppdate()
+ *
+ * @param sampler
+ */
+void PotiCtl::setSampler(KnobSampler *sampler)
+{
+    this->sampler = sampler;
+    this->sample_bits = sampler->getOversampleBits();
+}
+
 bool PotiCtl::uppdate2(uint8_t channel_index)
 {
     bool changed = false;
@@ -78,45 +106,65 @@ bool PotiCtl::uppdate2(uint8_t channel_index)
 }
 
 bool PotiCtl::uppdate(uint8_t channel_index)
+{
+    uint16_t result;
+    if (this->sampler != NULL)
+    {
+        // Only consume finished samples, nothing to do until the next conversion is in
+        if (!this->sampler->hasNewSample(channel_index))
+        {
+            return false;
+        }
+        result = this->sampler->takeSample(channel_index);
+    }
+    else
+    {
+        result = this->adc->readSingleEnded(channel_index);
+    }
+    return this->uppdateFromSample(channel_index, result, time_us_32());
+}
+
+/**
+ * @brief Run the filter chain on a sample taken elsewhere (e.g. by the AdcSampleClock)
+ *
+ * @param channel_index
+ * @param result raw ADC value
+ * @param sample_us time the sample was taken
+ * @return true if the output value changed
+ */
+bool PotiCtl::uppdateFromSample(uint8_t channel_index, uint16_t result, uint32_t sample_us)
 {
     bool changed = false;
     uint16_t old_centered_val = this->out_val_centered[channel_index];
-    uint16_t result = this->adc->readSingleEnded(channel_index);
-    this->raw_val[channel_index] = (double)result;
-    double min = this->min[channel_index];
-    double max = this->max[channel_index];
+    // Calibration works in ADC counts, drop the fractional bits of oversampled values
+    this->raw_val[channel_index] = (double)result / (double)(1 << this->sample_bits);
 
-    // Map raw value to output nrange (0 - 511) taking the calibration limites into account
-    long mapped = this->_map((double)result, min, max, 0, 511);
-    // mapped = this->_clip(mapped, 0, 511);
-    //  Normalize value for smoothing
-    double normalized = (double)mapped / 511.;
-    // Exponential average smoothing. We smooth two time with a lower smooting value instead of one time with a high smoothing value
-    // This way we achieve a similar smoothing efferct, but much lower latenency
-    double smoothed = this->_smooth(normalized, this->old_0[channel_index], 0.93);
-    this->old_0[channel_index] = smoothed;
-    double smoothed_1 = this->_smooth(smoothed, this->old_1[channel_index], 0.9);
-    this->old_1[channel_index] = smoothed_1;
-    double smoothed_2 = this->_smooth(smoothed_1, this->old_2[channel_index], 0.88);
-    this->old_2[channel_index] = smoothed_2;
-
-    // Re-linearize value: This is to compensate for the effebct of the hardware smoothing on the board
-    // and the exponential  avareage smoothing from above. The value is obtained by trial an error
-    double linearized = pow(smoothed_1, 9);
+    // Thresholds are defined for the 9 bit output, scale them to the output resolution
+    uint8_t shift = this->resolutionShift(channel_index);
+    int max_step = ADC_OUT_MAX_STEP << shift;
+    int unlock_thresh = ADC_UNLOCK_THRESH << shift;
 
-    // Map back to integer output range 0 - 511
-    int out_val = (int)round(linearized * 511);
+    int out_val;
+    if (this->filter_mode[channel_index] == FILTER_MODE_ONE_EURO)
+    {
+        out_val = this->filterOneEuro(channel_index, result, sample_us);
+    }
+    else
+    {
+        // The double chain is kept as 9 bit reference
+        out_val = POTI_CTL_FIXED_POINT ? this->filterFixed(channel_index, result) : this->filterDouble(channel_index, result) << shift;
+    }
 
     // Here we filter out big jumps and linit the to a maximum step size. The max step size has to be highter than the ADC_UNLOCK_THRESH
-    out_val = (out_val > this->out_val[channel_index] + ADC_OUT_MAX_STEP) ? this->out_val[channel_index] + ADC_OUT_MAX_STEP : out_val;
-    out_val = (out_val < this->out_val[channel_index] - ADC_OUT_MAX_STEP) ? this->out_val[channel_index] - ADC_OUT_MAX_STEP : out_val;
+    out_val = (out_val > this->out_val[channel_index] + max_step) ? this->out_val[channel_index] + max_step : out_val;
+    out_val = (out_val < this->out_val[channel_index] - max_step) ? this->out_val[channel_index] - max_step : out_val;
 
     // Last step in optaining a clean outpout value:
     // Here we filter out the small value changes that can occur even if the poti is not touched.
     // After reading x amount of times the same value we 'lock' the output, meaning all value changes smaller than defined in ADC_UNLOCK_THRESH
     // will be ignored. The trade of is that when passing from 'not turning potentiometer' to 'turning potentiomer' we lose a bit of resolution
     // for the first new value. But we consider stable values when not turning the potentiomer as more important
-    if (out_val == this->out_val[channel_index] && !this->locked[channel_index])
+    if (abs(out_val - this->out_val[channel_index]) < (1 << shift) && !this->locked[channel_index])
     {
         this->adc_same_val_count[channel_index] = this->adc_same_val_count[channel_index] + 1;
         if (this->adc_same_val_count[channel_index] >= ADC_LOCK_THRESH)
@@ -126,7 +174,7 @@ bool PotiCtl::uppdate(uint8_t channel_index)
     }
     if (this->locked[channel_index])
     {
-        if (abs(out_val - this->out_val[channel_index]) > ADC_UNLOCK_THRESH)
+        if (abs(out_val - this->out_val[channel_index]) > unlock_thresh)
         {
             this->out_val[channel_index] = out_val;
             this->locked[channel_index] = false;
@@ -144,29 +192,218 @@ bool PotiCtl::uppdate(uint8_t channel_index)
     // return changed && (this->out_val_centered[channel_index] != (uint16_t)this->out_val[channel_index]);
 }
 
+/**
+ * @brief Original filter chain in double precision: map, exponential average smoothing and re-linearization
+ *
+ * @param channel_index
+ * @param result raw ADC value
+ * @return int output value 0 - 511
+ */
+int PotiCtl::filterDouble(uint8_t channel_index, uint16_t result)
+{
+    double min = this->min[channel_index];
+    double max = this->max[channel_index];
+
+    // Map raw value to output nrange (0 - 511) taking the calibration limites into account
+    long mapped = this->_map((double)result / (double)(1 << this->sample_bits), min, max, 0, 511);
+    // mapped = this->_clip(mapped, 0, 511);
+    //  Normalize value for smoothing
+    double normalized = (double)mapped / 511.;
+    // Exponential average smoothing. We smooth two time with a lower smooting value instead of one time with a high smoothing value
+    // This way we achieve a similar smoothing efferct, but much lower latenency
+    double smoothed = this->_smooth(normalized, this->old_0[channel_index], 0.93);
+    this->old_0[channel_index] = smoothed;
+    double smoothed_1 = this->_smooth(smoothed, this->old_1[channel_index], 0.9);
+    this->old_1[channel_index] = smoothed_1;
+    double smoothed_2 = this->_smooth(smoothed_1, this->old_2[channel_index], 0.88);
+    this->old_2[channel_index] = smoothed_2;
+
+    // Re-linearize value: This is to compensate for the effebct of the hardware smoothing on the board
+    // and the exponential  avareage smoothing from above. The value is obtained by trial an error
+    double linearized = pow(smoothed_1, 9);
+
+    // Map back to integer output range 0 - 511
+    return (int)round(linearized * 511);
+}
+
+/**
+ * @brief Same filter chain as filterDouble() in Q24 fixed point. Matches the double chain within 1 LSB
+ *
+ * @param channel_index
+ * @param result raw ADC value
+ * @return int output value in the output resolution
+ */
+int PotiCtl::filterFixed(uint8_t channel_index, uint16_t result)
+{
+    int32_t normalized = this->normalizeFixed(channel_index, result);
+
+    int32_t smoothed = this->_smoothFixed(normalized, this->old_q_0[channel_index], POTI_Q_SMOOTH_0);
+    this->old_q_0[channel_index] = smoothed;
+    int32_t smoothed_1 = this->_smoothFixed(smoothed, this->old_q_1[channel_index], POTI_Q_SMOOTH_1);
+    this->old_q_1[channel_index] = smoothed_1;
+    int32_t smoothed_2 = this->_smoothFixed(smoothed_1, this->old_q_2[channel_index], POTI_Q_SMOOTH_2);
+    this->old_q_2[channel_index] = smoothed_2;
+
+    return this->linearizeFixed(smoothed_1, this->outMax(channel_index));
+}
+
+/**
+ * @brief One-Euro filter: exponential average smoothing with a cutoff that rises with the knob velocity
+ *
+ * @param channel_index
+ * @param result raw ADC value
+ * @param sample_us time the sample was taken
+ * @return int output value in the output resolution
+ */
+int PotiCtl::filterOneEuro(uint8_t channel_index, uint16_t result, uint32_t sample_us)
+{
+    int32_t normalized = this->normalizeFixed(channel_index, result);
+
+    uint32_t dt_us = sample_us - this->euro_last_us[channel_index];
+    this->euro_last_us[channel_index] = sample_us;
+    dt_us = (dt_us < 1) ? 1 : dt_us;
+    dt_us = (dt_us > POTI_ONE_EURO_MAX_DT_US) ? POTI_ONE_EURO_MAX_DT_US : dt_us;
+
+    // Velocity in full scale per second (Q24), smoothed with a fixed cutoff
+    int64_t velocity = (int64_t)(normalized - this->euro_x[channel_index]) * 1000000 / dt_us;
+    velocity = (velocity > POTI_ONE_EURO_MAX_VELOCITY) ? POTI_ONE_EURO_MAX_VELOCITY : velocity;
+    velocity = (velocity < -POTI_ONE_EURO_MAX_VELOCITY) ? -POTI_ONE_EURO_MAX_VELOCITY : velocity;
+    int32_t alpha_dx = this->_oneEuroAlpha(POTI_ONE_EURO_DERIVATE_CUTOFF_MHZ, dt_us);
+    this->euro_dx[channel_index] = this->_smoothFixed((int32_t)velocity, this->euro_dx[channel_index], alpha_dx);
+
+    // Adapt the cutoff to the velocity: cutoff = min_cutoff + beta * |velocity|
+    uint64_t speed = (uint64_t)abs(this->euro_dx[channel_index]);
+    uint64_t cutoff = this->euro_min_cutoff[channel_index] + ((speed * this->euro_beta[channel_index]) >> POTI_Q_BITS);
+    cutoff = (cutoff > POTI_ONE_EURO_MAX_CUTOFF_MHZ) ? POTI_ONE_EURO_MAX_CUTOFF_MHZ : cutoff;
+    int32_t alpha = this->_oneEuroAlpha((uint32_t)cutoff, dt_us);
+    this->euro_x[channel_index] = this->_smoothFixed(normalized, this->euro_x[channel_index], alpha);
+
+    return this->linearizeFixed(this->euro_x[channel_index], this->outMax(channel_index));
+}
+
+/**
+ * @brief Map the raw value to the output range taking the calibration limits into account, normalized to Q24
+ *
+ * @param channel_index
+ * @param result raw ADC value
+ * @return int32_t 0.0 - 1.0 in Q24
+ */
+int32_t PotiCtl::normalizeFixed(uint8_t channel_index, uint16_t result)
+{
+    int32_t in_min = this->min_int[channel_index] << this->sample_bits;
+    int32_t in_max = this->max_int[channel_index] << this->sample_bits;
+    if (this->resolution[channel_index] > POTI_RESOLUTION_BITS_MIN)
+    {
+        // Full precision for wider outputs: no quantization to 0 - 511 before smoothing
+        int32_t span = in_max - in_min;
+        int32_t offset = (int32_t)result - in_min;
+        offset = (offset < 0) ? 0 : offset;
+        offset = (offset > span) ? span : offset;
+        return (span > 0) ? (int32_t)(((int64_t)offset << POTI_Q_BITS) / span) : 0;
+    }
+    // Map raw value to output nrange (0 - 511) taking the calibration limites into account
+    long mapped = this->_mapInt(result, in_min, in_max, 0, 511);
+    //  Normalize value for smoothing
+    return (int32_t)((mapped * POTI_Q_NORMALIZE_511 + 32) >> 6);
+}
+
+/**
+ * @brief Re-linearize value: value^9 from the lookup table, interpolated between the two closest entries
+ *
+ * @param value 0.0 - 1.0 in Q24
+ * @param out_max largest output value (511 for 9 bit)
+ * @return int output value 0 - out_max
+ */
+int PotiCtl::linearizeFixed(int32_t value, int out_max)
+{
+    uint32_t table_index = (uint32_t)value >> POTI_LINEARIZE_FRACTION_BITS;
+    if (table_index >= POTI_LINEARIZE_TABLE_SIZE - 1)
+    {
+        return out_max;
+    }
+    uint32_t fraction = (uint32_t)value & ((1 << POTI_LINEARIZE_FRACTION_BITS) - 1);
+    uint32_t linearized = ((uint32_t)linearize_table[table_index] * ((1 << POTI_LINEARIZE_FRACTION_BITS) - fraction) +
+                           (uint32_t)linearize_table[table_index + 1] * fraction) >>
+                          POTI_LINEARIZE_FRACTION_BITS;
+
+    // Scale the table value (0 - 511 with fractional bits) to the output range, rounding. For out_max 511 this
+    // is the same as dropping the fractional bits
+    uint32_t table_max = 511 << POTI_LINEARIZE_VALUE_BITS;
+    return (int)(((uint64_t)linearized * out_max + table_max / 2) / table_max);
+}
+
 uint16_t PotiCtl::centerValue(uint8_t channel_index)
 {
-    uint16_t out_val = (uint16_t)this->out_val[channel_index];
-    uint16_t center_val = (uint16_t)this->center[channel_index];
+    int out_max = this->outMax(channel_index);
+    int out_val = this->out_val[channel_index];
+    out_val = (out_val < 0) ? 0 : out_val;
+    out_val = (out_val > out_max) ? out_max : out_val;
+    if (this->resolutionShift(channel_index) > 0)
+    {
+        // A table for the wider outputs would not fit into RAM
+        return this->centerValueCalculated(channel_index, out_val);
+    }
+    return this->center_table[channel_index][out_val];
+}
+
+uint16_t PotiCtl::centerValueCalculated(uint8_t channel_index, uint16_t out_val)
+{
+    // The center is stored in 9 bit, scale it and the dead zone to the output resolution
+    uint8_t shift = this->resolutionShift(channel_index);
+    long out_max = this->outMax(channel_index);
+    long out_mid = out_max >> 1;
+    long center_val = (long)this->center[channel_index] << shift;
+    long margin = (long)CENTER_LOCK_MARGIN << shift;
     // We have a center value set. Let's remap around a dead zone;
     if (this->center[channel_index] > 0)
     {
-        if (out_val > center_val + CENTER_LOCK_MARGIN)
+        if (out_val > center_val + margin)
         {
-            out_val = (uint16_t)this->_map(out_val, center_val + CENTER_LOCK_MARGIN, 511, 255, 511);
+            out_val = (uint16_t)this->_mapInt(out_val, center_val + margin, out_max, out_mid, out_max);
         }
-        else if (out_val < center_val - CENTER_LOCK_MARGIN)
+        else if (out_val < center_val - margin)
         {
-            out_val = (uint16_t)this->_map(out_val, 0, center_val - CENTER_LOCK_MARGIN, 0, 255);
+            out_val = (uint16_t)this->_mapInt(out_val, 0, center_val - margin, 0, out_mid);
         }
         else
         {
-            out_val = 255;
+            out_val = out_mid;
         }
     }
     return out_val;
 }
 
+/**
+ * @brief Pre-calculate the center dead zone remap for all output values of one channel
+ *
+ * @param channel_index
+ */
+void PotiCtl::buildCenterTable(uint8_t channel_index)
+{
+    for (uint16_t out_val = 0; out_val < POTI_OUT_RANGE; out_val++)
+    {
+        this->center_table[channel_index][out_val] = this->centerValueCalculated(channel_index, out_val);
+    }
+}
+
+/**
+ * @brief Pre-calculate x^9 for the re-linearization in filterFixed()
+ *
+ */
+void PotiCtl::buildLinearizeTable()
+{
+    if (PotiCtl::linearize_table_ready)
+    {
+        return;
+    }
+    for (uint16_t i = 0; i < POTI_LINEARIZE_TABLE_SIZE; i++)
+    {
+        double x = (double)i / (double)(POTI_LINEARIZE_TABLE_SIZE - 1);
+        PotiCtl::linearize_table[i] = (uint16_t)round(pow(x, 9) * 511 * (1 << POTI_LINEARIZE_VALUE_BITS));
+    }
+    PotiCtl::linearize_table_ready = true;
+}
+
 uint16_t PotiCtl::getValue(uint8_t channel_index)
 {
     return this->out_val_centered[channel_index];
@@ -192,6 +429,11 @@ uint16_t PotiCtl::getValue(uint8_t channel_index)
     // return out_val;
 }
 
+bool PotiCtl::isLocked(uint8_t channel_index)
+{
+    return this->locked[channel_index];
+}
+
 double PotiCtl::getRawValue(uint8_t channel_index)
 {
     return this->raw_val[channel_index];
@@ -209,11 +451,13 @@ void PotiCtl::setMinFromRaw(uint8_t controller_index, double margin)
         with_marging);
 #endif
     this->min[controller_index] = with_marging;
+    this->min_int[controller_index] = (int32_t)with_marging;
 }
 
 void PotiCtl::setCenterFromRaw(uint8_t controller_index)
 {
     this->center[controller_index] = this->getRawValue(controller_index);
+    this->buildCenterTable(controller_index);
 }
 
 void PotiCtl::setMaxFromRaw(uint8_t controller_index, double margin)
@@ -228,13 +472,15 @@ void PotiCtl::setMaxFromRaw(uint8_t controller_index, double margin)
         with_marging);
 #endif
     this->max[controller_index] = with_marging;
+    this->max_int[controller_index] = (int32_t)with_marging;
 }
 
 void PotiCtl::setCenterFromOutValue(uint8_t controller_index)
 {
-    int center_val = this->out_val[controller_index];
+    int center_val = this->out_val[controller_index] >> this->resolutionShift(controller_index);
     center_val = (center_val > 150) ? center_val : 0; // When outval < 150 we do not set a center value
     this->center[controller_index] = center_val;
+    this->buildCenterTable(controller_index);
 #ifdef DEBUG
     printf(
         "setCenterFromOutValue: INDEX: %d (%d)\n value: %df\n",
@@ -260,11 +506,91 @@ double PotiCtl::getMax(uint8_t controller_index)
 }
 
 
+/**
+ * @brief Select the filter of a knob. Unknown modes fall back to FILTER_MODE_CASCADE
+ *
+ * @param controller_index
+ * @param mode FILTER_MODE_CASCADE or FILTER_MODE_ONE_EURO
+ * @param min_cutoff One-Euro cutoff in mHz when the knob is not moving
+ * @param beta One-Euro cutoff increase in mHz per full scale per second
+ */
+void PotiCtl::setFilter(uint8_t controller_index, uint8_t mode, uint32_t min_cutoff, uint32_t beta)
+{
+    mode = (mode == FILTER_MODE_ONE_EURO) ? FILTER_MODE_ONE_EURO : FILTER_MODE_CASCADE;
+    // Continue from the current filter state so switching modes does not make the output jump
+    if (mode == FILTER_MODE_ONE_EURO && this->filter_mode[controller_index] != FILTER_MODE_ONE_EURO)
+    {
+        this->euro_x[controller_index] = this->old_q_1[controller_index];
+        this->euro_dx[controller_index] = 0;
+        this->euro_last_us[controller_index] = time_us_32();
+    }
+    if (mode == FILTER_MODE_CASCADE && this->filter_mode[controller_index] != FILTER_MODE_CASCADE)
+    {
+        this->old_q_0[controller_index] = this->euro_x[controller_index];
+        this->old_q_1[controller_index] = this->euro_x[controller_index];
+        this->old_q_2[controller_index] = this->euro_x[controller_index];
+    }
+    this->filter_mode[controller_index] = mode;
+    this->euro_min_cutoff[controller_index] = (min_cutoff == 0 || min_cutoff > POTI_ONE_EURO_MAX_CUTOFF_MHZ) ? FILTER_DEFAULT_MIN_CUTOFF_MHZ : min_cutoff;
+    this->euro_beta[controller_index] = (beta > POTI_ONE_EURO_MAX_CUTOFF_MHZ) ? FILTER_DEFAULT_BETA : beta;
+#ifdef DEBUG
+    printf(
+        "setFilter: INDEX: %d (%d)\n mode: %d, min cutoff: %lu mHz, beta: %lu\n",
+        controller_index,
+        controller_index + this->controller_start_index,
+        mode,
+        (unsigned long)this->euro_min_cutoff[controller_index],
+        (unsigned long)this->euro_beta[controller_index]);
+#endif
+}
+
+uint8_t PotiCtl::getFilterMode(uint8_t controller_index)
+{
+    return this->filter_mode[controller_index];
+}
+
+/**
+ * @brief Set the output resolution of a knob. Values outside POTI_RESOLUTION_BITS_MIN - POTI_RESOLUTION_BITS_MAX
+ * fall back to 9 bit
+ *
+ * @param controller_index
+ * @param bits 9 - 14
+ */
+void PotiCtl::setResolution(uint8_t controller_index, uint8_t bits)
+{
+    bits = (bits < POTI_RESOLUTION_BITS_MIN || bits > POTI_RESOLUTION_BITS_MAX) ? POTI_RESOLUTION_BITS_MIN : bits;
+    // Rescale the current output so the step limit does not make the value crawl to the new range
+    int old_shift = this->resolutionShift(controller_index);
+    int new_shift = bits - POTI_RESOLUTION_BITS_MIN;
+    this->out_val[controller_index] = (this->out_val[controller_index] >> old_shift) << new_shift;
+    this->resolution[controller_index] = bits;
+    this->buildCenterTable(controller_index);
+    this->locked[controller_index] = false;
+    this->adc_same_val_count[controller_index] = 0;
+    this->out_val_centered[controller_index] = this->centerValue(controller_index);
+}
+
+uint8_t PotiCtl::getResolution(uint8_t controller_index)
+{
+    return this->resolution[controller_index];
+}
+
+uint8_t PotiCtl::resolutionShift(uint8_t channel_index)
+{
+    return this->resolution[channel_index] - POTI_RESOLUTION_BITS_MIN;
+}
+
+int PotiCtl::outMax(uint8_t channel_index)
+{
+    return (1 << this->resolution[channel_index]) - 1;
+}
+
 uint8_t PotiCtl::getChannelStartIndex() {
     return this->controller_start_index;
 }
 
 // PRIVATE Functions
+
 long PotiCtl::_clip(double x, double min, double max)
 {
     long x_rounded = round(x);
@@ -284,4 +610,42 @@ double PotiCtl::_smooth(double new_val, double old_val, double smooth)
 {
     // y(k) = (1-b)*x(k) + b*y(k-1)
     return (1 - smooth) * new_val + smooth * old_val;
+}
+
+/**
+ * @brief Integer version of _map(): rounds half away from zero and clips to the output range like _map() does
+ *
+ */
+long PotiCtl::_mapInt(long x, long in_min, long in_max, long out_min, long out_max)
+{
+    long numerator = (x - in_min) * (out_max - out_min);
+    long denominator = in_max - in_min;
+    if (denominator == 0)
+    {
+        return (x > in_min) ? out_max : out_min;
+    }
+    if (denominator < 0)
+    {
+        numerator = -numerator;
+        denominator = -denominator;
+    }
+    long mapped = (numerator >= 0) ? (2 * numerator + denominator) / (2 * denominator) : -((-2 * numerator + denominator) / (2 * denominator));
+    mapped = mapped + out_min;
+    mapped = (mapped < out_min) ? out_min : mapped;
+    mapped = (mapped > out_max) ? out_max : mapped;
+    return mapped;
+}
+
+int32_t PotiCtl::_smoothFixed(int32_t new_val, int32_t old_val, int32_t coefficient)
+{
+    // y(k) = y(k-1) + (1-b)*(x(k) - y(k-1)). The difference in 64 bit: the One-Euro velocity spans +-2^30
+    return old_val + (int32_t)((((int64_t)new_val - old_val) * coefficient + POTI_Q_HALF) >> POTI_Q_BITS);
+}
+
+int32_t PotiCtl::_oneEuroAlpha(uint32_t cutoff_mhz, uint32_t dt_us)
+{
+    // alpha = 1 / (1 + tau / dt) with tau = 1 / (2 * pi * cutoff)
+    cutoff_mhz = (cutoff_mhz < 1) ? 1 : cutoff_mhz;
+    uint32_t tau_us = POTI_ONE_EURO_TAU_SCALE / cutoff_mhz;
+    return (int32_t)(((int64_t)dt_us << POTI_Q_BITS) / (dt_us + tau_us));
 }
\ No newline at end of file
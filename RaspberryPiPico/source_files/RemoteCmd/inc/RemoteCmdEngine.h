@@ -0,0 +1,119 @@
+#ifndef __REMOTE_CMD_ENGINE_H__
+#define __REMOTE_CMD_ENGINE_H__
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+#define REMOTE_COMMAND_MAX_DATA_BYTES 24
+#define REMOTE_CMD_SLOT_COUNT 16 // Complete commands waiting for execute(), one slot is always being filled
+
+// Transports a command is accepted on (bit mask)
+#define REMOTE_CMD_TRANSPORT_USB 0x01
+#define REMOTE_CMD_TRANSPORT_UART 0x02
+#define REMOTE_CMD_TRANSPORT_ALL (REMOTE_CMD_TRANSPORT_USB | REMOTE_CMD_TRANSPORT_UART)
+
+#define REMOTE_CMD_ADDRESS_ANY 0xFF // Accept the start byte of every board (USB: the board is addressed by the cable)
+
+// Multicast frame: [0xD0, seq, mask boards 0-6, mask boards 7-13, mask boards 14-15, message type, data bytes]
+#define REMOTE_CMD_MULTICAST 0xD0
+#define REMOTE_CMD_MULTICAST_HEADER_BYTES 4
+#define REMOTE_CMD_MULTICAST_GROUP_SIZE 7 // Boards per mask byte
+#define REMOTE_CMD_MULTICAST_SEQ_MASK 0x1F
+#define REMOTE_CMD_UNICAST 0xFF // multicast_seq of a command sent to one board
+
+// Upstream acknowledge of a multicast command, value: seq << 9 | mask group << 7 | mask bits of the group
+#define REMOTE_CMD_ACK_CONTROLLER 0x3A
+#define REMOTE_CMD_ACK_VALUE(seq, board) (((seq) << 9) | (((board) / REMOTE_CMD_MULTICAST_GROUP_SIZE) << 7) | (1 << ((board) % REMOTE_CMD_MULTICAST_GROUP_SIZE)))
+#define REMOTE_CMD_ACK_SEQ(value) (((value) >> 9) & REMOTE_CMD_MULTICAST_SEQ_MASK)
+#define REMOTE_CMD_ACK_MASK(value) ((uint16_t)((value) & 0x7F) << (REMOTE_CMD_MULTICAST_GROUP_SIZE * (((value) >> 7) & 0x03)))
+
+// Result of feed()
+#define REMOTE_CMD_EVENT_NONE 0
+#define REMOTE_CMD_EVENT_START 1 // Start byte for this board
+#define REMOTE_CMD_EVENT_END 2   // Command complete (queued unless unknown or not allowed on this transport)
+
+typedef void (*remote_command_handler_t)(void *context, uint8_t *data_bytes);
+typedef void (*remote_command_ack_t)(void *context, uint16_t ack_value);
+
+/**
+ * @brief One opcode: its length, the handler and the transports it is accepted on. A NULL handler consumes the
+ * data bytes without doing anything (messages for other hardware on the same board index)
+ *
+ */
+typedef struct
+{
+    uint8_t msg_type;
+    uint8_t data_byte_count;
+    uint8_t transports;
+    remote_command_handler_t handler;
+} remote_command_descriptor_t;
+
+typedef struct
+{
+    const remote_command_descriptor_t *descriptor;
+    uint8_t multicast_seq; // REMOTE_CMD_UNICAST or the sequence number of the multicast frame
+    bool addressed;        // false: multicast for other boards, only acknowledged
+    uint8_t bytes[REMOTE_COMMAND_MAX_DATA_BYTES]; // Message type first
+} remote_command_t;
+
+/**
+ * @brief Framing and dispatch of the commands from the Pi, one instance per transport. feed() takes one received
+ * byte: a start byte 0xF0 | board index opens a command, the message type byte selects its descriptor and the
+ * data bytes are written straight into a queue slot. execute() runs the handlers on the slots in place.
+ *
+ * Commands are framed by their length only, data bytes may have bit 7 set (0xE6 meter values). Unknown message
+ * types have no data bytes.
+ *
+ * A multicast start byte 0xD0 is followed by a sequence number and a board bit mask, one command then configures
+ * every board of the mask. Every board queues the command, the handler only runs on the boards of the mask. Then
+ * the ack handler is called with the REMOTE_CMD_ACK_VALUE of this board: its bit means the board is done with the
+ * frame, so the acks of the chain can be merged without knowing the mask.
+ *
+ * feed() and execute() may run in an interrupt and the main loop of the same core.
+ *
+ */
+class RemoteCmdEngine
+{
+protected:
+    const remote_command_descriptor_t *table;
+    uint8_t table_length;
+    uint8_t transport;
+    uint8_t address;
+    void *context;
+    remote_command_ack_t ack_handler = NULL;
+
+    remote_command_t slots[REMOTE_CMD_SLOT_COUNT];
+    volatile uint8_t head = 0; // Slot being filled, written by feed()
+    volatile uint8_t tail = 0; // Oldest complete command, written by execute()
+
+    bool collect_bytes = false;
+    uint8_t byte_index = 0;
+    uint8_t byte_length = 0;
+    uint8_t header_index = 0; // Multicast header bytes received, REMOTE_CMD_MULTICAST_HEADER_BYTES: complete
+    uint8_t header[REMOTE_CMD_MULTICAST_HEADER_BYTES];
+
+    // Statistics
+    uint32_t command_count = 0;
+    uint32_t drop_count = 0;
+    uint32_t unknown_count = 0;
+
+    const remote_command_descriptor_t *lookup(uint8_t msg_type);
+    bool isAddressed();
+    void complete();
+
+public:
+    RemoteCmdEngine(const remote_command_descriptor_t *table, uint8_t table_length, uint8_t transport, uint8_t address, void *context);
+    void setAckHandler(remote_command_ack_t ack_handler);
+    uint8_t feed(uint8_t c);
+    uint8_t execute();
+    bool executeNext();
+    uint32_t getCommandCount();
+    uint32_t getDropCount();
+    uint32_t getUnknownCount();
+    static uint8_t unpack7Bit(const uint8_t *packed, uint8_t packed_length, uint8_t *bytes);
+};
+
+#endif
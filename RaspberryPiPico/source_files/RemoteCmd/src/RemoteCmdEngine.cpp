@@ -0,0 +1,234 @@
+#include "RemoteCmdEngine.h"
+
+/**
+ * @brief
+ *
+ * @param table descriptors of all message types, has to outlive the engine
+ * @param table_length
+ * @param transport REMOTE_CMD_TRANSPORT_USB or REMOTE_CMD_TRANSPORT_UART
+ * @param address board index or REMOTE_CMD_ADDRESS_ANY
+ * @param context first argument of the handlers
+ */
+RemoteCmdEngine::RemoteCmdEngine(const remote_command_descriptor_t *table, uint8_t table_length, uint8_t transport, uint8_t address, void *context)
+{
+    this->table = table;
+    this->table_length = table_length;
+    this->transport = transport;
+    this->address = address;
+    this->context = context;
+}
+
+/**
+ * @brief Called after every multicast command, addressed to this board or not. On the engine of the chain only
+ * (the address has to be a board index)
+ *
+ * @param ack_handler
+ */
+void RemoteCmdEngine::setAckHandler(remote_command_ack_t ack_handler)
+{
+    this->ack_handler = ack_handler;
+}
+
+/**
+ * @brief Frame one received byte
+ *
+ * @param c
+ * @return uint8_t REMOTE_CMD_EVENT_*
+ */
+uint8_t RemoteCmdEngine::feed(uint8_t c)
+{
+    remote_command_t *slot = &this->slots[this->head];
+    if (!this->collect_bytes)
+    {
+        if ((c >> 4) == 0x0F && (this->address == REMOTE_CMD_ADDRESS_ANY || (c & 0x0F) == this->address))
+        {
+            this->collect_bytes = true;
+            this->byte_index = 0;
+            this->byte_length = 0;
+            this->header_index = REMOTE_CMD_MULTICAST_HEADER_BYTES;
+            slot->multicast_seq = REMOTE_CMD_UNICAST;
+            slot->addressed = true;
+            return REMOTE_CMD_EVENT_START;
+        }
+        if (c == REMOTE_CMD_MULTICAST)
+        {
+            this->collect_bytes = true;
+            this->byte_index = 0;
+            this->byte_length = 0;
+            this->header_index = 0;
+        }
+        return REMOTE_CMD_EVENT_NONE;
+    }
+    if (this->header_index < REMOTE_CMD_MULTICAST_HEADER_BYTES)
+    {
+        this->header[this->header_index++] = c;
+        if (this->header_index < REMOTE_CMD_MULTICAST_HEADER_BYTES)
+        {
+            return REMOTE_CMD_EVENT_NONE;
+        }
+        slot->multicast_seq = this->header[0] & REMOTE_CMD_MULTICAST_SEQ_MASK;
+        slot->addressed = this->isAddressed();
+        return slot->addressed ? REMOTE_CMD_EVENT_START : REMOTE_CMD_EVENT_NONE;
+    }
+    if (this->byte_index == 0)
+    {
+        slot->descriptor = this->lookup(c);
+        slot->bytes[0] = c;
+        this->byte_length = (slot->descriptor != NULL) ? slot->descriptor->data_byte_count + 1 : 1;
+        this->byte_index = 1;
+    }
+    else
+    {
+        slot->bytes[this->byte_index++] = c;
+    }
+    if (this->byte_index < this->byte_length)
+    {
+        return REMOTE_CMD_EVENT_NONE;
+    }
+    this->collect_bytes = false;
+    bool addressed = slot->addressed;
+    this->complete();
+    return addressed ? REMOTE_CMD_EVENT_END : REMOTE_CMD_EVENT_NONE;
+}
+
+/**
+ * @brief Run the handlers of all queued commands, oldest first
+ *
+ * @return uint8_t number of commands executed
+ */
+uint8_t RemoteCmdEngine::execute()
+{
+    uint8_t executed = 0;
+    while (this->executeNext())
+    {
+        executed++;
+    }
+    return executed;
+}
+
+/**
+ * @brief Run the handler of the oldest queued command
+ *
+ * @return true
+ * @return false nothing queued
+ */
+bool RemoteCmdEngine::executeNext()
+{
+    if (this->tail == this->head)
+    {
+        return false;
+    }
+    remote_command_t *slot = &this->slots[this->tail];
+    if (slot->addressed && slot->descriptor->handler != NULL)
+    {
+        slot->descriptor->handler(this->context, &slot->bytes[1]);
+    }
+    if (slot->multicast_seq != REMOTE_CMD_UNICAST && this->ack_handler != NULL && this->address != REMOTE_CMD_ADDRESS_ANY)
+    {
+        this->ack_handler(this->context, REMOTE_CMD_ACK_VALUE(slot->multicast_seq, this->address));
+    }
+    __dmb();
+    this->tail = (this->tail + 1) % REMOTE_CMD_SLOT_COUNT;
+    return true;
+}
+
+uint32_t RemoteCmdEngine::getCommandCount()
+{
+    return this->command_count;
+}
+
+/**
+ * @brief Commands lost because execute() was not called in time
+ *
+ * @return uint32_t
+ */
+uint32_t RemoteCmdEngine::getDropCount()
+{
+    return this->drop_count;
+}
+
+/**
+ * @brief Message types without a descriptor or not allowed on this transport
+ *
+ * @return uint32_t
+ */
+uint32_t RemoteCmdEngine::getUnknownCount()
+{
+    return this->unknown_count;
+}
+
+/**
+ * @brief Decode 8 bit data sent as 7 bit data bytes: groups of a byte with bit 7 of up to 7 following bytes
+ * (bit n: byte n of the group), then those bytes with bit 7 cleared
+ *
+ * @param packed
+ * @param packed_length
+ * @param bytes receives the decoded bytes
+ * @return uint8_t number of decoded bytes
+ */
+uint8_t RemoteCmdEngine::unpack7Bit(const uint8_t *packed, uint8_t packed_length, uint8_t *bytes)
+{
+    uint8_t length = 0;
+    for (uint8_t group = 0; group < packed_length; group += 8)
+    {
+        uint8_t msbs = packed[group];
+        for (uint8_t i = 0; i < 7 && group + 1 + i < packed_length; i++)
+        {
+            bytes[length++] = (packed[group + 1 + i] & 0x7F) | (((msbs >> i) & 0x01) << 7);
+        }
+    }
+    return length;
+}
+
+// Protected Methods
+
+const remote_command_descriptor_t *RemoteCmdEngine::lookup(uint8_t msg_type)
+{
+    for (uint8_t i = 0; i < this->table_length; i++)
+    {
+        if (this->table[i].msg_type == msg_type)
+        {
+            return (this->table[i].transports & this->transport) ? &this->table[i] : NULL;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief The board bit of the complete multicast header is set
+ *
+ * @return true
+ * @return false
+ */
+bool RemoteCmdEngine::isAddressed()
+{
+    if (this->address == REMOTE_CMD_ADDRESS_ANY)
+    {
+        return true;
+    }
+    uint8_t mask = this->header[1 + this->address / REMOTE_CMD_MULTICAST_GROUP_SIZE];
+    return (mask >> (this->address % REMOTE_CMD_MULTICAST_GROUP_SIZE)) & 0x01;
+}
+
+/**
+ * @brief Publish the slot being filled
+ *
+ */
+void RemoteCmdEngine::complete()
+{
+    if (this->slots[this->head].descriptor == NULL)
+    {
+        this->unknown_count++;
+        return;
+    }
+    uint8_t next_head = (this->head + 1) % REMOTE_CMD_SLOT_COUNT;
+    if (next_head == this->tail)
+    {
+        // Queue full: the slot is filled again by the next command
+        this->drop_count++;
+        return;
+    }
+    this->command_count++;
+    __dmb(); // Slot contents before the index
+    this->head = next_head;
+}
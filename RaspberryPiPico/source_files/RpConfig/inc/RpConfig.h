@@ -24,6 +24,15 @@
 #define CONTROLLER_MODE_RADIO_GROUP 4
 #endif
 
+#ifndef __FILTER_MODES__
+#define __FILTER_MODES__
+#define FILTER_MODE_CASCADE 0  // Fixed exponential average cascade
+#define FILTER_MODE_ONE_EURO 1 // Velocity adaptive cutoff (One-Euro filter)
+#endif
+#define FILTER_DEFAULT_MIN_CUTOFF_MHZ 1000 // Cutoff of the One-Euro filter when the knob is not moving
+#define FILTER_DEFAULT_BETA 5000           // Cutoff increase in mHz per full scale per second of knob velocity
+#define KNOB_DEFAULT_RESOLUTION 9           // Output resolution in bits (0 - 511)
+
 // Eeprom Memory Map
 #define MEM_ADDRESS_INITIALIZED 0x00
 #define MEM_ADDRESS_INC_STEPS 0x01
@@ -39,8 +48,46 @@
 #define MEM_OFFSET_CONTROLLER_MAX 0x07
 #define MEM_OFFSET_CONTROLLER_CENTER 0x0B
 
+#define MEM_ADDRESS_FILTER_CONFIG 0x100
+#define FILTER_CONFIG_BYTE_SIZE 0x10
+#define MEM_OFFSET_FILTER_MODE 0x00
+#define MEM_OFFSET_FILTER_MIN_CUTOFF 0x01
+#define MEM_OFFSET_FILTER_BETA 0x05
+#define MEM_OFFSET_FILTER_RESOLUTION 0x09 // Knob output resolution in bits
+
 #define MEM_INITIALIZED_TOKEN 0x8B
 
+// Configuration image: the memory map up to the end of the filter configs, loaded as a whole (MSG_CONFIG_DATA)
+#define CONFIG_IMAGE_SIZE 0x200
+#define CONFIG_IMAGE_PAGE_SIZE 32 // 24LC32 page
+#define CONFIG_IMAGE_PAGE_COUNT (CONFIG_IMAGE_SIZE / CONFIG_IMAGE_PAGE_SIZE)
+#define CONFIG_IMAGE_BLOCK_SIZE 16
+#define CONFIG_IMAGE_BLOCK_COUNT (CONFIG_IMAGE_SIZE / CONFIG_IMAGE_BLOCK_SIZE) // One bit each in staged_blocks
+#define CONFIG_IMAGE_LOAD_CHUNK 128 // Bytes per sequential read when the image is loaded at boot
+// Results of checkStagedImage()
+#define CONFIG_IMAGE_OK 0
+#define CONFIG_IMAGE_INCOMPLETE 1
+#define CONFIG_IMAGE_CHECKSUM 2
+#define CONFIG_IMAGE_INVALID 3
+
+#define CONFIG_FLUSH_WRITE_CYCLE_US 5000 // 24LC32 write cycle, flushStep() does not probe the EEPROM before it passed
+
+// Journal of the runtime state (button values, controller status) in the rest of the 24LC32. Entries are appended
+// round robin, the one with the highest sequence number is the current state. Entry layout:
+// marker, sequence (4 bytes), button values (6 bytes), controller status (2 bytes), reserved, crc16 (2 bytes)
+#define JOURNAL_ADDRESS CONFIG_IMAGE_SIZE
+#define JOURNAL_SIZE (0x1000 - JOURNAL_ADDRESS)
+#define JOURNAL_ENTRY_SIZE 16 // Two entries per page, an entry is written with one page write
+#define JOURNAL_ENTRY_COUNT (JOURNAL_SIZE / JOURNAL_ENTRY_SIZE)
+#define JOURNAL_ENTRY_MARKER 0x5A
+#define JOURNAL_OFFSET_SEQUENCE 0x01
+#define JOURNAL_OFFSET_BUTTON_VALUES 0x05
+#define JOURNAL_OFFSET_CONTROLLER_STATUS 0x0B
+#define JOURNAL_OFFSET_CRC 0x0E
+#define JOURNAL_SCAN_CHUNK 128            // Bytes per sequential read of the boot scan
+#define JOURNAL_APPEND_INTERVAL_US 200000 // Changes in between are merged into one entry
+#define RUNTIME_STATE_BUTTON_COUNT 6
+
 // We use unly one struct for Buttons and Knobs config to simplify the data structre
 // Buttons use: index (starting at 0), mode (CONTROLLER_MODE_TOGGLE, CONTROLLER_MODE_MOMENTARY, CONTROLLER_MODE_INCREMENT), value
 // Kobs use   : index (starting at 6), mode (CONTROLLER_MODE_KNOB), min, max, center
@@ -54,13 +101,62 @@ typedef struct
     uint32_t center = 0;                   // Memory width: 4 Bytes
 } controller_config_t;
 
+// Bytes of one page changed in the mirror but not yet written to the EEPROM, offsets inside the page
+typedef struct
+{
+    uint8_t first;
+    uint8_t last;
+} config_dirty_range_t;
+
+typedef struct
+{
+    uint8_t button_value[RUNTIME_STATE_BUTTON_COUNT];
+    uint16_t controller_status;
+} config_runtime_state_t;
+
+/**
+ * @brief Board configuration in the 24LC32. The configuration region is read once at construction into a RAM
+ * mirror, every read* is served from RAM. Writes only update the mirror and mark the changed bytes dirty,
+ * flushStep() writes them back one page at a time when the main loop is idle, flush() right away.
+ * Button values and the controller status are kept in a journal instead of their fixed addresses, those only
+ * provide the state until the first journal entry is written.
+ *
+ */
 class RpConfig
 {
 protected:
     Eeprom24LC32 *storage;
+    uint8_t image[CONFIG_IMAGE_SIZE]; // RAM mirror of the configuration region, all reads are served from it
+    uint8_t staged_image[CONFIG_IMAGE_SIZE];
+    uint32_t staged_blocks = 0;
+    uint32_t load_us = 0;
+    uint32_t dirty_pages = 0; // One bit per page of the mirror
+    config_dirty_range_t dirty_range[CONFIG_IMAGE_PAGE_COUNT];
+    uint32_t dirty_since_us = 0;
+    uint32_t last_flush_write_us = 0;
+    uint32_t flush_page_writes = 0;
+    uint32_t flush_step_max_us = 0;
+    uint32_t flush_latency_max_us = 0;
+    config_runtime_state_t runtime_state = {};
+    bool runtime_state_pending = false; // Changed since the last journal entry
+    uint32_t journal_sequence = 0;      // Of the newest entry, 0: none
+    uint16_t journal_next_slot = 0;
+    uint32_t journal_last_append_us = 0;
+    uint32_t journal_appends = 0;
+    uint32_t journal_recover_us = 0;
 
     uint32_t controllerConfigBaseAddress(uint8_t index);
+    uint32_t filterConfigBaseAddress(uint8_t index);
     bool storageIsInitialized();
+    void loadImage();
+    uint8_t readImageByte(uint32_t mem_address);
+    uint32_t readImageInt32(uint32_t mem_address);
+    void writeImageByte(uint32_t mem_address, uint8_t value);
+    void writeImageInt32(uint32_t mem_address, uint32_t value);
+    void markDirty(uint32_t mem_address, uint8_t length);
+    void clearDirty(uint8_t page_index);
+    void recoverJournal();
+    bool appendJournalEntry(bool blocking);
 
 public:
     RpConfig(Eeprom24LC32 *storage, bool force_config_init = false);
@@ -89,6 +185,18 @@ public:
     uint32_t readControllerCenter(uint8_t button_index);
     void writeControllerCenter(uint8_t button_index, uint32_t value);
 
+    uint8_t readControllerFilterMode(uint8_t knob_index);
+    void writeControllerFilterMode(uint8_t knob_index, uint8_t value);
+
+    uint32_t readControllerFilterMinCutoff(uint8_t knob_index);
+    void writeControllerFilterMinCutoff(uint8_t knob_index, uint32_t value);
+
+    uint32_t readControllerFilterBeta(uint8_t knob_index);
+    void writeControllerFilterBeta(uint8_t knob_index, uint32_t value);
+
+    uint8_t readControllerResolution(uint8_t knob_index);
+    void writeControllerResolution(uint8_t knob_index, uint8_t value);
+
     void readControllerConfig(controller_config_t *button_config);
     void writeControllerConfig(controller_config_t *button_config);
 
@@ -96,6 +204,27 @@ public:
 
     void writeControllerStatus(uint32_t ctl_status);
     uint32_t readControllerStatus();
+
+    void stageImageBlock(uint8_t block_index, uint8_t *block);
+    uint8_t checkStagedImage(uint16_t crc);
+    bool beginImageCommit();
+    bool commitImagePage(uint8_t page_index);
+    void discardStagedImage();
+    static uint16_t crc16(const uint8_t *data, uint16_t length);
+    uint32_t getLoadUs();
+
+    bool flushStep();
+    void flush();
+    uint32_t getDirtyByteCount();
+    uint32_t getFlushPageWrites();
+    uint32_t getFlushStepMaxUs();
+    uint32_t getFlushLatencyMaxUs();
+    void resetFlushStatistics();
+
+    void resetRuntimeState();
+    uint32_t getJournalSequence();
+    uint32_t getJournalAppends();
+    uint32_t getJournalRecoverUs();
 };
 
 #endif
\ No newline at end of file
@@ -3,15 +3,24 @@
 RpConfig::RpConfig(Eeprom24LC32 *storage, bool force_config_init)
 {
     this->storage = storage;
+    this->loadImage();
     if (!this->storageIsInitialized() || force_config_init)
     {
         this->initStorage();
     }
+    else
+    {
+        this->recoverJournal();
+    }
 }
 
 void RpConfig::initStorage()
 {
     this->storage->erase();
+    memset(this->image, 0x00, CONFIG_IMAGE_SIZE);
+    // The journal is erased as well
+    this->journal_sequence = 0;
+    this->journal_next_slot = 0;
     // Initialize Button configs
     for (uint8_t i = 0; i < 6; i++)
     {
@@ -37,83 +46,154 @@ void RpConfig::initStorage()
         default_config.max = 990;
         default_config.center = 0;
         this->writeControllerConfig(&default_config);
+        this->writeControllerFilterMode(j, FILTER_MODE_CASCADE);
+        this->writeControllerFilterMinCutoff(j, FILTER_DEFAULT_MIN_CUTOFF_MHZ);
+        this->writeControllerFilterBeta(j, FILTER_DEFAULT_BETA);
+        this->writeControllerResolution(j, KNOB_DEFAULT_RESOLUTION);
     }
 
-    this->storage->writeByte(MEM_ADDRESS_INC_STEPS, 0x05);
-    this->storage->writeInt32(MEM_ADDRESS_CONTROLLER_STATUS, 0xFFFF);
-    this->storage->writeByte(MEM_ADDRESS_INC_DISPLAY_ZERO, 0x01);
-    this->storage->writeByte(MEM_ADDRESS_RADIO_GROUP_DISPLAY_ZERO, 0x00);
-    this->storage->writeByte(MEM_ADDRESS_INITIALIZED, MEM_INITIALIZED_TOKEN);
+    this->writeImageByte(MEM_ADDRESS_INC_STEPS, 0x05);
+    this->writeImageInt32(MEM_ADDRESS_CONTROLLER_STATUS, 0xFFFF);
+    this->writeImageByte(MEM_ADDRESS_INC_DISPLAY_ZERO, 0x01);
+    this->writeImageByte(MEM_ADDRESS_RADIO_GROUP_DISPLAY_ZERO, 0x00);
+    this->writeImageByte(MEM_ADDRESS_INITIALIZED, MEM_INITIALIZED_TOKEN);
+    this->resetRuntimeState();
+    this->flush();
 }
 
 uint8_t RpConfig::readControllerMode(uint8_t button_index)
 {
     uint32_t mem_address = this->controllerConfigBaseAddress(button_index) + MEM_OFFSET_CONTROLLER_MODE;
-    busy_wait_ms(5);
-    return this->storage->readByte(mem_address);
+    return this->readImageByte(mem_address);
 };
 
 void RpConfig::writeControllerMode(uint8_t button_index, uint8_t value)
 {
     uint32_t mem_address = this->controllerConfigBaseAddress(button_index) + MEM_OFFSET_CONTROLLER_MODE;
-    this->storage->writeByte(mem_address, value);
+    this->writeImageByte(mem_address, value);
 };
 
+/**
+ * @brief Button values come from the journal
+ *
+ * @param button_index
+ * @return uint8_t
+ */
 uint8_t RpConfig::readControllerValue(uint8_t button_index)
 {
+    if (button_index < RUNTIME_STATE_BUTTON_COUNT)
+    {
+        return this->runtime_state.button_value[button_index];
+    }
     uint32_t mem_address = this->controllerConfigBaseAddress(button_index) + MEM_OFFSET_CONTROLLER_VALUE;
-    busy_wait_ms(5);
-    return this->storage->readByte(mem_address);
+    return this->readImageByte(mem_address);
 }
 
+/**
+ * @brief Button values go to the journal, cheap enough to call on every change
+ *
+ * @param button_index
+ * @param value
+ */
 void RpConfig::writeControllerValue(uint8_t button_index, uint8_t value)
 {
+    if (button_index < RUNTIME_STATE_BUTTON_COUNT)
+    {
+        if (this->runtime_state.button_value[button_index] != value)
+        {
+            this->runtime_state.button_value[button_index] = value;
+            this->runtime_state_pending = true;
+        }
+        return;
+    }
     uint32_t mem_address = this->controllerConfigBaseAddress(button_index) + MEM_OFFSET_CONTROLLER_VALUE;
-    this->storage->writeByte(mem_address, value);
+    this->writeImageByte(mem_address, value);
 }
 
 uint32_t RpConfig::readControllerMin(uint8_t button_index)
 {
     uint32_t mem_address = this->controllerConfigBaseAddress(button_index) + MEM_OFFSET_CONTROLLER_MIN;
-    busy_wait_ms(5);
-    return this->storage->readInt32(mem_address);
+    return this->readImageInt32(mem_address);
 };
 
 void RpConfig::writeControllerMin(uint8_t button_index, uint32_t value)
 {
     uint32_t mem_address = this->controllerConfigBaseAddress(button_index) + MEM_OFFSET_CONTROLLER_MIN;
-    this->storage->writeInt32(mem_address, value);
-    busy_wait_ms(5);
+    this->writeImageInt32(mem_address, value);
 };
 
 uint32_t RpConfig::readControllerMax(uint8_t button_index)
 {
     uint32_t mem_address = this->controllerConfigBaseAddress(button_index) + MEM_OFFSET_CONTROLLER_MAX;
-    busy_wait_ms(5);
-    return this->storage->readInt32(mem_address);
+    return this->readImageInt32(mem_address);
 };
 
 void RpConfig::writeControllerMax(uint8_t button_index, uint32_t value)
 {
     uint32_t mem_address = this->controllerConfigBaseAddress(button_index) + MEM_OFFSET_CONTROLLER_MAX;
-    this->storage->writeInt32(mem_address, value);
-    busy_wait_ms(5);
+    this->writeImageInt32(mem_address, value);
 };
 
 uint32_t RpConfig::readControllerCenter(uint8_t button_index)
 {
     uint32_t mem_address = this->controllerConfigBaseAddress(button_index) + MEM_OFFSET_CONTROLLER_CENTER;
-    busy_wait_ms(5);
-    return this->storage->readInt32(mem_address);
+    return this->readImageInt32(mem_address);
 };
 
 void RpConfig::writeControllerCenter(uint8_t button_index, uint32_t value)
 {
     uint32_t mem_address = this->controllerConfigBaseAddress(button_index) + MEM_OFFSET_CONTROLLER_CENTER;
-    this->storage->writeInt32(mem_address, value);
-    busy_wait_ms(5);
+    this->writeImageInt32(mem_address, value);
 };
 
+uint8_t RpConfig::readControllerFilterMode(uint8_t knob_index)
+{
+    uint32_t mem_address = this->filterConfigBaseAddress(knob_index) + MEM_OFFSET_FILTER_MODE;
+    return this->readImageByte(mem_address);
+}
+
+void RpConfig::writeControllerFilterMode(uint8_t knob_index, uint8_t value)
+{
+    uint32_t mem_address = this->filterConfigBaseAddress(knob_index) + MEM_OFFSET_FILTER_MODE;
+    this->writeImageByte(mem_address, value);
+}
+
+uint32_t RpConfig::readControllerFilterMinCutoff(uint8_t knob_index)
+{
+    uint32_t mem_address = this->filterConfigBaseAddress(knob_index) + MEM_OFFSET_FILTER_MIN_CUTOFF;
+    return this->readImageInt32(mem_address);
+}
+
+void RpConfig::writeControllerFilterMinCutoff(uint8_t knob_index, uint32_t value)
+{
+    uint32_t mem_address = this->filterConfigBaseAddress(knob_index) + MEM_OFFSET_FILTER_MIN_CUTOFF;
+    this->writeImageInt32(mem_address, value);
+}
+
+uint32_t RpConfig::readControllerFilterBeta(uint8_t knob_index)
+{
+    uint32_t mem_address = this->filterConfigBaseAddress(knob_index) + MEM_OFFSET_FILTER_BETA;
+    return this->readImageInt32(mem_address);
+}
+
+void RpConfig::writeControllerFilterBeta(uint8_t knob_index, uint32_t value)
+{
+    uint32_t mem_address = this->filterConfigBaseAddress(knob_index) + MEM_OFFSET_FILTER_BETA;
+    this->writeImageInt32(mem_address, value);
+}
+
+uint8_t RpConfig::readControllerResolution(uint8_t knob_index)
+{
+    uint32_t mem_address = this->filterConfigBaseAddress(knob_index) + MEM_OFFSET_FILTER_RESOLUTION;
+    return this->readImageByte(mem_address);
+}
+
+void RpConfig::writeControllerResolution(uint8_t knob_index, uint8_t value)
+{
+    uint32_t mem_address = this->filterConfigBaseAddress(knob_index) + MEM_OFFSET_FILTER_RESOLUTION;
+    this->writeImageByte(mem_address, value);
+}
+
 void RpConfig::readControllerConfig(controller_config_t *button_config)
 {
     button_config->mode = this->readControllerMode(button_config->index);
@@ -134,47 +214,339 @@ void RpConfig::writeControllerConfig(controller_config_t *button_config)
 
 uint8_t RpConfig::readIncSteps()
 {
-    return this->storage->readByte(MEM_ADDRESS_INC_STEPS);
-    busy_wait_ms(5);
+    return this->readImageByte(MEM_ADDRESS_INC_STEPS);
 }
 
 void RpConfig::writeIncSteps(uint8_t max_steps)
 {
-    this->storage->writeByte(MEM_ADDRESS_INC_STEPS, max_steps);
-    busy_wait_ms(5);
+    this->writeImageByte(MEM_ADDRESS_INC_STEPS, max_steps);
 }
 
+/**
+ * @brief The controller status goes to the journal
+ *
+ * @param ctl_status
+ */
 void RpConfig::writeControllerStatus(uint32_t ctl_status)
 {
-    this->storage->writeInt32(MEM_ADDRESS_CONTROLLER_STATUS, ctl_status);
-    busy_wait_ms(5);
+    if (this->runtime_state.controller_status != (uint16_t)ctl_status)
+    {
+        this->runtime_state.controller_status = (uint16_t)ctl_status;
+        this->runtime_state_pending = true;
+    }
 }
 
 bool RpConfig::readIncrementDisplayZero()
 {
-    return (bool)this->storage->readByte(MEM_ADDRESS_INC_DISPLAY_ZERO);
+    return (bool)this->readImageByte(MEM_ADDRESS_INC_DISPLAY_ZERO);
 }
 
 void RpConfig::writeIncrementDisplayZero(bool display_zero)
 {
-    this->storage->writeByte(MEM_ADDRESS_INC_DISPLAY_ZERO, (uint8_t)display_zero);
-    busy_wait_ms(5);
+    this->writeImageByte(MEM_ADDRESS_INC_DISPLAY_ZERO, (uint8_t)display_zero);
 }
 
 bool RpConfig::readRadioGroupDisplayZero()
 {
-    return (bool)this->storage->readByte(MEM_ADDRESS_RADIO_GROUP_DISPLAY_ZERO);
+    return (bool)this->readImageByte(MEM_ADDRESS_RADIO_GROUP_DISPLAY_ZERO);
 }
 
 void RpConfig::writeRadioGroupDisplayZero(bool display_zero)
 {
-    this->storage->writeByte(MEM_ADDRESS_RADIO_GROUP_DISPLAY_ZERO, (uint8_t)display_zero);
-    busy_wait_ms(5);
+    this->writeImageByte(MEM_ADDRESS_RADIO_GROUP_DISPLAY_ZERO, (uint8_t)display_zero);
 }
 
 uint32_t RpConfig::readControllerStatus()
 {
-    return this->storage->readInt32(MEM_ADDRESS_CONTROLLER_STATUS);
+    return this->runtime_state.controller_status;
+}
+
+/**
+ * @brief Copy one block of a new configuration image to RAM. Blocks may arrive in any order and be repeated
+ *
+ * @param block_index 0 - CONFIG_IMAGE_BLOCK_COUNT - 1
+ * @param block CONFIG_IMAGE_BLOCK_SIZE bytes
+ */
+void RpConfig::stageImageBlock(uint8_t block_index, uint8_t *block)
+{
+    if (block_index >= CONFIG_IMAGE_BLOCK_COUNT)
+    {
+        return;
+    }
+    memcpy(&this->staged_image[block_index * CONFIG_IMAGE_BLOCK_SIZE], block, CONFIG_IMAGE_BLOCK_SIZE);
+    BIT_SET(this->staged_blocks, block_index);
+}
+
+/**
+ * @brief The staged image is complete, matches the checksum and looks like a configuration of this firmware
+ *
+ * @param crc crc16() of the whole image
+ * @return uint8_t CONFIG_IMAGE_*
+ */
+uint8_t RpConfig::checkStagedImage(uint16_t crc)
+{
+    if (this->staged_blocks != 0xFFFFFFFF)
+    {
+        return CONFIG_IMAGE_INCOMPLETE;
+    }
+    if (RpConfig::crc16(this->staged_image, CONFIG_IMAGE_SIZE) != crc)
+    {
+        return CONFIG_IMAGE_CHECKSUM;
+    }
+    if (this->staged_image[MEM_ADDRESS_INITIALIZED] != MEM_INITIALIZED_TOKEN)
+    {
+        return CONFIG_IMAGE_INVALID;
+    }
+    for (uint8_t i = 0; i < 14; i++)
+    {
+        if (this->staged_image[this->controllerConfigBaseAddress(i) + MEM_OFFSET_CONTROLLER_MODE] > CONTROLLER_MODE_RADIO_GROUP)
+        {
+            return CONFIG_IMAGE_INVALID;
+        }
+    }
+    return CONFIG_IMAGE_OK;
+}
+
+/**
+ * @brief Invalidate the stored configuration before the first page of a new image is written. Commit page 0,
+ * which holds MEM_ADDRESS_INITIALIZED, last: a commit cut short by a power loss leaves no token, and the next boot
+ * starts from the defaults instead of a mix of old and new pages
+ *
+ * @return true the image differs, the token was cleared
+ * @return false nothing to commit
+ */
+bool RpConfig::beginImageCommit()
+{
+    if (memcmp(this->image, this->staged_image, CONFIG_IMAGE_SIZE) == 0)
+    {
+        return false;
+    }
+    uint8_t cleared_token = 0x00;
+    this->storage->write(MEM_ADDRESS_INITIALIZED, &cleared_token, 1);
+    this->image[MEM_ADDRESS_INITIALIZED] = cleared_token;
+    return true;
+}
+
+/**
+ * @brief Write one page of the staged image with a single page write, if it differs from the mirror
+ *
+ * @param page_index 0 - CONFIG_IMAGE_PAGE_COUNT - 1
+ * @return true the page was written
+ * @return false unchanged
+ */
+bool RpConfig::commitImagePage(uint8_t page_index)
+{
+    uint8_t *page = &this->image[page_index * CONFIG_IMAGE_PAGE_SIZE];
+    uint8_t *staged_page = &this->staged_image[page_index * CONFIG_IMAGE_PAGE_SIZE];
+    if (memcmp(page, staged_page, CONFIG_IMAGE_PAGE_SIZE) == 0)
+    {
+        return false;
+    }
+    memcpy(page, staged_page, CONFIG_IMAGE_PAGE_SIZE);
+    this->storage->writePage(page_index, page);
+    // The whole page is written, pending bytes of it included
+    this->clearDirty(page_index);
+    return true;
+}
+
+void RpConfig::discardStagedImage()
+{
+    this->staged_blocks = 0;
+}
+
+/**
+ * @brief CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF)
+ *
+ * @param data
+ * @param length
+ * @return uint16_t
+ */
+uint16_t RpConfig::crc16(const uint8_t *data, uint16_t length)
+{
+    uint16_t crc = 0xFFFF;
+    for (uint16_t i = 0; i < length; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+/**
+ * @brief Time the configuration region took to load at construction
+ *
+ * @return uint32_t
+ */
+uint32_t RpConfig::getLoadUs()
+{
+    return this->load_us;
+}
+
+/**
+ * @brief Write the dirty bytes of one page, without waiting for the write cycle. Call it when the main loop is idle,
+ * it does not touch the EEPROM more often than once per CONFIG_FLUSH_WRITE_CYCLE_US
+ *
+ * @return true bytes still pending
+ * @return false the EEPROM holds the mirror
+ */
+bool RpConfig::flushStep()
+{
+    if (this->dirty_pages == 0 && !this->runtime_state_pending)
+    {
+        return false;
+    }
+    uint32_t now_us = time_us_32();
+    if (now_us - this->last_flush_write_us < CONFIG_FLUSH_WRITE_CYCLE_US)
+    {
+        return true;
+    }
+    if (this->dirty_pages == 0)
+    {
+        // Only the runtime state is left, at most one journal entry per JOURNAL_APPEND_INTERVAL_US
+        if (now_us - this->journal_last_append_us < JOURNAL_APPEND_INTERVAL_US)
+        {
+            return true;
+        }
+        this->last_flush_write_us = now_us;
+        return !this->appendJournalEntry(false);
+    }
+    this->last_flush_write_us = now_us;
+    uint8_t page_index = 0;
+    while (!BIT_ISSET(this->dirty_pages, page_index))
+    {
+        page_index++;
+    }
+    config_dirty_range_t *range = &this->dirty_range[page_index];
+    uint32_t mem_address = page_index * CONFIG_IMAGE_PAGE_SIZE + range->first;
+    if (!this->storage->startWrite(mem_address, &this->image[mem_address], range->last - range->first + 1))
+    {
+        // Still busy with a write of someone else, try again after one write cycle
+        return true;
+    }
+    uint32_t step_us = time_us_32() - now_us;
+    if (step_us > this->flush_step_max_us)
+    {
+        this->flush_step_max_us = step_us;
+    }
+    this->clearDirty(page_index);
+    return this->dirty_pages != 0 || this->runtime_state_pending;
+}
+
+/**
+ * @brief Write all dirty bytes and a pending journal entry now, blocks for one write cycle per page
+ *
+ */
+void RpConfig::flush()
+{
+    for (uint8_t page_index = 0; page_index < CONFIG_IMAGE_PAGE_COUNT; page_index++)
+    {
+        if (!BIT_ISSET(this->dirty_pages, page_index))
+        {
+            continue;
+        }
+        config_dirty_range_t *range = &this->dirty_range[page_index];
+        uint32_t mem_address = page_index * CONFIG_IMAGE_PAGE_SIZE + range->first;
+        this->storage->write(mem_address, &this->image[mem_address], range->last - range->first + 1);
+        this->clearDirty(page_index);
+    }
+    if (this->runtime_state_pending)
+    {
+        this->appendJournalEntry(true);
+    }
+    this->last_flush_write_us = time_us_32();
+}
+
+/**
+ * @brief Bytes changed in the mirror and not yet written to the EEPROM
+ *
+ * @return uint32_t
+ */
+uint32_t RpConfig::getDirtyByteCount()
+{
+    uint32_t count = 0;
+    for (uint8_t page_index = 0; page_index < CONFIG_IMAGE_PAGE_COUNT; page_index++)
+    {
+        if (BIT_ISSET(this->dirty_pages, page_index))
+        {
+            count += this->dirty_range[page_index].last - this->dirty_range[page_index].first + 1;
+        }
+    }
+    return count;
+}
+
+uint32_t RpConfig::getFlushPageWrites()
+{
+    return this->flush_page_writes;
+}
+
+/**
+ * @brief Longest time a flushStep() spent on the I2C bus
+ *
+ * @return uint32_t
+ */
+uint32_t RpConfig::getFlushStepMaxUs()
+{
+    return this->flush_step_max_us;
+}
+
+/**
+ * @brief Longest time from the first write to the mirror until all of it was written to the EEPROM
+ *
+ * @return uint32_t
+ */
+uint32_t RpConfig::getFlushLatencyMaxUs()
+{
+    return this->flush_latency_max_us;
+}
+
+void RpConfig::resetFlushStatistics()
+{
+    this->flush_step_max_us = 0;
+    this->flush_latency_max_us = 0;
+}
+
+/**
+ * @brief Take the runtime state from the fixed addresses again, a new configuration image brings its own. It is
+ * journaled with the next flush
+ *
+ */
+void RpConfig::resetRuntimeState()
+{
+    for (uint8_t i = 0; i < RUNTIME_STATE_BUTTON_COUNT; i++)
+    {
+        uint32_t mem_address = this->controllerConfigBaseAddress(i) + MEM_OFFSET_CONTROLLER_VALUE;
+        this->runtime_state.button_value[i] = this->readImageByte(mem_address);
+    }
+    this->runtime_state.controller_status = (uint16_t)this->readImageInt32(MEM_ADDRESS_CONTROLLER_STATUS);
+    this->runtime_state_pending = true;
+}
+
+/**
+ * @brief Sequence number of the newest journal entry, 0: none written yet
+ *
+ * @return uint32_t
+ */
+uint32_t RpConfig::getJournalSequence()
+{
+    return this->journal_sequence;
+}
+
+uint32_t RpConfig::getJournalAppends()
+{
+    return this->journal_appends;
+}
+
+/**
+ * @brief Time the journal scan took at construction
+ *
+ * @return uint32_t
+ */
+uint32_t RpConfig::getJournalRecoverUs()
+{
+    return this->journal_recover_us;
 }
 
 // Protected Methods
@@ -184,8 +556,211 @@ uint32_t RpConfig::controllerConfigBaseAddress(uint8_t index)
     return MEM_ADDRESS_BUTTON_CONFIG + (index * CONTROLLER_CONFIG_BYTE_SIZE);
 }
 
+uint32_t RpConfig::filterConfigBaseAddress(uint8_t index)
+{
+    return MEM_ADDRESS_FILTER_CONFIG + (index * FILTER_CONFIG_BYTE_SIZE);
+}
+
 bool RpConfig::storageIsInitialized()
 {
-    uint8_t init_token = this->storage->readByte(MEM_ADDRESS_INITIALIZED);
-    return init_token == MEM_INITIALIZED_TOKEN;
+    return this->image[MEM_ADDRESS_INITIALIZED] == MEM_INITIALIZED_TOKEN;
+}
+
+/**
+ * @brief Read the whole configuration region into the mirror, CONFIG_IMAGE_LOAD_CHUNK bytes per sequential read
+ *
+ */
+void RpConfig::loadImage()
+{
+    uint32_t start_us = time_us_32();
+    for (uint32_t mem_address = 0; mem_address < CONFIG_IMAGE_SIZE; mem_address += CONFIG_IMAGE_LOAD_CHUNK)
+    {
+        this->storage->read(mem_address, &this->image[mem_address], CONFIG_IMAGE_LOAD_CHUNK);
+    }
+    this->load_us = time_us_32() - start_us;
+}
+
+uint8_t RpConfig::readImageByte(uint32_t mem_address)
+{
+    return this->image[mem_address];
+}
+
+/**
+ * @brief Same byte order as Eeprom24LC32::readInt32(): most significant byte first
+ *
+ * @param mem_address
+ * @return uint32_t
+ */
+uint32_t RpConfig::readImageInt32(uint32_t mem_address)
+{
+    uint8_t *bytes = &this->image[mem_address];
+    return ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) | ((uint32_t)bytes[2] << 8) | bytes[3];
+}
+
+void RpConfig::writeImageByte(uint32_t mem_address, uint8_t value)
+{
+    if (this->image[mem_address] == value)
+    {
+        return;
+    }
+    this->image[mem_address] = value;
+    this->markDirty(mem_address, 1);
+}
+
+void RpConfig::writeImageInt32(uint32_t mem_address, uint32_t value)
+{
+    uint8_t bytes[4];
+    bytes[0] = (value >> 24) & 0xFF;
+    bytes[1] = (value >> 16) & 0xFF;
+    bytes[2] = (value >> 8) & 0xFF;
+    bytes[3] = value & 0xFF;
+    if (memcmp(&this->image[mem_address], bytes, 4) == 0)
+    {
+        return;
+    }
+    memcpy(&this->image[mem_address], bytes, 4);
+    this->markDirty(mem_address, 4);
+}
+
+/**
+ * @brief Extend the dirty ranges of the pages touched by the bytes. Ranges only grow, one write per page covers
+ * all changes in between
+ *
+ * @param mem_address
+ * @param length
+ */
+void RpConfig::markDirty(uint32_t mem_address, uint8_t length)
+{
+    if (this->dirty_pages == 0)
+    {
+        this->dirty_since_us = time_us_32();
+    }
+    for (uint32_t address = mem_address; address < mem_address + length; address++)
+    {
+        uint8_t page_index = address / CONFIG_IMAGE_PAGE_SIZE;
+        uint8_t offset = address % CONFIG_IMAGE_PAGE_SIZE;
+        config_dirty_range_t *range = &this->dirty_range[page_index];
+        if (!BIT_ISSET(this->dirty_pages, page_index))
+        {
+            BIT_SET(this->dirty_pages, page_index);
+            range->first = offset;
+            range->last = offset;
+        }
+        else if (offset < range->first)
+        {
+            range->first = offset;
+        }
+        else if (offset > range->last)
+        {
+            range->last = offset;
+        }
+    }
+}
+
+/**
+ * @brief A page was written, keeps the flush statistics
+ *
+ * @param page_index
+ */
+void RpConfig::clearDirty(uint8_t page_index)
+{
+    if (!BIT_ISSET(this->dirty_pages, page_index))
+    {
+        return;
+    }
+    BIT_CLR(this->dirty_pages, page_index);
+    this->flush_page_writes++;
+    if (this->dirty_pages == 0)
+    {
+        uint32_t latency_us = time_us_32() - this->dirty_since_us;
+        if (latency_us > this->flush_latency_max_us)
+        {
+            this->flush_latency_max_us = latency_us;
+        }
+    }
+}
+
+/**
+ * @brief Scan the whole journal for the valid entry with the highest sequence number and take the runtime state
+ * from it. An entry torn by a power loss fails the crc and the one before it wins. Without any valid entry the
+ * state comes from the fixed addresses
+ *
+ */
+void RpConfig::recoverJournal()
+{
+    uint32_t start_us = time_us_32();
+    uint8_t chunk[JOURNAL_SCAN_CHUNK];
+    this->journal_sequence = 0;
+    this->journal_next_slot = 0;
+    for (uint32_t offset = 0; offset < JOURNAL_SIZE; offset += JOURNAL_SCAN_CHUNK)
+    {
+        this->storage->read(JOURNAL_ADDRESS + offset, chunk, JOURNAL_SCAN_CHUNK);
+        for (uint32_t entry_offset = 0; entry_offset < JOURNAL_SCAN_CHUNK; entry_offset += JOURNAL_ENTRY_SIZE)
+        {
+            uint8_t *entry = &chunk[entry_offset];
+            uint16_t crc = (entry[JOURNAL_OFFSET_CRC] << 8) | entry[JOURNAL_OFFSET_CRC + 1];
+            if (entry[0] != JOURNAL_ENTRY_MARKER || RpConfig::crc16(entry, JOURNAL_OFFSET_CRC) != crc)
+            {
+                continue;
+            }
+            uint8_t *sequence_bytes = &entry[JOURNAL_OFFSET_SEQUENCE];
+            uint32_t sequence = ((uint32_t)sequence_bytes[0] << 24) | ((uint32_t)sequence_bytes[1] << 16) | ((uint32_t)sequence_bytes[2] << 8) | sequence_bytes[3];
+            if (sequence <= this->journal_sequence)
+            {
+                continue;
+            }
+            this->journal_sequence = sequence;
+            this->journal_next_slot = ((offset + entry_offset) / JOURNAL_ENTRY_SIZE + 1) % JOURNAL_ENTRY_COUNT;
+            memcpy(this->runtime_state.button_value, &entry[JOURNAL_OFFSET_BUTTON_VALUES], RUNTIME_STATE_BUTTON_COUNT);
+            this->runtime_state.controller_status = (entry[JOURNAL_OFFSET_CONTROLLER_STATUS] << 8) | entry[JOURNAL_OFFSET_CONTROLLER_STATUS + 1];
+        }
+    }
+    if (this->journal_sequence == 0)
+    {
+        this->resetRuntimeState();
+        // Nothing to save until the state changes
+        this->runtime_state_pending = false;
+    }
+    this->journal_recover_us = time_us_32() - start_us;
+}
+
+/**
+ * @brief Write the runtime state as the next journal entry, over the oldest one
+ *
+ * @param blocking wait for the EEPROM, otherwise give up while it is busy
+ * @return true entry written
+ * @return false EEPROM busy, still pending
+ */
+bool RpConfig::appendJournalEntry(bool blocking)
+{
+    uint8_t entry[JOURNAL_ENTRY_SIZE];
+    uint32_t sequence = this->journal_sequence + 1;
+    entry[0] = JOURNAL_ENTRY_MARKER;
+    entry[JOURNAL_OFFSET_SEQUENCE] = (sequence >> 24) & 0xFF;
+    entry[JOURNAL_OFFSET_SEQUENCE + 1] = (sequence >> 16) & 0xFF;
+    entry[JOURNAL_OFFSET_SEQUENCE + 2] = (sequence >> 8) & 0xFF;
+    entry[JOURNAL_OFFSET_SEQUENCE + 3] = sequence & 0xFF;
+    memcpy(&entry[JOURNAL_OFFSET_BUTTON_VALUES], this->runtime_state.button_value, RUNTIME_STATE_BUTTON_COUNT);
+    entry[JOURNAL_OFFSET_CONTROLLER_STATUS] = (this->runtime_state.controller_status >> 8) & 0xFF;
+    entry[JOURNAL_OFFSET_CONTROLLER_STATUS + 1] = this->runtime_state.controller_status & 0xFF;
+    entry[JOURNAL_OFFSET_CRC - 1] = 0x00;
+    uint16_t crc = RpConfig::crc16(entry, JOURNAL_OFFSET_CRC);
+    entry[JOURNAL_OFFSET_CRC] = (crc >> 8) & 0xFF;
+    entry[JOURNAL_OFFSET_CRC + 1] = crc & 0xFF;
+
+    uint32_t mem_address = JOURNAL_ADDRESS + this->journal_next_slot * JOURNAL_ENTRY_SIZE;
+    if (blocking)
+    {
+        this->storage->write(mem_address, entry, JOURNAL_ENTRY_SIZE);
+    }
+    else if (!this->storage->startWrite(mem_address, entry, JOURNAL_ENTRY_SIZE))
+    {
+        return false;
+    }
+    this->journal_sequence = sequence;
+    this->journal_next_slot = (this->journal_next_slot + 1) % JOURNAL_ENTRY_COUNT;
+    this->journal_last_append_us = time_us_32();
+    this->journal_appends++;
+    this->runtime_state_pending = false;
+    return true;
 }
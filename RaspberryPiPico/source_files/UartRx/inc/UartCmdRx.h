@@ -0,0 +1,57 @@
+#ifndef __UART_CMD_RX_H__
+#define __UART_CMD_RX_H__
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/uart.h"
+#include "RemoteCmdEngine.h"
+
+#define UART_CMD_RX_FORWARD_RING_BITS 8 // Bytes waiting for room in the TX FIFO of the forward UART
+#define UART_CMD_RX_FORWARD_RING_SIZE (1 << UART_CMD_RX_FORWARD_RING_BITS)
+#define UART_CMD_RX_FORWARD_RING_MASK (UART_CMD_RX_FORWARD_RING_SIZE - 1)
+
+/**
+ * @brief Interrupt driven receiver for the commands from the Pi. The RX interrupt of the input UART empties the
+ * hardware FIFO, forwards every byte to the next board and feeds it to the command engine, which frames the
+ * commands addressed to this board. The main loop only executes complete commands with the engine, a slow ADC pass
+ * no longer overflows the 32 byte RX FIFO.
+ *
+ * Forwarded bytes go straight into the TX FIFO of the forward UART. Both links run at the same rate, so it only
+ * fills up during a rate switch: the bytes wait in a ring then and the TX interrupt sends them.
+ *
+ * onRxIrq() and onTxIrq() have to run on the core that calls RemoteCmdEngine::execute(), at the same priority.
+ *
+ */
+class UartCmdRx
+{
+protected:
+    uart_inst_t *uart_in;
+    uart_inst_t *uart_forward;
+    RemoteCmdEngine *engine;
+
+    uint8_t forward_ring[UART_CMD_RX_FORWARD_RING_SIZE];
+    uint16_t forward_head = 0;
+    uint16_t forward_tail = 0;
+
+    // Statistics
+    uint32_t received_count = 0;
+    uint32_t overrun_count = 0;
+    uint32_t forward_drop_count = 0;
+    uint16_t forward_high_water = 0;
+
+    void forward(uint8_t c);
+
+public:
+    UartCmdRx(uart_inst_t *uart_in, uart_inst_t *uart_forward, RemoteCmdEngine *engine);
+    void init();
+    void onRxIrq();
+    void onTxIrq();
+    uint32_t getReceivedCount();
+    uint32_t getOverrunCount();
+    uint32_t getForwardDropCount();
+    uint16_t getForwardHighWater();
+};
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef __UART_RX_RING_H__
+#define __UART_RX_RING_H__
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/uart.h"
+#include "hardware/dma.h"
+
+#define UART_RX_RING_BITS 10 // 2^10 bytes, 27ms of line time at 380400 baud
+#define UART_RX_RING_SIZE (1 << UART_RX_RING_BITS)
+#define UART_RX_RING_MASK (UART_RX_RING_SIZE - 1)
+
+/**
+ * @brief Receive ring buffer for one UART, filled by DMA. Two chained DMA channels each fill the ring once and
+ * trigger each other, so the UART RX FIFO is emptied forever without CPU involvement. The owner reads the bytes
+ * with read() at its own pace.
+ *
+ * Completed passes over the ring are counted whenever the other DMA channel turns busy, which gives a free running
+ * count of received bytes. If the DMA got more than a whole ring ahead of the reader, the overwritten bytes are
+ * skipped and counted as lost. This needs available() or read() to be called at least once per ring pass.
+ *
+ * Only one core may call read().
+ *
+ */
+class UartRxRing
+{
+protected:
+    uart_inst_t *uart;
+    uint dma_channel_a;
+    uint dma_channel_b;
+    uint8_t *buffer;
+    uint32_t read_total = 0;    // Bytes read, free running
+    uint32_t written_total = 0; // Bytes written by the DMA as of the last update(), free running
+    uint32_t ring_passes = 0;   // Completed DMA transfers over the whole ring
+    uint last_busy_channel;
+
+    // Statistics
+    uint32_t high_water = 0;
+    uint32_t overrun_count = 0;
+    uint32_t lost_bytes = 0;
+
+    void update();
+
+public:
+    UartRxRing(uart_inst_t *uart);
+    void init();
+    uint32_t available();
+    bool read(uint8_t *c);
+    uint32_t getHighWater();
+    uint32_t getOverrunCount();
+    uint32_t getLostBytes();
+    void resetStatistics();
+};
+
+#endif
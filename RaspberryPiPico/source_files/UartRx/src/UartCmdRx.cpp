@@ -0,0 +1,120 @@
+#include "UartCmdRx.h"
+
+/**
+ * @brief
+ *
+ * @param uart_in link towards the Pi
+ * @param uart_forward link to the previous board, gets every received byte
+ * @param engine frames the commands for this board
+ */
+UartCmdRx::UartCmdRx(uart_inst_t *uart_in, uart_inst_t *uart_forward, RemoteCmdEngine *engine)
+{
+    this->uart_in = uart_in;
+    this->uart_forward = uart_forward;
+    this->engine = engine;
+}
+
+/**
+ * @brief Enable the RX interrupts of the input UART. Both UARTs have to be initialized already, the interrupt
+ * handlers are installed by the caller
+ *
+ */
+void UartCmdRx::init()
+{
+    uart_hw_t *hw = uart_get_hw(this->uart_in);
+    // Interrupt at 1/4 full (8 bytes), the receive timeout catches the rest of a command
+    hw_write_masked(&hw->ifls, 1 << UART_UARTIFLS_RXIFLSEL_LSB, UART_UARTIFLS_RXIFLSEL_BITS);
+    hw->icr = UART_UARTICR_RXIC_BITS | UART_UARTICR_RTIC_BITS;
+    hw_set_bits(&hw->imsc, UART_UARTIMSC_RXIM_BITS | UART_UARTIMSC_RTIM_BITS);
+}
+
+/**
+ * @brief RX interrupt of the input UART: empty the FIFO
+ *
+ */
+void UartCmdRx::onRxIrq()
+{
+    uart_hw_t *hw = uart_get_hw(this->uart_in);
+    while (!(hw->fr & UART_UARTFR_RXFE_BITS))
+    {
+        uint32_t data = hw->dr;
+        if (data & UART_UARTDR_OE_BITS)
+        {
+            // The FIFO was full: bytes before this one are lost
+            this->overrun_count++;
+        }
+        uint8_t c = (uint8_t)data;
+        this->received_count++;
+        this->forward(c);
+        this->engine->feed(c);
+    }
+}
+
+/**
+ * @brief TX interrupt of the forward UART: send the bytes that did not fit into its FIFO
+ *
+ */
+void UartCmdRx::onTxIrq()
+{
+    uart_hw_t *hw = uart_get_hw(this->uart_forward);
+    while (this->forward_tail != this->forward_head && !(hw->fr & UART_UARTFR_TXFF_BITS))
+    {
+        hw->dr = this->forward_ring[this->forward_tail];
+        this->forward_tail = (this->forward_tail + 1) & UART_CMD_RX_FORWARD_RING_MASK;
+    }
+    if (this->forward_tail == this->forward_head)
+    {
+        hw_clear_bits(&hw->imsc, UART_UARTIMSC_TXIM_BITS);
+    }
+}
+
+uint32_t UartCmdRx::getReceivedCount()
+{
+    return this->received_count;
+}
+
+/**
+ * @brief RX FIFO overruns: each one lost at least one byte
+ *
+ * @return uint32_t
+ */
+uint32_t UartCmdRx::getOverrunCount()
+{
+    return this->overrun_count;
+}
+
+uint32_t UartCmdRx::getForwardDropCount()
+{
+    return this->forward_drop_count;
+}
+
+uint16_t UartCmdRx::getForwardHighWater()
+{
+    return this->forward_high_water;
+}
+
+// Protected Methods
+
+void UartCmdRx::forward(uint8_t c)
+{
+    uart_hw_t *hw = uart_get_hw(this->uart_forward);
+    if (this->forward_tail == this->forward_head && !(hw->fr & UART_UARTFR_TXFF_BITS))
+    {
+        hw->dr = c;
+        return;
+    }
+    uint16_t next_head = (this->forward_head + 1) & UART_CMD_RX_FORWARD_RING_MASK;
+    if (next_head == this->forward_tail)
+    {
+        this->forward_drop_count++;
+        return;
+    }
+    this->forward_ring[this->forward_head] = c;
+    this->forward_head = next_head;
+    uint16_t used = (this->forward_head - this->forward_tail) & UART_CMD_RX_FORWARD_RING_MASK;
+    if (used > this->forward_high_water)
+    {
+        this->forward_high_water = used;
+    }
+    hw_set_bits(&hw->imsc, UART_UARTIMSC_TXIM_BITS);
+}
@@ -0,0 +1,149 @@
+#include "UartRxRing.h"
+
+// DMA ring buffers have to be aligned to their size. One ring per UART
+static uint8_t uart_rx_ring_buffer[2][UART_RX_RING_SIZE] __attribute__((aligned(UART_RX_RING_SIZE)));
+
+UartRxRing::UartRxRing(uart_inst_t *uart)
+{
+    this->uart = uart;
+    this->buffer = uart_rx_ring_buffer[uart_get_index(uart)];
+}
+
+/**
+ * @brief Claim and start the DMA channels. The UART has to be initialized already
+ *
+ */
+void UartRxRing::init()
+{
+    this->dma_channel_a = dma_claim_unused_channel(true);
+    this->dma_channel_b = dma_claim_unused_channel(true);
+    uint channels[2] = {this->dma_channel_a, this->dma_channel_b};
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        dma_channel_config config = dma_channel_get_default_config(channels[i]);
+        channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+        channel_config_set_read_increment(&config, false);
+        channel_config_set_write_increment(&config, true);
+        channel_config_set_ring(&config, true, UART_RX_RING_BITS);
+        channel_config_set_dreq(&config, uart_get_dreq(this->uart, false));
+        channel_config_set_chain_to(&config, channels[i ^ 0x01]);
+        dma_channel_configure(channels[i], &config, this->buffer, &uart_get_hw(this->uart)->dr, UART_RX_RING_SIZE, false);
+    }
+    this->read_total = 0;
+    this->written_total = 0;
+    this->ring_passes = 0;
+    this->last_busy_channel = this->dma_channel_a;
+    dma_channel_start(this->dma_channel_a);
+}
+
+/**
+ * @brief Bytes received and not read yet
+ *
+ * @return uint32_t
+ */
+uint32_t UartRxRing::available()
+{
+    this->update();
+    return this->written_total - this->read_total;
+}
+
+/**
+ * @brief Take the next received byte
+ *
+ * @param c
+ * @return true
+ * @return false nothing received
+ */
+bool UartRxRing::read(uint8_t *c)
+{
+    uint32_t used = this->available();
+    if (used == 0)
+    {
+        return false;
+    }
+    if (used > this->high_water)
+    {
+        this->high_water = used;
+    }
+    *c = this->buffer[this->read_total & UART_RX_RING_MASK];
+    this->read_total++;
+    return true;
+}
+
+/**
+ * @brief Highest number of unread bytes since the last resetStatistics(). Close to UART_RX_RING_SIZE means bytes
+ * may have been overwritten before they were read
+ *
+ * @return uint32_t
+ */
+uint32_t UartRxRing::getHighWater()
+{
+    return this->high_water;
+}
+
+/**
+ * @brief Number of times the DMA overwrote bytes that were not read yet
+ *
+ * @return uint32_t
+ */
+uint32_t UartRxRing::getOverrunCount()
+{
+    return this->overrun_count;
+}
+
+uint32_t UartRxRing::getLostBytes()
+{
+    return this->lost_bytes;
+}
+
+void UartRxRing::resetStatistics()
+{
+    this->high_water = 0;
+}
+
+// Protected Methods
+
+/**
+ * @brief Advance the received byte count from the DMA write address and skip overwritten bytes
+ *
+ */
+void UartRxRing::update()
+{
+    uint channel;
+    uint32_t index;
+    while (true)
+    {
+        bool a_busy = dma_channel_is_busy(this->dma_channel_a);
+        if (!a_busy && !dma_channel_is_busy(this->dma_channel_b))
+        {
+            // Between the end of one channel and the chained start of the other: the ring was just filled
+            channel = (this->last_busy_channel == this->dma_channel_a) ? this->dma_channel_b : this->dma_channel_a;
+            index = 0;
+            break;
+        }
+        channel = a_busy ? this->dma_channel_a : this->dma_channel_b;
+        uint32_t write_addr = dma_hw->ch[channel].write_addr;
+        // Busy before and after the read: the address is not one that already wrapped at the end of the ring
+        if (dma_channel_is_busy(channel))
+        {
+            index = (write_addr - (uint32_t)(uintptr_t)this->buffer) & UART_RX_RING_MASK;
+            break;
+        }
+    }
+    if (channel != this->last_busy_channel)
+    {
+        // The other channel took over: the ring was filled once more
+        this->last_busy_channel = channel;
+        this->ring_passes++;
+    }
+    this->written_total = this->ring_passes * UART_RX_RING_SIZE + index;
+
+    uint32_t used = this->written_total - this->read_total;
+    if (used > UART_RX_RING_SIZE)
+    {
+        // Overrun: continue with the oldest byte that is still intact. The packet parsers resync on the next status byte
+        this->overrun_count++;
+        this->lost_bytes += used - UART_RX_RING_SIZE;
+        this->read_total = this->written_total - UART_RX_RING_SIZE;
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef __UART_TX_RING_H__
+#define __UART_TX_RING_H__
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/uart.h"
+#include "hardware/dma.h"
+
+#define UART_TX_RING_BITS 10 // 2^10 bytes = 256 packets, 27ms of line time at 380400 baud
+#define UART_TX_RING_SIZE (1 << UART_TX_RING_BITS)
+#define UART_TX_RING_MASK (UART_TX_RING_SIZE - 1)
+
+/**
+ * @brief Transmit ring buffer for one UART, drained by DMA. write() copies the bytes into the ring and returns,
+ * service() hands the pending bytes to the DMA whenever the previous transfer finished. The DMA read address
+ * wraps at the ring size, so one transfer covers the pending bytes even across the end of the buffer.
+ *
+ * Only the core that owns the UART may call write() and service().
+ *
+ */
+class UartTxRing
+{
+protected:
+    uart_inst_t *uart;
+    uint dma_channel;
+    uint8_t *buffer;
+    uint32_t head = 0;      // Next byte to write, free running
+    uint32_t tail = 0;      // First byte not yet sent completely, free running
+    uint32_t in_flight = 0; // Bytes of the running DMA transfer
+
+    // Statistics
+    uint32_t high_water = 0;
+    uint32_t stall_count = 0;
+    uint32_t stall_us = 0;
+    uint32_t stall_max_us = 0;
+
+public:
+    UartTxRing(uart_inst_t *uart);
+    void init();
+    void service();
+    bool write(const uint8_t *data, uint32_t length);
+    uint32_t getFree();
+    uint32_t getUsed();
+    uint32_t getHighWater();
+    uint32_t getStallCount();
+    uint32_t getStallUs();
+    uint32_t getStallMaxUs();
+    void resetStatistics();
+};
+
+#endif
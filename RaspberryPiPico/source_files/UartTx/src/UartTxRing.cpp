@@ -0,0 +1,139 @@
+#include "UartTxRing.h"
+
+// DMA ring buffers have to be aligned to their size. One ring per UART
+static uint8_t uart_tx_ring_buffer[2][UART_TX_RING_SIZE] __attribute__((aligned(UART_TX_RING_SIZE)));
+
+UartTxRing::UartTxRing(uart_inst_t *uart)
+{
+    this->uart = uart;
+    this->buffer = uart_tx_ring_buffer[uart_get_index(uart)];
+}
+
+/**
+ * @brief Claim and configure the DMA channel. The UART has to be initialized already
+ *
+ */
+void UartTxRing::init()
+{
+    this->dma_channel = dma_claim_unused_channel(true);
+    dma_channel_config config = dma_channel_get_default_config(this->dma_channel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+    channel_config_set_read_increment(&config, true);
+    channel_config_set_write_increment(&config, false);
+    channel_config_set_ring(&config, false, UART_TX_RING_BITS);
+    channel_config_set_dreq(&config, uart_get_dreq(this->uart, true));
+    dma_channel_configure(this->dma_channel, &config, &uart_get_hw(this->uart)->dr, this->buffer, 0, false);
+}
+
+/**
+ * @brief Release the bytes of a finished transfer and start the next one. Call it from the main loop of the core
+ *
+ */
+void UartTxRing::service()
+{
+    if (this->in_flight > 0)
+    {
+        if (dma_channel_is_busy(this->dma_channel))
+        {
+            return;
+        }
+        this->tail += this->in_flight;
+        this->in_flight = 0;
+    }
+    uint32_t pending = this->head - this->tail;
+    if (pending > 0)
+    {
+        this->in_flight = pending;
+        dma_channel_transfer_from_buffer_now(this->dma_channel, &this->buffer[this->tail & UART_TX_RING_MASK], pending);
+    }
+}
+
+/**
+ * @brief Append bytes to the ring. Stalls only when the ring is full, the stall time is counted
+ *
+ * @param data
+ * @param length <= UART_TX_RING_SIZE
+ * @return true
+ * @return false length does not fit into the ring
+ */
+bool UartTxRing::write(const uint8_t *data, uint32_t length)
+{
+    if (length > UART_TX_RING_SIZE)
+    {
+        return false;
+    }
+    if (this->getFree() < length)
+    {
+        uint32_t stall_start = time_us_32();
+        while (this->getFree() < length)
+        {
+            this->service();
+        }
+        uint32_t stall = time_us_32() - stall_start;
+        this->stall_count++;
+        this->stall_us += stall;
+        if (stall > this->stall_max_us)
+        {
+            this->stall_max_us = stall;
+        }
+    }
+    for (uint32_t i = 0; i < length; i++)
+    {
+        this->buffer[(this->head + i) & UART_TX_RING_MASK] = data[i];
+    }
+    this->head += length;
+    if (this->getUsed() > this->high_water)
+    {
+        this->high_water = this->getUsed();
+    }
+    this->service();
+    return true;
+}
+
+uint32_t UartTxRing::getFree()
+{
+    return UART_TX_RING_SIZE - (this->head - this->tail);
+}
+
+uint32_t UartTxRing::getUsed()
+{
+    return this->head - this->tail;
+}
+
+/**
+ * @brief Highest ring occupancy in bytes since the last resetStatistics()
+ *
+ * @return uint32_t
+ */
+uint32_t UartTxRing::getHighWater()
+{
+    return this->high_water;
+}
+
+/**
+ * @brief Number of write() calls that had to wait for free space
+ *
+ * @return uint32_t
+ */
+uint32_t UartTxRing::getStallCount()
+{
+    return this->stall_count;
+}
+
+uint32_t UartTxRing::getStallUs()
+{
+    return this->stall_us;
+}
+
+uint32_t UartTxRing::getStallMaxUs()
+{
+    return this->stall_max_us;
+}
+
+void UartTxRing::resetStatistics()
+{
+    this->high_water = this->getUsed();
+    this->stall_count = 0;
+    this->stall_us = 0;
+    this->stall_max_us = 0;
+}
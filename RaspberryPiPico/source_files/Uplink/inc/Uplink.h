@@ -0,0 +1,122 @@
+#ifndef __UPLINK_H__
+#define __UPLINK_H__
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "pico/util/queue.h"
+#include "DataFormatter.h"
+#include "ValueMailbox.h"
+#include "UartTxRing.h"
+#include "UartRxRing.h"
+#include "RemoteCmdEngine.h"
+
+// Deficit round-robin weights in bytes per round. The forwarded traffic gets the larger share, it carries the
+// packets of all boards further down the chain
+#define UPLINK_LOCAL_QUANTUM 8    // 2 local legacy packets per round
+#define UPLINK_FORWARD_QUANTUM 16 // 4 forwarded legacy packets per round
+// New packets are only scheduled while less than this waits in the TX ring. Keeps the queueing delay of the
+// ring, and with it the worst case forwarding latency, at 64 byte times (1.7ms at 380400 baud)
+#define UPLINK_TX_BACKLOG_MAX 64
+#define UPLINK_FORWARD_TIMEOUT_US 500 // A forwarded packet is given up when no byte arrives for ~19 byte times
+// Multicast acks waiting to be merged with the acks of the boards further down the chain
+#define UPLINK_ACK_SLOTS 4
+#define UPLINK_ACK_HOLD_US 20000 // Longest wait for missing acks, per board on the way
+
+typedef struct
+{
+    bool pending;
+    bool local; // The ack of this board is merged
+    uint8_t seq;
+    uint16_t mask; // Acknowledging boards
+    uint32_t start_us;
+} uplink_ack_t;
+
+/**
+ * @brief Upstream traffic of core1. Local packets (button queue and knob mailbox) and packets forwarded from the
+ * previous board share uart0 by deficit round-robin: every round each source gets its quantum of bytes added to
+ * its deficit and may send whole packets as long as the deficit lasts. A source without pending packets loses
+ * its deficit. Forwarded packets are sent cut-through, byte by byte as they arrive, and are always finished
+ * before a local packet may follow.
+ *
+ * Forwarded messages are parsed in the compact format, which covers legacy packets as well, and are passed on
+ * in the wire format of this board: the status byte is inserted where the running status of uart0 needs it,
+ * short messages are expanded to packets on a legacy line. Batch frames are relayed unchanged on a batch line,
+ * single messages get a frame of their own there. On the other lines the messages of a batch frame are sent
+ * like messages under running status.
+ *
+ * Multicast acks (controller REMOTE_CMD_ACK_CONTROLLER) of this board and of the boards further down are merged
+ * per sequence number: the board masks are ORed and sent on as one ack per mask group, once every board seen on
+ * uart1 and this board have answered or after UPLINK_ACK_HOLD_US. Acks inside relayed batch frames with more than
+ * one message are forwarded unchanged.
+ *
+ */
+class Uplink
+{
+protected:
+    DataFormatter formatter;
+    queue_t *message_queue;
+    ValueMailbox *mailbox;
+    UartTxRing *tx_ring;
+    UartRxRing *rx_ring;
+
+    int32_t local_deficit = 0;
+    int32_t forward_deficit = 0;
+    volatile uint8_t wire_format = DATA_FORMATTER_WIRE_LEGACY;
+    uint8_t forward_status = 0x00;    // Running status of uart1, 0x00: unknown
+    uint8_t forward_remaining = 0;    // Data bytes still missing of the message being forwarded
+    bool forward_expand = false;      // Collecting a short message to send it as a legacy packet
+    uint8_t forward_short_first = 0;
+    bool forward_batch_header = false; // Batch frame status received, the count byte is next
+    uint8_t forward_batch_left = 0;    // Messages still missing of the batch frame being received
+    bool forward_frame_open = false;   // A relayed batch frame header is on the line, its messages have to follow
+    uint32_t forward_last_us = 0;
+    bool forward_frame_header_due = false; // The relayed batch frame header is written with its first message
+    bool forward_absorb = false;           // Collecting a multicast ack to merge it
+    uint8_t forward_ack_lsb = 0;
+    uint16_t downstream_boards = 0; // Board indices seen on uart1 (bit mask)
+    uplink_ack_t acks[UPLINK_ACK_SLOTS];
+    uint8_t board_index;
+
+    // Statistics per source
+    uint32_t local_sent = 0;
+    uint32_t forward_sent = 0;
+    uint32_t forward_truncated = 0;
+    uint32_t ack_merged = 0;
+    uint32_t ack_sent = 0;
+    uint32_t ack_dropped = 0;
+    volatile uint32_t round_max_us = 0;
+    uint32_t round_start_us = 0;
+
+    bool takeLocal(queue_entry_t *entry);
+    void serviceLocal();
+    void serviceLocalBatch();
+    void serviceForward();
+    bool isForwarding();
+    void forwardMessageDone();
+    void truncateForward();
+    void mergeAck(uint16_t ack_value, bool local);
+    void serviceAcks();
+    void sendAck(uplink_ack_t *ack);
+
+public:
+    Uplink(uint8_t board_index, queue_t *message_queue, ValueMailbox *mailbox, UartTxRing *tx_ring, UartRxRing *rx_ring);
+    void service();
+    void setWireFormat(uint8_t wire_format);
+    UartTxRing *getTxRing();
+    UartRxRing *getRxRing();
+    uint32_t getLocalSent();
+    uint32_t getLocalDropped();
+    uint32_t getForwardSent();
+    uint32_t getForwardTruncated();
+    uint32_t getForwardOverruns();
+    uint32_t getForwardLostBytes();
+    uint32_t getAckMerged();
+    uint32_t getAckSent();
+    uint32_t getAckDropped();
+    uint32_t getRoundMaxUs();
+    void resetRoundMax();
+};
+
+#endif
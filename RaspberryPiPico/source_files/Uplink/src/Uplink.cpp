@@ -0,0 +1,553 @@
+#include "Uplink.h"
+
+Uplink::Uplink(uint8_t board_index, queue_t *message_queue, ValueMailbox *mailbox, UartTxRing *tx_ring, UartRxRing *rx_ring)
+    : formatter(board_index)
+{
+    this->board_index = board_index;
+    this->message_queue = message_queue;
+    this->mailbox = mailbox;
+    this->tx_ring = tx_ring;
+    this->rx_ring = rx_ring;
+    this->round_start_us = time_us_32();
+    for (uint8_t i = 0; i < UPLINK_ACK_SLOTS; i++)
+    {
+        this->acks[i].pending = false;
+    }
+}
+
+/**
+ * @brief One round of the scheduler. Call it from the main loop of core1
+ *
+ */
+void Uplink::service()
+{
+    this->tx_ring->service();
+
+    uint32_t now_us = time_us_32();
+    uint32_t round_us = now_us - this->round_start_us;
+    this->round_start_us = now_us;
+    if (round_us > this->round_max_us)
+    {
+        this->round_max_us = round_us;
+    }
+
+    // The line is busy: leave the packets in their sources instead of queueing them in the TX ring.
+    // A forwarded message that already started has to be finished though
+    bool forwarding = this->isForwarding();
+    if (this->tx_ring->getUsed() >= UPLINK_TX_BACKLOG_MAX && !forwarding)
+    {
+        return;
+    }
+    if (!forwarding)
+    {
+        // Switch the wire format between two messages only
+        this->formatter.setWireFormat(this->wire_format);
+        this->serviceAcks();
+    }
+    if (this->formatter.getWireFormat() == DATA_FORMATTER_WIRE_BATCH)
+    {
+        this->serviceLocalBatch();
+    }
+    else
+    {
+        this->serviceLocal();
+    }
+    this->serviceForward();
+}
+
+/**
+ * @brief Wire format of uart0, see DataFormatter. Takes effect at the next message boundary. Safe to call from core0
+ *
+ * @param wire_format DATA_FORMATTER_WIRE_LEGACY, DATA_FORMATTER_WIRE_COMPACT or DATA_FORMATTER_WIRE_BATCH
+ */
+void Uplink::setWireFormat(uint8_t wire_format)
+{
+    this->wire_format = wire_format;
+}
+
+UartTxRing *Uplink::getTxRing()
+{
+    return this->tx_ring;
+}
+
+UartRxRing *Uplink::getRxRing()
+{
+    return this->rx_ring;
+}
+
+uint32_t Uplink::getLocalSent()
+{
+    return this->local_sent;
+}
+
+/**
+ * @brief Local knob values that were replaced by a newer value before they were sent
+ *
+ * @return uint32_t
+ */
+uint32_t Uplink::getLocalDropped()
+{
+    return this->mailbox->getCoalescedCount();
+}
+
+uint32_t Uplink::getForwardSent()
+{
+    return this->forward_sent;
+}
+
+/**
+ * @brief Forwarded packets that were cut short, by a new status byte or by UPLINK_FORWARD_TIMEOUT_US
+ *
+ * @return uint32_t
+ */
+uint32_t Uplink::getForwardTruncated()
+{
+    return this->forward_truncated;
+}
+
+uint32_t Uplink::getForwardOverruns()
+{
+    return this->rx_ring->getOverrunCount();
+}
+
+uint32_t Uplink::getForwardLostBytes()
+{
+    return this->rx_ring->getLostBytes();
+}
+
+/**
+ * @brief Multicast acks merged into a pending ack, local and forwarded
+ *
+ * @return uint32_t
+ */
+uint32_t Uplink::getAckMerged()
+{
+    return this->ack_merged;
+}
+
+/**
+ * @brief Ack messages sent upstream
+ *
+ * @return uint32_t
+ */
+uint32_t Uplink::getAckSent()
+{
+    return this->ack_sent;
+}
+
+/**
+ * @brief Acks lost because UPLINK_ACK_SLOTS sequence numbers were pending. The Pi repeats the command to the boards
+ *
+ * @return uint32_t
+ */
+uint32_t Uplink::getAckDropped()
+{
+    return this->ack_dropped;
+}
+
+/**
+ * @brief Longest scheduler round: upper bound of the time a source waits for its turn
+ *
+ * @return uint32_t
+ */
+uint32_t Uplink::getRoundMaxUs()
+{
+    return this->round_max_us;
+}
+
+void Uplink::resetRoundMax()
+{
+    this->round_max_us = 0;
+}
+
+// Protected Methods
+
+/**
+ * @brief Next local packet: button states first, every state change counts. Then the newest knob values.
+ * Multicast acks are not sent here, they wait for the acks from further down the chain
+ *
+ * @param entry
+ * @return true
+ * @return false nothing to send
+ */
+bool Uplink::takeLocal(queue_entry_t *entry)
+{
+    while (queue_try_remove(this->message_queue, entry))
+    {
+        if (entry->index != REMOTE_CMD_ACK_CONTROLLER)
+        {
+            return true;
+        }
+        this->mergeAck(entry->value, true);
+    }
+    return this->mailbox->take(entry);
+}
+
+void Uplink::serviceLocal()
+{
+    // Local packets must not end up in the middle of a forwarded packet
+    if (this->isForwarding())
+    {
+        return;
+    }
+    this->local_deficit += UPLINK_LOCAL_QUANTUM;
+    uint8_t formatted_data[DATA_FORMATTER_MAX_BYTES];
+    queue_entry_t entry;
+    // Messages differ in length: send while credit is left, an overdraft is taken from the next round
+    while (this->local_deficit > 0)
+    {
+        if (!this->takeLocal(&entry))
+        {
+            // Nothing pending: an idle source does not save up bandwidth
+            this->local_deficit = 0;
+            break;
+        }
+#ifdef DEBUG
+        printf("%d - %d\n", entry.index, entry.value);
+#endif
+        // Format to 'MIDI-like' bytes
+        uint8_t length = this->formatter.formatData(entry.index, entry.value, formatted_data);
+        this->tx_ring->write(formatted_data, length);
+        this->local_deficit -= length;
+        this->local_sent++;
+    }
+}
+
+/**
+ * @brief Batch format: everything pending goes into one frame, up to DATA_FORMATTER_BATCH_MAX messages. The frame is
+ * one packet for the round-robin: it may overdraw the deficit, the next rounds pay it back
+ *
+ */
+void Uplink::serviceLocalBatch()
+{
+    if (this->isForwarding())
+    {
+        return;
+    }
+    this->local_deficit += UPLINK_LOCAL_QUANTUM;
+    if (this->local_deficit <= 0)
+    {
+        return;
+    }
+    uint8_t frame[DATA_FORMATTER_BATCH_HEADER_BYTES + DATA_FORMATTER_BATCH_MAX * DATA_FORMATTER_MESSAGE_MAX_BYTES];
+    uint8_t length = DATA_FORMATTER_BATCH_HEADER_BYTES;
+    uint8_t count = 0;
+    queue_entry_t entry;
+    while (count < DATA_FORMATTER_BATCH_MAX && this->takeLocal(&entry))
+    {
+#ifdef DEBUG
+        printf("%d - %d\n", entry.index, entry.value);
+#endif
+        length += this->formatter.formatMessage(entry.index, entry.value, &frame[length]);
+        count++;
+    }
+    if (count == 0)
+    {
+        // Nothing pending: an idle source does not save up bandwidth
+        this->local_deficit = 0;
+        return;
+    }
+    this->formatter.formatBatchHeader(this->board_index, count, frame);
+    this->tx_ring->write(frame, length);
+    this->local_deficit -= length;
+    this->local_sent += count;
+}
+
+void Uplink::serviceForward()
+{
+    this->forward_deficit += UPLINK_FORWARD_QUANTUM;
+    bool batch_line = (this->formatter.getWireFormat() == DATA_FORMATTER_WIRE_BATCH);
+    uint8_t formatted_data[DATA_FORMATTER_MAX_BYTES];
+    uint8_t c;
+    // A started message or batch frame is always finished, the overdraft is taken from the next round
+    while ((this->forward_deficit > 0 || this->isForwarding()) && this->rx_ring->read(&c))
+    {
+        this->forward_last_us = time_us_32();
+        if (c & 0x80)
+        {
+            // Status byte: ends any message and batch frame. Only control change messages are forwarded
+            if (this->isForwarding())
+            {
+                this->truncateForward();
+            }
+            this->forward_batch_left = 0;
+            this->forward_batch_header = false;
+            if ((c & 0xf0) == MIDI_MASK_STAUS_CC)
+            {
+                this->forward_status = c;
+                this->downstream_boards |= 1 << (c & 0x0f);
+            }
+            else if ((c & 0xf0) == DATA_FORMATTER_STATUS_BATCH)
+            {
+                this->forward_status = MIDI_MASK_STAUS_CC | (c & 0x0f);
+                this->forward_batch_header = true;
+                this->downstream_boards |= 1 << (c & 0x0f);
+            }
+            else
+            {
+                this->forward_status = 0x00;
+            }
+            continue;
+        }
+        if (this->forward_batch_header)
+        {
+            // Count byte of a batch frame
+            this->forward_batch_header = false;
+            if (c == 0)
+            {
+                this->forward_status = 0x00;
+                continue;
+            }
+            this->forward_batch_left = c;
+            if (batch_line)
+            {
+                // Relay the frame unchanged, the header goes out with the first message
+                this->forward_frame_open = true;
+                this->forward_frame_header_due = true;
+            }
+            continue;
+        }
+        if (this->forward_remaining == 0)
+        {
+            if (this->forward_status == 0x00)
+            {
+                // Not part of a message
+                continue;
+            }
+            uint8_t length = DataFormatter::messageLength(c);
+            if (c == REMOTE_CMD_ACK_CONTROLLER && (!this->forward_frame_open || (this->forward_frame_header_due && this->forward_batch_left == 1)))
+            {
+                // Multicast ack alone or in a frame of its own: merge it instead of forwarding it
+                this->forward_frame_header_due = false;
+                this->forward_absorb = true;
+                this->forward_remaining = length - 1;
+                continue;
+            }
+            if (length == 2 && this->formatter.getWireFormat() == DATA_FORMATTER_WIRE_LEGACY)
+            {
+                // Short message on a legacy line: expand it to a packet once the value byte is here
+                this->forward_short_first = c;
+                this->forward_expand = true;
+                this->forward_remaining = 1;
+                continue;
+            }
+            uint8_t n = 0;
+            if (batch_line)
+            {
+                if (!this->forward_frame_open)
+                {
+                    // Message under running status: a frame of its own
+                    n = this->formatter.formatBatchHeader(this->forward_status & 0x0f, 1, formatted_data);
+                }
+                else if (this->forward_frame_header_due)
+                {
+                    n = this->formatter.formatBatchHeader(this->forward_status & 0x0f, this->forward_batch_left, formatted_data);
+                    this->forward_frame_header_due = false;
+                }
+            }
+            else
+            {
+                // Status byte first, if the next board needs it
+                n = this->formatter.formatStatus(this->forward_status, formatted_data);
+            }
+            formatted_data[n++] = c;
+            this->tx_ring->write(formatted_data, n);
+            this->forward_deficit -= n;
+            this->forward_remaining = length - 1;
+            continue;
+        }
+        if (this->forward_expand)
+        {
+            uint8_t n = this->formatter.formatStatus(this->forward_status, formatted_data);
+            formatted_data[n++] = this->forward_short_first & DATA_FORMATTER_SHORT_CC_MAX;
+            formatted_data[n++] = c;
+            formatted_data[n++] = (this->forward_short_first >> 4) & 0x03;
+            this->tx_ring->write(formatted_data, n);
+            this->forward_deficit -= n;
+            this->forward_expand = false;
+            this->forward_remaining = 0;
+            this->forwardMessageDone();
+            continue;
+        }
+        if (this->forward_absorb)
+        {
+            this->forward_remaining--;
+            if (this->forward_remaining > 0)
+            {
+                this->forward_ack_lsb = c;
+                continue;
+            }
+            this->forward_absorb = false;
+            this->mergeAck(this->forward_ack_lsb | (c << 7), false);
+            this->forwardMessageDone();
+            continue;
+        }
+        this->tx_ring->write(&c, 1);
+        this->forward_deficit--;
+        this->forward_remaining--;
+        if (this->forward_remaining == 0)
+        {
+            this->forwardMessageDone();
+        }
+    }
+    if (!this->isForwarding() && this->rx_ring->available() == 0)
+    {
+        this->forward_deficit = 0;
+    }
+    if (this->isForwarding() && (time_us_32() - this->forward_last_us) > UPLINK_FORWARD_TIMEOUT_US)
+    {
+        // The rest of the message never arrived, do not hold back the local packets any longer
+        this->truncateForward();
+    }
+}
+
+/**
+ * @brief A forwarded message or batch frame is partly on the line: nothing else may be sent in between
+ *
+ * @return true
+ * @return false
+ */
+bool Uplink::isForwarding()
+{
+    return this->forward_remaining > 0 || this->forward_batch_header || this->forward_frame_open;
+}
+
+void Uplink::forwardMessageDone()
+{
+    this->forward_sent++;
+    if (this->forward_batch_left > 0)
+    {
+        this->forward_batch_left--;
+        if (this->forward_batch_left == 0)
+        {
+            // There is no running status after a batch frame
+            this->forward_status = 0x00;
+            this->forward_frame_open = false;
+        }
+    }
+}
+
+/**
+ * @brief Give up the message or batch frame being forwarded. Part of it may be on the line already: the next board
+ * drops it when the next status byte arrives, so the status is sent again with the next message
+ *
+ */
+void Uplink::truncateForward()
+{
+    if (!this->forward_expand || this->forward_frame_open)
+    {
+        this->formatter.invalidateRunningStatus();
+    }
+    this->forward_expand = false;
+    this->forward_absorb = false;
+    this->forward_frame_header_due = false;
+    this->forward_remaining = 0;
+    this->forward_batch_header = false;
+    this->forward_batch_left = 0;
+    this->forward_frame_open = false;
+    this->forward_truncated++;
+}
+
+/**
+ * @brief Add an ack to the pending ack of its sequence number
+ *
+ * @param ack_value REMOTE_CMD_ACK_VALUE or a merged ack value of one mask group
+ * @param local ack of this board
+ */
+void Uplink::mergeAck(uint16_t ack_value, bool local)
+{
+    uint8_t seq = REMOTE_CMD_ACK_SEQ(ack_value);
+    uint16_t mask = REMOTE_CMD_ACK_MASK(ack_value);
+    uplink_ack_t *ack = NULL;
+    for (uint8_t i = 0; i < UPLINK_ACK_SLOTS; i++)
+    {
+        if (this->acks[i].pending && this->acks[i].seq == seq)
+        {
+            ack = &this->acks[i];
+            break;
+        }
+        if (!this->acks[i].pending && ack == NULL)
+        {
+            ack = &this->acks[i];
+        }
+    }
+    if (ack == NULL)
+    {
+        this->ack_dropped++;
+        return;
+    }
+    if (!ack->pending)
+    {
+        ack->pending = true;
+        ack->local = false;
+        ack->seq = seq;
+        ack->mask = 0;
+        ack->start_us = time_us_32();
+    }
+    ack->mask |= mask;
+    ack->local |= local;
+    if (!local)
+    {
+        this->downstream_boards |= mask;
+    }
+    this->ack_merged++;
+}
+
+/**
+ * @brief Send the pending acks that are complete or waited long enough. Only between two forwarded messages
+ *
+ */
+void Uplink::serviceAcks()
+{
+    uint32_t now_us = time_us_32();
+    for (uint8_t i = 0; i < UPLINK_ACK_SLOTS; i++)
+    {
+        uplink_ack_t *ack = &this->acks[i];
+        if (!ack->pending)
+        {
+            continue;
+        }
+        bool complete = ack->local && (ack->mask & this->downstream_boards) == this->downstream_boards;
+        if (complete || (now_us - ack->start_us) >= UPLINK_ACK_HOLD_US)
+        {
+            this->sendAck(ack);
+            ack->pending = false;
+        }
+    }
+}
+
+/**
+ * @brief One ack message per mask group with acknowledging boards. On a batch line each gets a frame of its own,
+ * so the next board can merge it
+ *
+ * @param ack
+ */
+void Uplink::sendAck(uplink_ack_t *ack)
+{
+    uint8_t data[3 * (DATA_FORMATTER_BATCH_HEADER_BYTES + DATA_FORMATTER_MESSAGE_MAX_BYTES)];
+    uint8_t length = 0;
+    bool batch_line = (this->formatter.getWireFormat() == DATA_FORMATTER_WIRE_BATCH);
+    for (uint8_t group = 0; group < 3; group++)
+    {
+        uint16_t bits = (ack->mask >> (group * REMOTE_CMD_MULTICAST_GROUP_SIZE)) & 0x7F;
+        if (bits == 0)
+        {
+            continue;
+        }
+        uint16_t value = (ack->seq << 9) | (group << 7) | bits;
+        if (batch_line)
+        {
+            length += this->formatter.formatBatchHeader(this->board_index, 1, &data[length]);
+            length += this->formatter.formatMessage(REMOTE_CMD_ACK_CONTROLLER, value, &data[length]);
+        }
+        else
+        {
+            length += this->formatter.formatData(REMOTE_CMD_ACK_CONTROLLER, value, &data[length]);
+        }
+        this->ack_sent++;
+    }
+    if (length > 0)
+    {
+        this->tx_ring->write(data, length);
+    }
+}
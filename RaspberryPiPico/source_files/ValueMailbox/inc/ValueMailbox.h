@@ -0,0 +1,62 @@
+#ifndef __VALUE_MAILBOX_H__
+#define __VALUE_MAILBOX_H__
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+#ifndef __BIT_MACROS__
+#define __BIT_MACROS__
+#define BIT_SET(BF, N) BF |= ((uint32_t)0x01 << N)
+#define BIT_CLR(BF, N) BF &= ~((uint32_t)0x01 << N)
+#define BIT_ISSET(BF, N) ((BF >> N) & 0x01)
+#define BIT_TGL(BF, N) BF ^= ((uint8_t)0x01 << N))
+#endif
+
+#ifndef __QUEUE_ENTRY_T__
+#define __QUEUE_ENTRY_T__
+typedef struct
+{
+    uint8_t index;
+    uint16_t value;
+} queue_entry_t;
+#endif
+
+#define VALUE_MAILBOX_SLOTS 32 // One slot per controller index, one bit per slot in the dirty bitmaps
+
+/**
+ * @brief Single producer / single consumer "latest value wins" mailbox with one slot per controller index.
+ * core0 writes the newest value of a controller with put(), core1 takes the newest value of every changed
+ * controller with take(). Neither side ever blocks: a value that was not taken yet is simply overwritten.
+ *
+ * The dirty bitmap is split in two words with one writer each, because the M0+ has no atomic read-modify-write
+ * across cores: the producer toggles a bit of 'published', the consumer toggles the same bit of 'consumed'.
+ * A slot is dirty while the bits differ.
+ *
+ */
+class ValueMailbox
+{
+protected:
+    volatile uint16_t value[VALUE_MAILBOX_SLOTS];
+    volatile uint32_t published = 0; // Written by the producer only
+    volatile uint32_t consumed = 0;  // Written by the consumer only
+    uint8_t next_slot = 0;           // Consumer: slot to look at first, keeps the drain order fair
+
+    // Statistics
+    volatile uint32_t put_count = 0;       // Written by the producer only
+    volatile uint32_t coalesced_count = 0; // Written by the producer only
+    uint32_t take_count = 0;
+
+public:
+    ValueMailbox();
+    void put(uint8_t index, uint16_t value);
+    bool take(queue_entry_t *entry);
+    bool isEmpty();
+    uint32_t getPutCount();
+    uint32_t getCoalescedCount();
+    uint32_t getTakeCount();
+};
+
+#endif
@@ -0,0 +1,89 @@
+#include "ValueMailbox.h"
+
+ValueMailbox::ValueMailbox()
+{
+    for (uint8_t i = 0; i < VALUE_MAILBOX_SLOTS; i++)
+    {
+        this->value[i] = 0;
+    }
+}
+
+/**
+ * @brief Producer: store the newest value of a controller and mark it dirty
+ *
+ * @param index controller index, < VALUE_MAILBOX_SLOTS
+ * @param value
+ */
+void ValueMailbox::put(uint8_t index, uint16_t value)
+{
+    uint32_t mask = (uint32_t)0x01 << index;
+    this->value[index] = value;
+    // The value has to be visible to the other core before the slot turns dirty
+    __dmb();
+    if (((this->published ^ this->consumed) & mask) == 0)
+    {
+        this->published = this->published ^ mask;
+    }
+    else
+    {
+        // Still dirty: the consumer has not taken the previous value, it gets the new one instead
+        this->coalesced_count++;
+    }
+    this->put_count++;
+}
+
+/**
+ * @brief Consumer: take the newest value of the next dirty controller
+ *
+ * @param entry
+ * @return true a value was taken
+ * @return false no controller changed
+ */
+bool ValueMailbox::take(queue_entry_t *entry)
+{
+    uint32_t dirty = this->published ^ this->consumed;
+    if (dirty == 0)
+    {
+        return false;
+    }
+    uint8_t index = this->next_slot;
+    while (!BIT_ISSET(dirty, index))
+    {
+        index = (index + 1) % VALUE_MAILBOX_SLOTS;
+    }
+    this->next_slot = (index + 1) % VALUE_MAILBOX_SLOTS;
+
+    // Clear the slot before reading the value: a put() after this point marks the slot dirty again,
+    // a put() before it only overwrites the value read below. Either way no value gets lost
+    this->consumed = this->consumed ^ ((uint32_t)0x01 << index);
+    __dmb();
+    entry->index = index;
+    entry->value = this->value[index];
+    this->take_count++;
+    return true;
+}
+
+bool ValueMailbox::isEmpty()
+{
+    return (this->published ^ this->consumed) == 0;
+}
+
+uint32_t ValueMailbox::getPutCount()
+{
+    return this->put_count;
+}
+
+/**
+ * @brief Values that were overwritten before core1 took them
+ *
+ * @return uint32_t
+ */
+uint32_t ValueMailbox::getCoalescedCount()
+{
+    return this->coalesced_count;
+}
+
+uint32_t ValueMailbox::getTakeCount()
+{
+    return this->take_count;
+}
@@ -0,0 +1,398 @@
+#include <stdlib.h>
+#include <string.h>
+#include "HostTest.h"
+#include "HostSdk.h"
+#include "HostAds1015.h"
+#include "I2cController.h"
+#include "ADS1X15.h"
+#include "AdcSampler.h"
+#include "AdcScheduler.h"
+#include "AdcSampleClock.h"
+
+#define ADC_TEST_BAUDRATE 400000
+#define ADC_TEST_LOOP_US 10 // Main loop pass, the simulated time between two service() calls
+#define ADC_TEST_RUN_US 1100000 // Longer than ADC_SAMPLER_RATE_WINDOW_US, so the sample rates get measured
+#define ADC_TEST_EEPROM_ADDRESS 0x50
+#define ADC_TEST_CLOCK_HZ 200
+#define ADC_TEST_STALL_US 50000 // Main loop blocked, e.g. by a config flush
+
+static const uint16_t test_input[4] = {100, 700, 1300, 1900};
+
+/**
+ * @brief One ADS1015 on its own bus, set up like adc_0 in RainPots.cpp
+ *
+ */
+struct AdcBench
+{
+    HostAds1015 device;
+    I2cController bus;
+    ADS1X15 adc;
+
+    AdcBench(i2c_inst_t *i2c, uint16_t data_rate = RATE_ADS1015_3300SPS) : bus(i2c, ADC_TEST_BAUDRATE, 0, 1, true), adc(&bus)
+    {
+        host_i2c_attach(i2c, ADS1X15_ADDRESS, &this->device);
+        this->bus.init();
+        this->adc.setGain(GAIN_TWOTHIRDS);
+        this->adc.setDataRate(data_rate);
+        for (uint8_t i = 0; i < 4; i++)
+        {
+            this->device.input[i] = test_input[i];
+        }
+    }
+};
+
+/**
+ * @brief Every channel holds the oversampled value of its own input: no result was assigned to the wrong channel
+ *
+ */
+static bool samplesMatchInputs(AdcSampler &sampler)
+{
+    bool match = true;
+    for (uint8_t i = 0; i < ADC_SAMPLER_CHANNEL_COUNT; i++)
+    {
+        match = match && sampler.getSampleCount(i) > 0;
+        match = match && sampler.getLatestSample(i) == (test_input[i] << sampler.getOversampleBits());
+    }
+    return match;
+}
+
+/**
+ * @brief Main loop with the GPIO interrupt: every ALERT/RDY pulse calls onAlert(), except every drop_every-th one
+ *
+ */
+static void runAlertRdy(AdcBench &bench, AdcSampler &sampler, uint64_t duration_us, uint32_t drop_every)
+{
+    uint64_t end_us = time_us_64() + duration_us;
+    uint32_t alerts = 0;
+    while (time_us_64() < end_us)
+    {
+        host_time_advance_us(ADC_TEST_LOOP_US);
+        while (bench.device.takeAlert())
+        {
+            alerts++;
+            if (drop_every == 0 || (alerts % drop_every) != 0)
+            {
+                sampler.onAlert();
+            }
+        }
+        sampler.service();
+    }
+}
+
+/**
+ * @brief I2C transactions per conversion: polling conversionComplete() before, ALERT/RDY after
+ *
+ */
+static void testAlertRdyTransactions()
+{
+    host_i2c_detach_all();
+    AdcBench bench(i2c0);
+
+    uint32_t transactions = bench.bus.getTransactionCount();
+    uint32_t conversions = bench.device.conversion_count;
+    uint64_t start_us = time_us_64();
+    for (int i = 0; i < 1000; i++)
+    {
+        HOST_CHECK(bench.adc.readSingleEnded(i % 4) == test_input[i % 4]);
+    }
+    conversions = bench.device.conversion_count - conversions;
+    double polling_per_conversion = (double)(bench.bus.getTransactionCount() - transactions) / conversions;
+    double polling_rate = conversions * 1e6 / (double)(time_us_64() - start_us);
+
+    AdcSampler sampler(&bench.adc, ADC_ACQUISITION_ALERT_RDY, 2);
+    sampler.init();
+    transactions = bench.bus.getTransactionCount();
+    conversions = bench.device.conversion_count;
+    start_us = time_us_64();
+    runAlertRdy(bench, sampler, ADC_TEST_RUN_US, 0);
+    conversions = bench.device.conversion_count - conversions;
+    double alert_per_conversion = (double)(bench.bus.getTransactionCount() - transactions) / conversions;
+    double alert_rate = conversions * 1e6 / (double)(time_us_64() - start_us);
+
+    printf("polling: %.1f I2C transactions per conversion, %.0f conversions/s\n", polling_per_conversion, polling_rate);
+    printf("ALERT/RDY: %.1f I2C transactions per conversion, %.0f conversions/s, %u samples/s per channel\n",
+           alert_per_conversion, alert_rate, sampler.getSamplesPerSecond(0));
+    // Config write, pointer write, result read
+    HOST_CHECK(alert_per_conversion < 3.01);
+    HOST_CHECK(polling_per_conversion > alert_per_conversion);
+    HOST_CHECK(alert_rate > polling_rate);
+    HOST_CHECK(samplesMatchInputs(sampler));
+}
+
+/**
+ * @brief EEPROM on the ADC bus: the ALERT/RDY interrupt fires while the main loop writes a page
+ *
+ */
+class InterruptedEeprom : public HostI2cDevice
+{
+public:
+    HostAds1015 *device;
+    AdcSampler *sampler;
+    uint32_t alerts_during_transfer = 0;
+
+    int write(const uint8_t *data, size_t size, bool nostop) override
+    {
+        (void)data;
+        (void)nostop;
+        while (this->device->takeAlert())
+        {
+            this->alerts_during_transfer++;
+            this->sampler->onAlert();
+        }
+        return (int)size;
+    }
+
+    int read(uint8_t *data, size_t size, bool nostop) override
+    {
+        (void)nostop;
+        memset(data, 0, size);
+        return (int)size;
+    }
+};
+
+/**
+ * @brief An alert during a transfer of the main loop is left to service(), the samples stay on their channels
+ *
+ */
+static void testAlertDuringTransfer()
+{
+    host_i2c_detach_all();
+    AdcBench bench(i2c0);
+    AdcSampler sampler(&bench.adc, ADC_ACQUISITION_ALERT_RDY, 2);
+    InterruptedEeprom eeprom;
+    eeprom.device = &bench.device;
+    eeprom.sampler = &sampler;
+    host_i2c_attach(i2c0, ADC_TEST_EEPROM_ADDRESS, &eeprom);
+    sampler.init();
+
+    uint8_t page[34] = {0};
+    uint32_t conversions = bench.device.conversion_count;
+    for (int i = 0; i < 1000; i++)
+    {
+        bench.bus.write(ADC_TEST_EEPROM_ADDRESS, page, sizeof(page), false);
+        runAlertRdy(bench, sampler, 500, 0);
+    }
+    printf("alerts during EEPROM transfers: %u, conversions %u\n", eeprom.alerts_during_transfer,
+           bench.device.conversion_count - conversions);
+    HOST_CHECK(eeprom.alerts_during_transfer > 100);
+    HOST_CHECK(samplesMatchInputs(sampler));
+}
+
+/**
+ * @brief A lost ALERT/RDY edge stalls the acquisition only until ADC_SAMPLER_CONVERSION_TIMEOUT_US
+ *
+ */
+static void testLostAlert()
+{
+    host_i2c_detach_all();
+    AdcBench bench(i2c0);
+    AdcSampler sampler(&bench.adc, ADC_ACQUISITION_ALERT_RDY, 2);
+    sampler.init();
+
+    uint32_t conversions = bench.device.conversion_count;
+    runAlertRdy(bench, sampler, ADC_TEST_RUN_US, 50);
+    conversions = bench.device.conversion_count - conversions;
+    // Per conversion: conversion time, about 400 us of I2C transfers and a 50th of the timeout for the lost edges
+    uint32_t expected_min = ADC_TEST_RUN_US / (1000000 / 3300 + 400 + ADC_SAMPLER_CONVERSION_TIMEOUT_US / 50);
+    printf("every 50th alert lost: %.0f conversions/s\n", conversions * 1e6 / ADC_TEST_RUN_US);
+    HOST_CHECK(conversions > expected_min);
+    HOST_CHECK(samplesMatchInputs(sampler));
+}
+
+/**
+ * @brief Interleaved acquisition with the oscillators off by clock_factor: results are only read after the
+ * conversion finished and never land on the wrong channel. With one ADC alone the wait is not hidden behind
+ * the transfers on the other bus, at the slower data rates 10% of the period is more than the result read takes
+ *
+ */
+static void testInterleavedClockTolerance(uint16_t data_rate, double clock_factor, bool both_buses)
+{
+    host_i2c_detach_all();
+    AdcBench bench_0(i2c0, data_rate);
+    AdcBench bench_1(i2c1, data_rate);
+    bench_0.device.clock_factor = clock_factor;
+    bench_1.device.clock_factor = clock_factor;
+    AdcSampler sampler_0(&bench_0.adc, ADC_ACQUISITION_INTERLEAVED);
+    AdcSampler sampler_1(&bench_1.adc, ADC_ACQUISITION_INTERLEAVED);
+    sampler_0.init();
+    if (both_buses)
+    {
+        sampler_1.init();
+    }
+    AdcScheduler scheduler(&sampler_0, &sampler_1);
+
+    uint64_t end_us = time_us_64() + ADC_TEST_RUN_US;
+    while (time_us_64() < end_us)
+    {
+        host_time_advance_us(ADC_TEST_LOOP_US);
+        if (both_buses)
+        {
+            scheduler.service();
+        }
+        else
+        {
+            sampler_0.service();
+        }
+    }
+    printf("interleaved %s, data rate 0x%04x, oscillator x%.2f: early result reads %u / %u, %u samples/s per channel\n",
+           both_buses ? "both buses" : "one bus", data_rate, clock_factor, bench_0.device.early_result_reads,
+           bench_1.device.early_result_reads, sampler_0.getSamplesPerSecond(0));
+    HOST_CHECK(bench_0.device.early_result_reads == 0);
+    HOST_CHECK(bench_1.device.early_result_reads == 0);
+    HOST_CHECK(samplesMatchInputs(sampler_0));
+    HOST_CHECK(!both_buses || samplesMatchInputs(sampler_1));
+}
+
+/**
+ * @brief Conversions per second and knob: both ADCs read one after the other with polling (the main loop before
+ * the scheduler) against the interleaved acquisition
+ *
+ */
+static void benchmarkInterleaved()
+{
+    host_i2c_detach_all();
+    AdcBench bench_0(i2c0);
+    AdcBench bench_1(i2c1);
+
+    uint64_t start_us = time_us_64();
+    uint32_t conversions = 0;
+    while (time_us_64() - start_us < ADC_TEST_RUN_US)
+    {
+        for (uint8_t i = 0; i < 4; i++)
+        {
+            bench_0.adc.readSingleEnded(i);
+            bench_1.adc.readSingleEnded(i);
+            conversions += 2;
+        }
+    }
+    double sequential = conversions * 1e6 / (double)(time_us_64() - start_us) / 8;
+
+    AdcSampler sampler_0(&bench_0.adc, ADC_ACQUISITION_INTERLEAVED);
+    AdcSampler sampler_1(&bench_1.adc, ADC_ACQUISITION_INTERLEAVED);
+    sampler_0.init();
+    sampler_1.init();
+    AdcScheduler scheduler(&sampler_0, &sampler_1);
+    conversions = bench_0.device.conversion_count + bench_1.device.conversion_count;
+    start_us = time_us_64();
+    while (time_us_64() - start_us < ADC_TEST_RUN_US)
+    {
+        host_time_advance_us(ADC_TEST_LOOP_US);
+        scheduler.service();
+    }
+    conversions = bench_0.device.conversion_count + bench_1.device.conversion_count - conversions;
+    double interleaved = conversions * 1e6 / (double)(time_us_64() - start_us) / 8;
+
+    printf("conversions/s per knob: sequential polling %.0f, interleaved %.0f (x%.2f)\n", sequential, interleaved,
+           interleaved / sequential);
+    HOST_CHECK(interleaved > 1.3 * sequential);
+}
+
+/**
+ * @brief Continuous mode: the conversion running across a mux change finishes on the old input and is discarded
+ *
+ */
+static void testContinuousClockTolerance(double clock_factor)
+{
+    host_i2c_detach_all();
+    AdcBench bench(i2c0);
+    bench.device.clock_factor = clock_factor;
+    AdcSampler sampler(&bench.adc, ADC_ACQUISITION_CONTINUOUS);
+    sampler.init();
+
+    uint64_t end_us = time_us_64() + ADC_TEST_RUN_US;
+    while (time_us_64() < end_us)
+    {
+        host_time_advance_us(ADC_TEST_LOOP_US);
+        sampler.service();
+    }
+    printf("continuous, oscillator x%.2f: %u samples/s per channel\n", clock_factor, sampler.getSamplesPerSecond(0));
+    HOST_CHECK(samplesMatchInputs(sampler));
+}
+
+/**
+ * @brief Sample clock ticks while the interleaved acquisition runs, then while the main loop is stalled. The
+ * oversampled samples come in at about half the clock rate, a tick only marks the channels with a new one. The
+ * ticks of the stall repeat the last samples and must not be marked fresh, after the stall they are fresh again
+ *
+ */
+static void testSampleClockStall()
+{
+    host_i2c_detach_all();
+    AdcBench bench_0(i2c0);
+    AdcBench bench_1(i2c1);
+    AdcSampler sampler_0(&bench_0.adc, ADC_ACQUISITION_INTERLEAVED);
+    AdcSampler sampler_1(&bench_1.adc, ADC_ACQUISITION_INTERLEAVED);
+    sampler_0.init();
+    sampler_1.init();
+    AdcScheduler scheduler(&sampler_0, &sampler_1);
+    AdcSampleClock clock(&sampler_0, &sampler_1, ADC_TEST_CLOCK_HZ);
+    clock.start();
+    repeating_timer_t timer;
+    timer.user_data = &clock;
+
+    // Runs the main loop (or not) until the next tick, then returns the fresh bits of both samplers
+    auto tick = [&](bool stalled) {
+        uint64_t end_us = time_us_64() + clock.getPeriodUs();
+        while (time_us_64() < end_us)
+        {
+            host_time_advance_us(ADC_TEST_LOOP_US);
+            if (!stalled)
+            {
+                scheduler.service();
+            }
+        }
+        AdcSampleClock::callback_tick(&timer);
+        adc_sample_frame_t frame;
+        HOST_CHECK(clock.pop(&frame));
+        return (frame.fresh[1] << ADC_SAMPLER_CHANNEL_COUNT) | frame.fresh[0];
+    };
+    const int channels = 2 * ADC_SAMPLER_CHANNEL_COUNT;
+    const int ticks = ADC_TEST_CLOCK_HZ / 10;
+    for (int i = 0; i < 4; i++)
+    {
+        tick(false);
+    }
+    int fresh[channels] = {};
+    for (int i = 0; i < ticks; i++)
+    {
+        int bits = tick(false);
+        for (int channel = 0; channel < channels; channel++)
+        {
+            fresh[channel] += (bits >> channel) & 0x01;
+        }
+    }
+    int fresh_min = ticks;
+    for (int channel = 0; channel < channels; channel++)
+    {
+        fresh_min = (fresh[channel] < fresh_min) ? fresh[channel] : fresh_min;
+    }
+    int stalled_fresh = 0;
+    tick(true); // Samples finished before the stall
+    for (uint32_t t = clock.getPeriodUs(); t < ADC_TEST_STALL_US; t += clock.getPeriodUs())
+    {
+        stalled_fresh += tick(true) != 0;
+    }
+    int resumed = tick(false) | tick(false) | tick(false);
+    printf("sample clock %dHz: at least %d of %d ticks fresh per knob while running, %d fresh during a %dus stall, 0x%02x after\n",
+           ADC_TEST_CLOCK_HZ, fresh_min, ticks, stalled_fresh, ADC_TEST_STALL_US, resumed);
+    HOST_CHECK(fresh_min >= ticks * 2 / 5 && fresh_min < ticks);
+    HOST_CHECK(stalled_fresh == 0);
+    HOST_CHECK(resumed == (1 << channels) - 1);
+}
+
+int main()
+{
+    testAlertRdyTransactions();
+    testAlertDuringTransfer();
+    testLostAlert();
+    testInterleavedClockTolerance(RATE_ADS1015_3300SPS, 0.9, false);
+    testInterleavedClockTolerance(RATE_ADS1015_3300SPS, 1.1, false);
+    testInterleavedClockTolerance(RATE_ADS1015_3300SPS, 1.1, true);
+    testInterleavedClockTolerance(RATE_ADS1015_920SPS, 1.1, false);
+    testInterleavedClockTolerance(RATE_ADS1015_128SPS, 1.1, false);
+    benchmarkInterleaved();
+    testContinuousClockTolerance(0.9);
+    testContinuousClockTolerance(1.1);
+    testSampleClockStall();
+    return host_test_result();
+}
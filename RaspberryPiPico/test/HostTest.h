@@ -0,0 +1,37 @@
+#ifndef __HOST_TEST_H__
+#define __HOST_TEST_H__
+
+#include <stdio.h>
+
+/**
+ * @brief Minimal check helpers for the host tests. A test binary runs all its checks and returns
+ * host_test_result() from main(), ctest reports a non-zero exit code as failure.
+ *
+ */
+
+static int host_test_failures = 0;
+
+#define HOST_CHECK(condition) host_test_check((condition), #condition, __FILE__, __LINE__)
+
+static inline bool host_test_check(bool passed, const char *condition, const char *file, int line)
+{
+    if (!passed)
+    {
+        host_test_failures++;
+        printf("%s:%d: check failed: %s\n", file, line, condition);
+    }
+    return passed;
+}
+
+static inline int host_test_result()
+{
+    if (host_test_failures > 0)
+    {
+        printf("FAILED: %d check(s)\n", host_test_failures);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
+
+#endif
@@ -0,0 +1,344 @@
+#include <math.h>
+#include <stdlib.h>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "HostTest.h"
+#include "HostSdk.h"
+#include "PotiCtl.h"
+
+#define POTI_TEST_SAMPLES 20000
+#define POTI_TEST_TRIALS 400
+#define POTI_REPLAY_SAMPLE_US 5000   // 200 SPS per knob
+#define POTI_REPLAY_SETTLE_SAMPLES 400
+#define POTI_REPLAY_IDLE_SAMPLES 400 // Knob at rest after settling, the idle jitter window
+#define POTI_REPLAY_STEP_SAMPLES 400
+#define POTI_REPLAY_HIGH 960 // ADC counts of the step, output about 387 and 75
+#define POTI_REPLAY_LOW 800
+
+/**
+ * @brief Test access to the filter stages of PotiCtl
+ *
+ */
+class PotiCtlProbe : public PotiCtl
+{
+public:
+    PotiCtlProbe() : PotiCtl(NULL, NULL, 6) {}
+
+    void setCalibration(uint8_t channel_index, int in_min, int in_max)
+    {
+        this->min[channel_index] = in_min;
+        this->max[channel_index] = in_max;
+        this->min_int[channel_index] = in_min;
+        this->max_int[channel_index] = in_max;
+    }
+    int runDouble(uint8_t channel_index, uint16_t result) { return this->filterDouble(channel_index, result); }
+    int runFixed(uint8_t channel_index, uint16_t result) { return this->filterFixed(channel_index, result); }
+    int runOneEuro(uint8_t channel_index, uint16_t result, uint32_t sample_us) { return this->filterOneEuro(channel_index, result, sample_us); }
+    int linearize(int32_t value) { return this->linearizeFixed(value, 511); }
+    void setOutValue(uint8_t channel_index, int value) { this->out_val[channel_index] = value; }
+    uint16_t centerFromTable(uint8_t channel_index) { return this->centerValue(channel_index); }
+    uint16_t centerCalculated(uint8_t channel_index, uint16_t out_val) { return this->centerValueCalculated(channel_index, out_val); }
+    size_t getCenterTableBytes() { return sizeof(this->center_table); }
+};
+
+/**
+ * @brief _map() of the double chain: round, then clip to the output range
+ *
+ */
+static long referenceMap(double x, double in_min, double in_max, double out_min, double out_max)
+{
+    long mapped = lround((x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min);
+    mapped = (mapped < out_min) ? (long)out_min : mapped;
+    return (mapped > out_max) ? (long)out_max : mapped;
+}
+
+/**
+ * @brief Center dead zone remap as computed per sample before the tables
+ *
+ */
+static uint16_t referenceCenterValue(int out_val, int center)
+{
+    if (center <= 0)
+    {
+        return out_val;
+    }
+    if (out_val > center + CENTER_LOCK_MARGIN)
+    {
+        return referenceMap(out_val, center + CENTER_LOCK_MARGIN, 511, 255, 511);
+    }
+    if (out_val < center - CENTER_LOCK_MARGIN)
+    {
+        return referenceMap(out_val, 0, center - CENTER_LOCK_MARGIN, 0, 255);
+    }
+    return 255;
+}
+
+/**
+ * @brief Knob position 0 - 1100 ADC counts for sample i of the test signals: steps, ramps, random walk, sine
+ *
+ */
+static double knobPosition(int shape, int trial, int i, double position, std::mt19937 &rng)
+{
+    switch (shape)
+    {
+    case 0:
+        return ((i / 2000) % 2) ? 1100 : 0;
+    case 1:
+        return ((i % 4000) < 2000) ? (i % 2000) * 0.55 : 1100 - (i % 2000) * 0.55;
+    case 2:
+        position += (int)(rng() % 21) - 10;
+        return (position < 0) ? 0 : ((position > 1100) ? 1100 : position);
+    default:
+        return 500 + 400 * sin(i * 0.003 * (1 + trial % 7));
+    }
+}
+
+/**
+ * @brief The fixed point chain matches the double chain within 1 LSB over the whole input range,
+ * for random calibration limits and steps, ramps, random walks and sines with +-2 counts of noise
+ *
+ */
+static void testFixedMatchesDouble()
+{
+    std::mt19937 rng(1);
+    int max_error = 0;
+    long samples = 0;
+    for (int trial = 0; trial < POTI_TEST_TRIALS; trial++)
+    {
+        PotiCtlProbe poti;
+        poti.setCalibration(0, rng() % 50, 900 + rng() % 150);
+        double position = rng() % 1100;
+        for (int i = 0; i < POTI_TEST_SAMPLES; i++)
+        {
+            position = knobPosition(trial % 4, trial, i, position, rng);
+            int raw = (int)position + (int)(rng() % 5) - 2;
+            raw = (raw < 0) ? 0 : raw;
+            int error = abs(poti.runDouble(0, raw) - poti.runFixed(0, raw));
+            max_error = (error > max_error) ? error : max_error;
+            samples++;
+        }
+    }
+    printf("fixed vs double: %ld samples, max error %d LSB\n", samples, max_error);
+    HOST_CHECK(max_error <= 1);
+}
+
+/**
+ * @brief Host timing of both chains, for comparison only: the RP2040 has no FPU, the gap is much larger there
+ *
+ */
+static void benchmarkFilterChains()
+{
+    PotiCtlProbe poti;
+    poti.setCalibration(0, 5, 990);
+    volatile int sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 1000000; i++)
+    {
+        sink = poti.runDouble(0, i % 1000);
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (int i = 0; i < 1000000; i++)
+    {
+        sink = poti.runFixed(0, i % 1000);
+    }
+    auto end = std::chrono::steady_clock::now();
+    (void)sink;
+    printf("host ns per sample: double %.1f, fixed %.1f\n",
+           std::chrono::duration<double, std::nano>(middle - start).count() / 1000000,
+           std::chrono::duration<double, std::nano>(end - middle).count() / 1000000);
+}
+
+/**
+ * @brief The interpolated x^9 table stays within 1 LSB of round(pow(x, 9) * 511) over the whole Q24 range
+ *
+ */
+static void testLinearizeTable()
+{
+    PotiCtlProbe poti;
+    int max_error = 0;
+    for (int32_t value = 0; value <= POTI_Q_ONE; value += 97)
+    {
+        int reference = (int)round(pow((double)value / POTI_Q_ONE, 9) * 511);
+        int error = abs(poti.linearize(value) - reference);
+        max_error = (error > max_error) ? error : max_error;
+    }
+    printf("linearize table: max error %d LSB\n", max_error);
+    HOST_CHECK(max_error <= 1);
+    HOST_CHECK(poti.linearize(POTI_Q_ONE) == 511);
+    HOST_CHECK(poti.linearize(0) == 0);
+}
+
+/**
+ * @brief The center table rebuilt by setCenterFromOutValue() equals the per-sample remap for every center and output
+ *
+ */
+static void testCenterTable()
+{
+    PotiCtlProbe poti;
+    long mismatches = 0;
+    for (int center_out = 0; center_out < POTI_OUT_RANGE; center_out++)
+    {
+        poti.setOutValue(1, center_out);
+        poti.setCenterFromOutValue(1);
+        int center = (int)poti.getCenter(1);
+        HOST_CHECK(center == ((center_out > 150) ? center_out : 0));
+        for (int out_val = 0; out_val < POTI_OUT_RANGE; out_val++)
+        {
+            poti.setOutValue(1, out_val);
+            mismatches += poti.centerFromTable(1) != referenceCenterValue(out_val, center);
+        }
+    }
+    printf("center table: %ld mismatches against the computed remap\n", mismatches);
+    HOST_CHECK(mismatches == 0);
+}
+
+/**
+ * @brief Memory of the tables as documented in PotiCtl.h, and the host cost per sample against the computed curves
+ *
+ */
+static void benchmarkTables()
+{
+    PotiCtlProbe poti;
+    size_t linearize_bytes = POTI_LINEARIZE_TABLE_SIZE * sizeof(uint16_t);
+    printf("tables: linearization %zu bytes shared, center remap %zu bytes per PotiCtl\n", linearize_bytes,
+           poti.getCenterTableBytes());
+    HOST_CHECK(linearize_bytes == 1026);
+    HOST_CHECK(poti.getCenterTableBytes() == 4096);
+
+    poti.setOutValue(0, 300);
+    poti.setCenterFromOutValue(0);
+    volatile double sink_double = 0;
+    volatile int sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 1000000; i++)
+    {
+        sink_double = pow((double)(i & 0xFFFFF) / 0xFFFFF, 9);
+        sink = poti.centerCalculated(0, i & 511);
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (int i = 0; i < 1000000; i++)
+    {
+        sink = poti.linearize((i & 0xFFFFF) << 4);
+        poti.setOutValue(0, i & 511);
+        sink = poti.centerFromTable(0);
+    }
+    auto end = std::chrono::steady_clock::now();
+    (void)sink;
+    (void)sink_double;
+    printf("host ns per sample for linearization and center remap: computed %.1f, tables %.1f\n",
+           std::chrono::duration<double, std::nano>(middle - start).count() / 1000000,
+           std::chrono::duration<double, std::nano>(end - middle).count() / 1000000);
+}
+
+typedef struct
+{
+    int idle_peak_to_peak; // Filter output while the knob rests
+    long idle_changes;     // Knob output changes while the knob rests
+    int step_samples;      // Samples to 90% of the step at the filter output, slower of down and up
+    int step_samples_out;  // Same at the knob output, after step limit and lock
+} replay_result_t;
+
+/**
+ * @brief Samples after the step at 'from' until the trace covered 90% of the way to its value at 'to'
+ *
+ */
+static int stepResponseSamples(const std::vector<int> &trace, size_t from, size_t to)
+{
+    int start = trace[from - 1];
+    int end = trace[to - 1];
+    for (size_t i = from; i < to; i++)
+    {
+        if (10 * abs(trace[i] - start) >= 9 * abs(end - start))
+        {
+            return (int)(i - from + 1);
+        }
+    }
+    return (int)(to - from);
+}
+
+/**
+ * @brief Replays the trace at 200 SPS through one filter mode with the default One-Euro settings. One PotiCtl
+ * gives the filter output, a second one the knob output of uppdateFromSample()
+ *
+ */
+static replay_result_t replayTrace(const std::vector<uint16_t> &trace, uint8_t mode)
+{
+    host_time_set_us(0);
+    PotiCtlProbe filter;
+    PotiCtlProbe knob;
+    filter.setFilter(0, mode, FILTER_DEFAULT_MIN_CUTOFF_MHZ, FILTER_DEFAULT_BETA);
+    knob.setFilter(0, mode, FILTER_DEFAULT_MIN_CUTOFF_MHZ, FILTER_DEFAULT_BETA);
+    std::vector<int> filtered;
+    std::vector<int> out;
+    uint32_t sample_us = 0;
+    for (uint16_t raw : trace)
+    {
+        sample_us += POTI_REPLAY_SAMPLE_US;
+        filtered.push_back((mode == FILTER_MODE_ONE_EURO) ? filter.runOneEuro(0, raw, sample_us) : filter.runFixed(0, raw));
+        knob.uppdateFromSample(0, raw, sample_us);
+        out.push_back(knob.getValue(0));
+    }
+
+    replay_result_t result = {0, 0, 0, 0};
+    size_t idle_start = POTI_REPLAY_SETTLE_SAMPLES;
+    size_t idle_end = idle_start + POTI_REPLAY_IDLE_SAMPLES;
+    int idle_min = filtered[idle_start];
+    int idle_max = filtered[idle_start];
+    for (size_t i = idle_start; i < idle_end; i++)
+    {
+        idle_min = (filtered[i] < idle_min) ? filtered[i] : idle_min;
+        idle_max = (filtered[i] > idle_max) ? filtered[i] : idle_max;
+        result.idle_changes += (i > idle_start && out[i] != out[i - 1]);
+    }
+    result.idle_peak_to_peak = idle_max - idle_min;
+    for (size_t step = idle_end; step < trace.size(); step += POTI_REPLAY_STEP_SAMPLES)
+    {
+        int samples = stepResponseSamples(filtered, step, step + POTI_REPLAY_STEP_SAMPLES);
+        int samples_out = stepResponseSamples(out, step, step + POTI_REPLAY_STEP_SAMPLES);
+        result.step_samples = (samples > result.step_samples) ? samples : result.step_samples;
+        result.step_samples_out = (samples_out > result.step_samples_out) ? samples_out : result.step_samples_out;
+    }
+    return result;
+}
+
+/**
+ * @brief Step response and idle jitter of the One-Euro mode against the 0.93/0.9/0.88 cascade on the same trace:
+ * the knob rests with +-2 counts of noise, then steps down and back up. One-Euro has to reach 90% of a step
+ * within 10 samples and at least 5 times faster than the cascade, with the idle jitter of the filter output
+ * within 1 LSB of the cascade
+ *
+ */
+static void testOneEuroReplay()
+{
+    std::mt19937 rng(3);
+    std::vector<uint16_t> trace;
+    size_t length = POTI_REPLAY_SETTLE_SAMPLES + POTI_REPLAY_IDLE_SAMPLES + 2 * POTI_REPLAY_STEP_SAMPLES;
+    for (size_t i = 0; i < length; i++)
+    {
+        bool low = i >= POTI_REPLAY_SETTLE_SAMPLES + POTI_REPLAY_IDLE_SAMPLES && i < length - POTI_REPLAY_STEP_SAMPLES;
+        trace.push_back((low ? POTI_REPLAY_LOW : POTI_REPLAY_HIGH) + (int)(rng() % 5) - 2);
+    }
+    replay_result_t cascade = replayTrace(trace, FILTER_MODE_CASCADE);
+    replay_result_t one_euro = replayTrace(trace, FILTER_MODE_ONE_EURO);
+    printf("200 SPS replay, 90%% step response in samples (filter / knob output), idle jitter (filter p-p / knob changes):\n"
+           "  cascade  %d / %d, %d / %ld\n"
+           "  One-Euro %d / %d, %d / %ld\n",
+           cascade.step_samples, cascade.step_samples_out, cascade.idle_peak_to_peak, cascade.idle_changes,
+           one_euro.step_samples, one_euro.step_samples_out, one_euro.idle_peak_to_peak, one_euro.idle_changes);
+    HOST_CHECK(one_euro.step_samples <= 10);
+    HOST_CHECK(5 * one_euro.step_samples <= cascade.step_samples);
+    HOST_CHECK(one_euro.step_samples_out < cascade.step_samples_out);
+    HOST_CHECK(one_euro.idle_peak_to_peak <= cascade.idle_peak_to_peak + 1);
+}
+
+int main()
+{
+    testFixedMatchesDouble();
+    benchmarkFilterChains();
+    testLinearizeTable();
+    testCenterTable();
+    benchmarkTables();
+    testOneEuroReplay();
+    return host_test_result();
+}
@@ -0,0 +1,352 @@
+#include <chrono>
+#include <random>
+#include <vector>
+#include "HostTest.h"
+#include "InputCtl.h"
+#include "RemoteCmdEngine.h"
+
+#define FUZZ_STREAMS 20000
+#define FUZZ_ITEMS_MAX 60         // Commands or noise bytes per stream
+#define FUZZ_SEED 1234
+#define THROUGHPUT_BYTES (1 << 20) // UART stream of the whole chain, 1/16 of it for this board
+#define THROUGHPUT_PASSES 50
+
+#if defined(__SANITIZE_ADDRESS__)
+#define FUZZ_SANITIZED 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define FUZZ_SANITIZED 1
+#endif
+#endif
+
+typedef struct
+{
+    bool ack; // Multicast ack instead of a handler call
+    uint16_t ack_value;
+    std::vector<uint8_t> bytes; // Message type, data bytes
+} command_event_t;
+
+/**
+ * @brief Records what the engine runs: the handlers of the table are replaced by record(), the ack handler by
+ * recordAck()
+ *
+ */
+struct CommandRecorder
+{
+    std::vector<command_event_t> events;
+    uint8_t data_byte_count[256] = {};
+
+    static void record(void *context, uint8_t *data_bytes)
+    {
+        CommandRecorder *recorder = (CommandRecorder *)context;
+        uint8_t msg_type = data_bytes[-1];
+        recorder->events.push_back({false, 0, std::vector<uint8_t>(data_bytes - 1, data_bytes + recorder->data_byte_count[msg_type])});
+    }
+
+    static void recordAck(void *context, uint16_t ack_value)
+    {
+        CommandRecorder *recorder = (CommandRecorder *)context;
+        recorder->events.push_back({true, ack_value, {}});
+    }
+};
+
+typedef struct
+{
+    bool addressed;
+    bool multicast;
+    uint8_t seq;
+    std::vector<uint8_t> bytes;
+} reference_slot_t;
+
+/**
+ * @brief Reference framing as written down in documentation.txt: a state machine over the whole frame with the
+ * lengths from the table. Keeps its own queue of REMOTE_CMD_SLOT_COUNT - 1 commands, so lost commands match too
+ *
+ */
+struct ReferenceParser
+{
+    const std::vector<remote_command_descriptor_t> &table;
+    uint8_t transport;
+    uint8_t address;
+    bool chain;    // Acks multicast commands
+    int state = 0; // 0: idle, 1: multicast header, 2: message type, 3: data bytes
+    uint8_t header[REMOTE_CMD_MULTICAST_HEADER_BYTES];
+    int header_length = 0;
+    bool multicast = false;
+    std::vector<uint8_t> bytes;
+    int data_left = 0;
+    std::vector<reference_slot_t> queued;
+    std::vector<command_event_t> events;
+    uint32_t drops = 0;
+
+    ReferenceParser(const std::vector<remote_command_descriptor_t> &table, uint8_t transport, uint8_t address, bool chain)
+        : table(table), transport(transport), address(address), chain(chain)
+    {
+    }
+
+    int dataByteCount(uint8_t msg_type)
+    {
+        for (const remote_command_descriptor_t &descriptor : this->table)
+        {
+            if (descriptor.msg_type == msg_type && (descriptor.transports & this->transport))
+            {
+                return descriptor.data_byte_count;
+            }
+        }
+        return -1;
+    }
+
+    void feed(uint8_t c)
+    {
+        switch (this->state)
+        {
+        case 0:
+            if ((c & 0xF0) == 0xF0 && (this->address == REMOTE_CMD_ADDRESS_ANY || (c & 0x0F) == this->address))
+            {
+                this->multicast = false;
+                this->state = 2;
+            }
+            else if (c == 0xD0)
+            {
+                this->multicast = true;
+                this->header_length = 0;
+                this->state = 1;
+            }
+            return;
+        case 1:
+            this->header[this->header_length++] = c;
+            if (this->header_length == 4)
+            {
+                this->state = 2;
+            }
+            return;
+        case 2:
+            this->bytes.assign(1, c);
+            this->data_left = this->dataByteCount(c);
+            this->state = 3;
+            break;
+        default:
+            this->bytes.push_back(c);
+            this->data_left--;
+            break;
+        }
+        if (this->data_left > 0)
+        {
+            return;
+        }
+        this->state = 0;
+        if (this->data_left < 0)
+        {
+            // Unknown or not allowed on this transport
+            return;
+        }
+        if (this->queued.size() == REMOTE_CMD_SLOT_COUNT - 1)
+        {
+            this->drops++;
+            return;
+        }
+        reference_slot_t slot = {true, this->multicast, (uint8_t)(this->header[0] & 0x1F), this->bytes};
+        if (this->multicast && this->address != REMOTE_CMD_ADDRESS_ANY)
+        {
+            // Mask bytes: boards 0 - 6, 7 - 13, 14 - 15
+            slot.addressed = (this->header[1 + this->address / 7] >> (this->address % 7)) & 0x01;
+        }
+        this->queued.push_back(slot);
+    }
+
+    void execute()
+    {
+        for (const reference_slot_t &slot : this->queued)
+        {
+            if (slot.addressed)
+            {
+                this->events.push_back({false, 0, slot.bytes});
+            }
+            if (slot.multicast && this->chain)
+            {
+                uint16_t ack_value = (slot.seq << 9) | ((this->address / 7) << 7) | (1 << (this->address % 7));
+                this->events.push_back({true, ack_value, {}});
+            }
+        }
+        this->queued.clear();
+    }
+};
+
+static bool sameEvents(const std::vector<command_event_t> &a, const std::vector<command_event_t> &b)
+{
+    if (a.size() != b.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        if (a[i].ack != b[i].ack || a[i].ack_value != b[i].ack_value || a[i].bytes != b[i].bytes)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Random streams for both transports: noise, commands for this board and others, truncated commands,
+ * every message type 0xE0 - 0xEF and multicast frames. The engine executes at random points, every 7th stream only
+ * at the end so the queue overflows. Handler calls, acks and lost commands have to match the reference
+ *
+ */
+static void testDifferentialFuzz(std::vector<remote_command_descriptor_t> &table, CommandRecorder &recorder)
+{
+    std::mt19937 rng(FUZZ_SEED);
+    long commands = 0;
+    long acks = 0;
+    long drops = 0;
+    long mismatches = 0;
+    for (int stream = 0; stream < FUZZ_STREAMS; stream++)
+    {
+        uint8_t transport = (stream & 1) ? REMOTE_CMD_TRANSPORT_UART : REMOTE_CMD_TRANSPORT_USB;
+        uint8_t address = (transport == REMOTE_CMD_TRANSPORT_UART) ? rng() % 16 : REMOTE_CMD_ADDRESS_ANY;
+        bool chain = (transport == REMOTE_CMD_TRANSPORT_UART);
+        RemoteCmdEngine engine(table.data(), table.size(), transport, address, &recorder);
+        if (chain)
+        {
+            engine.setAckHandler(CommandRecorder::recordAck);
+        }
+        ReferenceParser reference(table, transport, address, chain);
+
+        std::vector<uint8_t> input;
+        int items = rng() % FUZZ_ITEMS_MAX;
+        for (int k = 0; k < items; k++)
+        {
+            int kind = rng() % 5;
+            if (kind == 0)
+            {
+                input.push_back(rng() & 0xFF); // Noise
+                continue;
+            }
+            if (kind == 4)
+            {
+                input.push_back(REMOTE_CMD_MULTICAST);
+                input.push_back(rng() & REMOTE_CMD_MULTICAST_SEQ_MASK);
+                for (int m = 0; m < 3; m++)
+                {
+                    input.push_back(rng() & 0x7F);
+                }
+            }
+            else
+            {
+                // Mostly for this board
+                input.push_back(0xF0 | ((rng() % 3) ? address & 0x0F : rng() % 16));
+            }
+            uint8_t msg_type = 0xE0 + rng() % 16;
+            input.push_back(msg_type);
+            int data_bytes = recorder.data_byte_count[msg_type];
+            if (kind == 3)
+            {
+                data_bytes = rng() % (data_bytes + 1); // Truncated
+            }
+            for (int j = 0; j < data_bytes; j++)
+            {
+                // Meter values are 8 bit, they can look like start bytes
+                input.push_back((msg_type == MSG_METER) ? rng() & 0xFF : rng() & 0x7F);
+            }
+        }
+
+        recorder.events.clear();
+        bool lazy = (stream % 7) == 0;
+        for (uint8_t c : input)
+        {
+            engine.feed(c);
+            reference.feed(c);
+            if (!lazy && rng() % 3 == 0)
+            {
+                engine.execute();
+                reference.execute();
+            }
+        }
+        engine.execute();
+        reference.execute();
+
+        if (!sameEvents(recorder.events, reference.events) || engine.getDropCount() != reference.drops)
+        {
+            if (mismatches++ < 5)
+            {
+                printf("stream %d: engine %zu events, %u dropped - reference %zu events, %u dropped\n", stream,
+                       recorder.events.size(), (unsigned)engine.getDropCount(), reference.events.size(), (unsigned)reference.drops);
+            }
+        }
+        for (const command_event_t &event : recorder.events)
+        {
+            (event.ack ? acks : commands)++;
+        }
+        drops += engine.getDropCount();
+    }
+    printf("fuzz: %d streams, %ld commands, %ld acks, %ld dropped, %ld streams differ from the reference\n",
+           FUZZ_STREAMS, commands, acks, drops, mismatches);
+    HOST_CHECK(mismatches == 0);
+    HOST_CHECK(commands > 0 && acks > 0 && drops > 0);
+}
+
+/**
+ * @brief feed() cost per byte on the chain engine: commands of every board, 1/16 addressed to this board
+ *
+ */
+static void benchmarkThroughput(std::vector<remote_command_descriptor_t> &table, CommandRecorder &recorder)
+{
+    std::mt19937 rng(FUZZ_SEED);
+    std::vector<uint8_t> stream;
+    while (stream.size() < THROUGHPUT_BYTES)
+    {
+        stream.push_back(0xF0 | (rng() % 16));
+        uint8_t msg_type = table[rng() % table.size()].msg_type;
+        stream.push_back(msg_type);
+        for (int j = 0; j < recorder.data_byte_count[msg_type]; j++)
+        {
+            stream.push_back(rng() & 0x7F);
+        }
+    }
+    RemoteCmdEngine engine(table.data(), table.size(), REMOTE_CMD_TRANSPORT_UART, 3, &recorder);
+    ReferenceParser reference(table, REMOTE_CMD_TRANSPORT_UART, 3, false);
+    for (uint8_t c : stream)
+    {
+        reference.feed(c);
+        reference.execute();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < THROUGHPUT_PASSES; pass++)
+    {
+        recorder.events.clear();
+        for (uint8_t c : stream)
+        {
+            if (engine.feed(c) == REMOTE_CMD_EVENT_END)
+            {
+                engine.execute();
+            }
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    HOST_CHECK(sameEvents(recorder.events, reference.events));
+#ifdef FUZZ_SANITIZED
+    const char *build = "sanitized build, relative figure only";
+#else
+    const char *build = "host";
+#endif
+    printf("throughput (%s): %.2f ns/byte, %zu commands per pass\n", build,
+           seconds * 1e9 / ((double)THROUGHPUT_PASSES * stream.size()), recorder.events.size());
+}
+
+int main()
+{
+    // The table of the firmware, every handler replaced by the recorder
+    std::vector<remote_command_descriptor_t> table(InputCtl::remote_commands, InputCtl::remote_commands + InputCtl::remote_command_count);
+    CommandRecorder recorder;
+    for (remote_command_descriptor_t &descriptor : table)
+    {
+        HOST_CHECK(descriptor.data_byte_count + 1 <= REMOTE_COMMAND_MAX_DATA_BYTES);
+        recorder.data_byte_count[descriptor.msg_type] = descriptor.data_byte_count;
+        descriptor.handler = CommandRecorder::record;
+    }
+    testDifferentialFuzz(table, recorder);
+    benchmarkThroughput(table, recorder);
+    return host_test_result();
+}
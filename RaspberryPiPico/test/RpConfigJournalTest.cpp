@@ -0,0 +1,243 @@
+#include <string.h>
+#include <vector>
+#include "HostTest.h"
+#include "HostSdk.h"
+#include "HostEeprom24LC32.h"
+#include "I2cController.h"
+#include "24LC32.h"
+#include "RpConfig.h"
+
+#define JOURNAL_TEST_BAUDRATE 400000
+#define JOURNAL_TEST_EEPROM_ADDRESS 0x50
+#define JOURNAL_TEST_STEPS 300       // State changes of the workload, more than JOURNAL_ENTRY_COUNT: the journal wraps
+#define JOURNAL_TEST_CONFIG_EVERY 7  // A config page write every 7 steps, in between the journal entries
+#define JOURNAL_TEST_TORN_VARIANTS 17 // 0 - 16 bytes of the page write programmed, the next one garbled
+#define JOURNAL_TEST_MIXED_VARIANTS 4 // Random old / new bytes
+#define JOURNAL_TEST_OFF_US 100000
+
+typedef struct
+{
+    uint8_t values[6];
+    uint32_t status;
+} journal_state_t;
+
+static bool sameState(const journal_state_t &a, const journal_state_t &b)
+{
+    return memcmp(a.values, b.values, sizeof(a.values)) == 0 && a.status == b.status;
+}
+
+static journal_state_t readState(RpConfig &config)
+{
+    journal_state_t state;
+    for (uint8_t i = 0; i < 6; i++)
+    {
+        state.values[i] = config.readControllerValue(i);
+    }
+    state.status = config.readControllerStatus();
+    return state;
+}
+
+/**
+ * @brief Button values and controller status of workload step
+ *
+ */
+static journal_state_t targetState(int step)
+{
+    journal_state_t state;
+    uint32_t r = step * 2654435761u;
+    for (uint8_t i = 0; i < 6; i++)
+    {
+        state.values[i] = (r >> (i * 3)) & 7;
+    }
+    state.status = (step * 37) & 0x3FFF;
+    return state;
+}
+
+/**
+ * @brief The 24LC32 of the board on i2c0, with the bus and driver of the firmware
+ *
+ */
+struct JournalBench
+{
+    HostEeprom24LC32 device;
+    I2cController bus;
+    Eeprom24LC32 eeprom;
+
+    JournalBench() : bus(i2c0, JOURNAL_TEST_BAUDRATE, 4, 5, true), eeprom(&bus, JOURNAL_TEST_EEPROM_ADDRESS)
+    {
+        host_i2c_detach_all();
+        host_i2c_attach(i2c0, JOURNAL_TEST_EEPROM_ADDRESS, &this->device);
+        this->bus.init();
+    }
+
+    void waitWriteCycle()
+    {
+        while (this->device.isBusy())
+        {
+            host_time_advance_us(100);
+        }
+    }
+
+    /**
+     * @brief The main loop idles until every dirty config page and the journal entry are written
+     *
+     */
+    bool idleUntilFlushed(RpConfig &config)
+    {
+        int steps = 0;
+        while (config.flushStep())
+        {
+            host_time_advance_us(1000);
+            if (++steps > 100000)
+            {
+                return false;
+            }
+        }
+        this->waitWriteCycle();
+        return true;
+    }
+
+    /**
+     * @brief Steps from 'from' to the end: every step changes the state and waits for its journal entry,
+     * every JOURNAL_TEST_CONFIG_EVERY steps a knob filter setting changes too
+     *
+     * @param writes_after_step receives the data write count once a step is flushed, if not NULL
+     */
+    bool runWorkload(RpConfig &config, int from, std::vector<long> *writes_after_step)
+    {
+        for (int step = from; step < JOURNAL_TEST_STEPS; step++)
+        {
+            journal_state_t target = targetState(step);
+            for (uint8_t i = 0; i < 6; i++)
+            {
+                config.writeControllerValue(i, target.values[i]);
+            }
+            config.writeControllerStatus(target.status);
+            if (step % JOURNAL_TEST_CONFIG_EVERY == 0)
+            {
+                config.writeControllerFilterBeta(6 + step % 8, 1000 + step);
+            }
+            host_time_advance_us(JOURNAL_APPEND_INTERVAL_US);
+            if (!this->idleUntilFlushed(config))
+            {
+                return false;
+            }
+            if (writes_after_step != NULL)
+            {
+                writes_after_step->push_back(this->device.data_writes);
+            }
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief Power fails during every data write of the workload, in JOURNAL_TEST_TORN_VARIANTS torn and
+ * JOURNAL_TEST_MIXED_VARIANTS mixed ways. After the reboot the board has to hold the state before or after the
+ * interrupted step, never a mix or the defaults. It then finishes the workload, across the wrap of the journal,
+ * and holds the final state after one more reboot
+ *
+ */
+static void testPowerLossAtEveryWrite()
+{
+    JournalBench bench;
+    host_time_set_us(0);
+    {
+        RpConfig config(&bench.eeprom, true);
+    }
+    bench.waitWriteCycle();
+    uint8_t initialized[HOST_EEPROM_SIZE];
+    memcpy(initialized, bench.device.memory, sizeof(initialized));
+
+    // Without power loss: the state every step leaves in the EEPROM and the data writes up to it
+    journal_state_t initial;
+    std::vector<journal_state_t> committed;
+    std::vector<long> writes_after_step;
+    long total_writes;
+    {
+        RpConfig config(&bench.eeprom, false);
+        initial = readState(config);
+        bench.device.powerCycle();
+        HOST_CHECK(bench.runWorkload(config, 0, &writes_after_step));
+        total_writes = bench.device.data_writes;
+    }
+    for (int step = 0; step < JOURNAL_TEST_STEPS; step++)
+    {
+        committed.push_back(targetState(step));
+    }
+    {
+        RpConfig config(&bench.eeprom, false);
+        HOST_CHECK(sameState(readState(config), committed.back()));
+        printf("no power loss: %ld data writes, %d journal entries over %d slots, final sequence %lu\n", total_writes,
+               JOURNAL_TEST_STEPS, JOURNAL_ENTRY_COUNT, (unsigned long)config.getJournalSequence());
+    }
+
+    long runs = 0;
+    long failures = 0;
+    long recovered_new = 0;
+    long recovered_previous = 0;
+    for (long w = 0; w < total_writes; w++)
+    {
+        int step = 0;
+        while (writes_after_step[step] <= w)
+        {
+            step++;
+        }
+        const journal_state_t &before = (step == 0) ? initial : committed[step - 1];
+        const journal_state_t &after = committed[step];
+        for (int variant = 0; variant < JOURNAL_TEST_TORN_VARIANTS + JOURNAL_TEST_MIXED_VARIANTS; variant++)
+        {
+            memcpy(bench.device.memory, initialized, sizeof(initialized));
+            host_time_set_us(0);
+            bench.device.powerCycle();
+            bench.device.cut_write = w;
+            bench.device.cut_mode = (variant < JOURNAL_TEST_TORN_VARIANTS) ? HOST_EEPROM_CUT_TORN : HOST_EEPROM_CUT_MIXED;
+            bench.device.cut_bytes = variant;
+            bench.device.random_state = w * 131 + variant;
+            bool cut = false;
+            try
+            {
+                RpConfig config(&bench.eeprom, false);
+                bench.runWorkload(config, 0, NULL);
+            }
+            catch (HostPowerLoss &)
+            {
+                cut = true;
+            }
+            HOST_CHECK(cut);
+            host_time_advance_us(JOURNAL_TEST_OFF_US);
+            bench.device.powerCycle();
+            runs++;
+
+            RpConfig config(&bench.eeprom, false);
+            journal_state_t recovered = readState(config);
+            bool passed = sameState(recovered, before) || sameState(recovered, after);
+            if (sameState(recovered, after) && !sameState(before, after))
+            {
+                recovered_new++;
+            }
+            else
+            {
+                recovered_previous++;
+            }
+            // Keep going from the recovered state, then power cycle once more
+            passed = bench.runWorkload(config, step, NULL) && passed;
+            RpConfig rebooted(&bench.eeprom, false);
+            passed = sameState(readState(rebooted), committed.back()) && passed;
+            if (!passed && failures++ < 5)
+            {
+                printf("power loss at data write %ld, variant %d: wrong state\n", w, variant);
+            }
+        }
+    }
+    printf("power loss runs: %ld (every data write x %d torn + %d mixed), failures %ld, recovered new %ld / previous %ld\n",
+           runs, JOURNAL_TEST_TORN_VARIANTS, JOURNAL_TEST_MIXED_VARIANTS, failures, recovered_new, recovered_previous);
+    HOST_CHECK(runs > 0);
+    HOST_CHECK(failures == 0);
+}
+
+int main()
+{
+    testPowerLossAtEveryWrite();
+    return host_test_result();
+}
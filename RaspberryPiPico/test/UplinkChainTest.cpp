@@ -0,0 +1,324 @@
+#include <vector>
+#include "HostTest.h"
+#include "HostSdk.h"
+#include "pico/util/queue.h"
+#include "Uplink.h"
+
+#define CHAIN_BOARDS 16
+#define CHAIN_BAUD 380400
+#define CHAIN_SERVICE_US 5      // core1 main loop: one Uplink::service() per board every 5us
+#define CHAIN_QUEUE_SIZE 64     // message_queue of the buttons
+#define CHAIN_KNOB_START 6      // Knob controller indices 6 - 13 as on the board
+#define CHAIN_KNOB_COUNT 8
+#define CHAIN_LOAD_SCAN_US 20000 // Load test: every board moves all knobs once per scan, 2/3 of the line in the legacy format
+#define CHAIN_LOAD_US 300000
+#define CHAIN_DRAIN_US 200000
+
+static const double chain_byte_us = 10e6 / CHAIN_BAUD; // Start, 8 data and stop bit
+
+/**
+ * @brief Decodes the upstream bytes at the Pi end (legacy and compact format) and keeps the last value of every
+ * board and controller
+ *
+ */
+struct PiReceiver
+{
+    uint8_t status = 0x00;
+    uint8_t bytes[3];
+    uint8_t length = 0;
+    uint8_t expected = 0;
+    long messages = 0;
+    long malformed = 0;
+    long last_byte_us = -1;
+    int value[CHAIN_BOARDS][64];
+    long count[CHAIN_BOARDS][64];
+    std::vector<uint16_t> buttons[CHAIN_BOARDS]; // Button messages in arrival order
+
+    PiReceiver()
+    {
+        for (int b = 0; b < CHAIN_BOARDS; b++)
+        {
+            for (int c = 0; c < 64; c++)
+            {
+                this->value[b][c] = -1;
+                this->count[b][c] = 0;
+            }
+        }
+    }
+
+    void receive(uint8_t c, long now_us)
+    {
+        this->last_byte_us = now_us;
+        if (c & 0x80)
+        {
+            if (this->length != 0)
+            {
+                this->malformed++;
+            }
+            this->status = ((c & 0xF0) == 0xB0) ? c : 0x00;
+            if (this->status == 0x00)
+            {
+                this->malformed++;
+            }
+            this->length = 0;
+            return;
+        }
+        if (this->status == 0x00)
+        {
+            this->malformed++;
+            return;
+        }
+        if (this->length == 0)
+        {
+            this->expected = (c & 0x40) ? 2 : 3;
+        }
+        this->bytes[this->length++] = c;
+        if (this->length < this->expected)
+        {
+            return;
+        }
+        this->length = 0;
+        uint8_t board = this->status & 0x0F;
+        uint8_t controller;
+        uint16_t value;
+        if (this->expected == 2)
+        {
+            controller = this->bytes[0] & 0x0F;
+            value = (((this->bytes[0] >> 4) & 0x03) << 7) | this->bytes[1];
+        }
+        else
+        {
+            controller = this->bytes[0];
+            value = this->bytes[1] | (this->bytes[2] << 7);
+        }
+        this->messages++;
+        this->value[board][controller] = value;
+        this->count[board][controller]++;
+        if (controller < CHAIN_KNOB_START)
+        {
+            this->buttons[board].push_back((controller << 8) | value);
+        }
+    }
+};
+
+/**
+ * @brief Board at position p of the chain: board index p, its uart0 goes to uart1 of board p - 1, board 0 talks
+ * to the Pi. Every link moves one byte per chain_byte_us, back to back while the TX ring has bytes
+ *
+ */
+struct Chain
+{
+    queue_t queues[CHAIN_BOARDS];
+    ValueMailbox mailboxes[CHAIN_BOARDS];
+    std::vector<UartTxRing> tx_rings;
+    std::vector<UartRxRing> rx_rings;
+    std::vector<Uplink *> uplinks;
+    bool on_line[CHAIN_BOARDS];
+    uint8_t line_byte[CHAIN_BOARDS];
+    double line_done_us[CHAIN_BOARDS];
+    long now_us = 0;
+    PiReceiver pi;
+
+    Chain(uint8_t wire_format)
+        : tx_rings(CHAIN_BOARDS, UartTxRing(uart0)), rx_rings(CHAIN_BOARDS, UartRxRing(uart1))
+    {
+        host_time_set_us(0);
+        for (int p = 0; p < CHAIN_BOARDS; p++)
+        {
+            queue_init(&this->queues[p], sizeof(queue_entry_t), CHAIN_QUEUE_SIZE);
+            this->uplinks.push_back(new Uplink(p, &this->queues[p], &this->mailboxes[p], &this->tx_rings[p], &this->rx_rings[p]));
+            this->uplinks[p]->setWireFormat(wire_format);
+            this->on_line[p] = false;
+            this->line_done_us[p] = 0;
+        }
+    }
+
+    ~Chain()
+    {
+        for (int p = 0; p < CHAIN_BOARDS; p++)
+        {
+            delete this->uplinks[p];
+            queue_free(&this->queues[p]);
+        }
+    }
+
+    void moveLines()
+    {
+        for (int p = 0; p < CHAIN_BOARDS; p++)
+        {
+            if (this->on_line[p] && this->now_us >= this->line_done_us[p])
+            {
+                if (p == 0)
+                {
+                    this->pi.receive(this->line_byte[p], this->now_us);
+                }
+                else
+                {
+                    this->rx_rings[p - 1].receive(this->line_byte[p]);
+                }
+                this->on_line[p] = false;
+            }
+            if (!this->on_line[p] && this->tx_rings[p].takeByte(&this->line_byte[p]))
+            {
+                // Back to back: the next start bit follows the stop bit of the previous byte
+                double start_us = this->line_done_us[p] > this->now_us - 1 ? this->line_done_us[p] : this->now_us;
+                this->line_done_us[p] = start_us + chain_byte_us;
+                this->on_line[p] = true;
+            }
+        }
+    }
+
+    /**
+     * @brief Advances the chain by 1us. The boards run their service() interleaved, not in lockstep
+     *
+     */
+    void step()
+    {
+        this->moveLines();
+        for (int p = 0; p < CHAIN_BOARDS; p++)
+        {
+            if ((this->now_us + p) % CHAIN_SERVICE_US == 0)
+            {
+                this->uplinks[p]->service();
+            }
+        }
+        this->now_us++;
+        host_time_advance_us(1);
+    }
+
+    bool isIdle()
+    {
+        for (int p = 0; p < CHAIN_BOARDS; p++)
+        {
+            if (this->on_line[p] || this->tx_rings[p].getUsed() > 0 || this->rx_rings[p].available() > 0 || !this->mailboxes[p].isEmpty() || !queue_is_empty(&this->queues[p]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void runUntilIdle(long max_us)
+    {
+        long end_us = this->now_us + max_us;
+        while (this->now_us < end_us && !this->isIdle())
+        {
+            this->step();
+        }
+    }
+};
+
+/**
+ * @brief One knob value of the last board through the idle chain: time from its first byte on the line to the last
+ * byte at the Pi, against the store-and-forward relay (every hop receives the whole packet before sending it on)
+ *
+ */
+static void testLatency()
+{
+    Chain chain(DATA_FORMATTER_WIRE_LEGACY);
+    const int last = CHAIN_BOARDS - 1;
+    for (long t = 0; t < 1000; t++)
+    {
+        chain.step();
+    }
+    chain.mailboxes[last].put(CHAIN_KNOB_START, 0x1234);
+    while (!chain.on_line[last])
+    {
+        chain.step();
+    }
+    long first_byte_us = chain.now_us;
+    chain.runUntilIdle(100000);
+
+    HOST_CHECK(chain.pi.messages == 1);
+    HOST_CHECK(chain.pi.value[last][CHAIN_KNOB_START] == 0x1234);
+    long latency_us = chain.pi.last_byte_us - first_byte_us;
+    double packet_us = 4 * chain_byte_us;
+    double store_forward_us = CHAIN_BOARDS * (packet_us + CHAIN_SERVICE_US);
+    // Cut-through: a hop holds the status byte back until the first data byte is there (it may drop the running
+    // status), so every hop adds two byte times and the wait for the next service() of the board
+    double cut_through_us = packet_us + (CHAIN_BOARDS - 1) * (2 * chain_byte_us + CHAIN_SERVICE_US);
+    printf("%d boards: last board to Pi %ldus, cut-through bound %.0fus, store-and-forward %.0fus\n",
+           CHAIN_BOARDS, latency_us, cut_through_us, store_forward_us);
+    HOST_CHECK(latency_us <= cut_through_us + 1);
+    HOST_CHECK(latency_us < store_forward_us);
+}
+
+/**
+ * @brief All boards move all knobs every scan and press buttons, far more than the line carries. Every board and
+ * every hop forwards under load: nothing may arrive garbled, every button press arrives once and in order, and
+ * the last value of every knob arrives once the chain is drained
+ *
+ */
+static void testForwardingUnderLoad(uint8_t wire_format)
+{
+    Chain chain(wire_format);
+    uint16_t scan = 0;
+    uint16_t pressed[CHAIN_BOARDS] = {};
+    std::vector<uint16_t> buttons[CHAIN_BOARDS];
+    while (chain.now_us < CHAIN_LOAD_US)
+    {
+        if (chain.now_us % CHAIN_LOAD_SCAN_US == 0)
+        {
+            scan++;
+            for (int p = 0; p < CHAIN_BOARDS; p++)
+            {
+                for (int k = 0; k < CHAIN_KNOB_COUNT; k++)
+                {
+                    chain.mailboxes[p].put(CHAIN_KNOB_START + k, (scan * 7 + p * 31 + k * 101) & 0x3FFF);
+                }
+                // A button press every 5 scans, staggered over the boards
+                if ((scan + p) % 5 == 0)
+                {
+                    queue_entry_t entry = {(uint8_t)(pressed[p] % CHAIN_KNOB_START), (uint16_t)(pressed[p] & 0x7F)};
+                    if (queue_try_add(&chain.queues[p], &entry))
+                    {
+                        buttons[p].push_back((entry.index << 8) | entry.value);
+                    }
+                    pressed[p]++;
+                }
+            }
+        }
+        chain.step();
+    }
+    chain.runUntilIdle(CHAIN_DRAIN_US);
+    HOST_CHECK(chain.isIdle());
+
+    uint32_t truncated = 0;
+    uint32_t lost = 0;
+    long wrong_final = 0;
+    long knob_min = -1;
+    for (int p = 0; p < CHAIN_BOARDS; p++)
+    {
+        truncated += chain.uplinks[p]->getForwardTruncated();
+        lost += chain.uplinks[p]->getForwardLostBytes();
+        HOST_CHECK(chain.pi.buttons[p] == buttons[p]);
+        long knob_count = 0;
+        for (int k = 0; k < CHAIN_KNOB_COUNT; k++)
+        {
+            if (chain.pi.value[p][CHAIN_KNOB_START + k] != ((scan * 7 + p * 31 + k * 101) & 0x3FFF))
+            {
+                wrong_final++;
+            }
+            knob_count += chain.pi.count[p][CHAIN_KNOB_START + k];
+        }
+        if (knob_min < 0 || knob_count < knob_min)
+        {
+            knob_min = knob_count;
+        }
+    }
+    printf("%s under load: %ld messages at the Pi, %ld knob values of the slowest board, malformed %ld, truncated %u, lost bytes %u, wrong final values %ld\n",
+           wire_format == DATA_FORMATTER_WIRE_LEGACY ? "Legacy" : "Compact", chain.pi.messages, knob_min,
+           chain.pi.malformed, (unsigned)truncated, (unsigned)lost, wrong_final);
+    HOST_CHECK(chain.pi.malformed == 0);
+    HOST_CHECK(truncated == 0);
+    HOST_CHECK(lost == 0);
+    HOST_CHECK(wrong_final == 0);
+}
+
+int main()
+{
+    testLatency();
+    testForwardingUnderLoad(DATA_FORMATTER_WIRE_LEGACY);
+    testForwardingUnderLoad(DATA_FORMATTER_WIRE_COMPACT);
+    return host_test_result();
+}
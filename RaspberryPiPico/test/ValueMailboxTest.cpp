@@ -0,0 +1,183 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "HostTest.h"
+#include "HostSdk.h"
+#include "pico/util/queue.h"
+#include "ValueMailbox.h"
+
+#define MAILBOX_TEST_KNOB_START 6 // Knob controller indices 6 - 13 as on the board
+#define MAILBOX_TEST_KNOB_COUNT 8
+#define MAILBOX_TEST_SCANS 16000   // Every scan moves all 8 knobs, the value is the scan number (fits in 14 bit)
+#define MAILBOX_TEST_SCAN_NS 2000  // core0: time of one knob scan
+#define MAILBOX_TEST_SEND_NS 1000  // core1: time to send one message, 8 messages per scan take longer than a scan
+#define MAILBOX_TEST_QUEUE_SIZE 300 // message_queue before the mailbox
+
+typedef std::chrono::steady_clock test_clock;
+
+/**
+ * @brief Busy time of one core. Yields, so the other core also gets to run on a host with a single CPU
+ *
+ */
+static void spinNs(long ns)
+{
+    auto end = test_clock::now() + std::chrono::nanoseconds(ns);
+    do
+    {
+        std::this_thread::yield();
+    } while (test_clock::now() < end);
+}
+
+struct TransferResult
+{
+    long sent = 0;
+    long stale = 0;   // Values taken after a newer value of the same knob
+    long final_mismatches = 0;
+    double blocked_ms = 0;
+    double duration_ms = 0;
+};
+
+/**
+ * @brief core0 puts a full 8 knob sweep per scan, core1 drains the mailbox at the UART rate.
+ * The newest value of every knob has to arrive, and never before an older one
+ *
+ */
+static TransferResult runMailbox(long scan_ns, long send_ns)
+{
+    ValueMailbox mailbox;
+    std::atomic<bool> done(false);
+    TransferResult result;
+    uint16_t last_taken[VALUE_MAILBOX_SLOTS] = {};
+    bool taken_any[VALUE_MAILBOX_SLOTS] = {};
+    auto start = test_clock::now();
+
+    std::thread core1([&] {
+        queue_entry_t entry;
+        while (true)
+        {
+            bool producer_done = done.load();
+            if (mailbox.take(&entry))
+            {
+                if (taken_any[entry.index] && entry.value <= last_taken[entry.index])
+                {
+                    result.stale++;
+                }
+                taken_any[entry.index] = true;
+                last_taken[entry.index] = entry.value;
+                result.sent++;
+                spinNs(send_ns);
+            }
+            else if (producer_done && mailbox.isEmpty())
+            {
+                break;
+            }
+        }
+    });
+    for (uint16_t scan = 0; scan < MAILBOX_TEST_SCANS; scan++)
+    {
+        for (uint8_t knob = 0; knob < MAILBOX_TEST_KNOB_COUNT; knob++)
+        {
+            mailbox.put(MAILBOX_TEST_KNOB_START + knob, scan);
+        }
+        spinNs(scan_ns);
+    }
+    done = true;
+    core1.join();
+
+    result.duration_ms = std::chrono::duration<double, std::milli>(test_clock::now() - start).count();
+    for (uint8_t knob = 0; knob < MAILBOX_TEST_KNOB_COUNT; knob++)
+    {
+        result.final_mismatches += last_taken[MAILBOX_TEST_KNOB_START + knob] != MAILBOX_TEST_SCANS - 1;
+    }
+    return result;
+}
+
+/**
+ * @brief Same workload through the 300 entry message_queue with queue_add_blocking() as before the mailbox
+ *
+ */
+static TransferResult runQueue(long scan_ns, long send_ns)
+{
+    queue_t queue;
+    queue_init(&queue, sizeof(queue_entry_t), MAILBOX_TEST_QUEUE_SIZE);
+    std::atomic<bool> done(false);
+    TransferResult result;
+    uint16_t last_taken[VALUE_MAILBOX_SLOTS] = {};
+    auto start = test_clock::now();
+
+    std::thread core1([&] {
+        queue_entry_t entry;
+        while (true)
+        {
+            bool producer_done = done.load();
+            if (queue_try_remove(&queue, &entry))
+            {
+                last_taken[entry.index] = entry.value;
+                result.sent++;
+                spinNs(send_ns);
+            }
+            else if (producer_done)
+            {
+                break;
+            }
+        }
+    });
+    test_clock::duration blocked = test_clock::duration::zero();
+    for (uint16_t scan = 0; scan < MAILBOX_TEST_SCANS; scan++)
+    {
+        for (uint8_t knob = 0; knob < MAILBOX_TEST_KNOB_COUNT; knob++)
+        {
+            queue_entry_t entry = {(uint8_t)(MAILBOX_TEST_KNOB_START + knob), scan};
+            if (!queue_try_add(&queue, &entry))
+            {
+                auto block_start = test_clock::now();
+                queue_add_blocking(&queue, &entry);
+                blocked += test_clock::now() - block_start;
+            }
+        }
+        spinNs(scan_ns);
+    }
+    done = true;
+    core1.join();
+    queue_free(&queue);
+
+    result.duration_ms = std::chrono::duration<double, std::milli>(test_clock::now() - start).count();
+    result.blocked_ms = std::chrono::duration<double, std::milli>(blocked).count();
+    for (uint8_t knob = 0; knob < MAILBOX_TEST_KNOB_COUNT; knob++)
+    {
+        result.final_mismatches += last_taken[MAILBOX_TEST_KNOB_START + knob] != MAILBOX_TEST_SCANS - 1;
+    }
+    return result;
+}
+
+static void testMailboxStress()
+{
+    // Paced like the board, then both cores as fast as they can for the most interleavings
+    for (int run = 0; run < 4; run++)
+    {
+        bool paced = (run == 0);
+        TransferResult result = runMailbox(paced ? MAILBOX_TEST_SCAN_NS : 0, paced ? MAILBOX_TEST_SEND_NS : 0);
+        printf("mailbox%s: %ld messages sent for %d knob updates, %ld stale, %ld final values missing, %.1f ms, core0 never blocks\n",
+               paced ? "" : " (unpaced)", result.sent, MAILBOX_TEST_SCANS * MAILBOX_TEST_KNOB_COUNT, result.stale,
+               result.final_mismatches, result.duration_ms);
+        HOST_CHECK(result.stale == 0);
+        HOST_CHECK(result.final_mismatches == 0);
+        HOST_CHECK(result.sent <= MAILBOX_TEST_SCANS * MAILBOX_TEST_KNOB_COUNT);
+    }
+}
+
+static void benchmarkQueue()
+{
+    TransferResult result = runQueue(MAILBOX_TEST_SCAN_NS, MAILBOX_TEST_SEND_NS);
+    printf("message_queue: %ld messages sent, core0 blocked %.1f ms of %.1f ms\n", result.sent, result.blocked_ms,
+           result.duration_ms);
+    HOST_CHECK(result.sent == MAILBOX_TEST_SCANS * MAILBOX_TEST_KNOB_COUNT);
+    HOST_CHECK(result.final_mismatches == 0);
+}
+
+int main()
+{
+    testMailboxStress();
+    benchmarkQueue();
+    return host_test_result();
+}
@@ -0,0 +1,203 @@
+#ifndef __HOST_ADS1015_H__
+#define __HOST_ADS1015_H__
+
+#include <stdint.h>
+#include "HostSdk.h"
+#include "ADS1X15.h"
+
+#define HOST_ADS1015_WAKE_UP_US 25 // Single-shot power-up before the conversion starts (datasheet)
+#define HOST_ADS1015_RESULT_SHIFT 4 // 12 bit results are left aligned in the conversion register
+
+/**
+ * @brief Simulated ADS1015 on a host I2C bus: register pointer protocol, single-shot and continuous conversions
+ * timed by an internal oscillator that can be off by clock_factor, and the ALERT/RDY conversion ready signal.
+ *
+ * Every conversion uses the input the mux selected when the conversion started. In continuous mode a config
+ * write does not restart the running conversion, so the conversion after a mux change may still belong to the
+ * old input.
+ *
+ */
+class HostAds1015 : public HostI2cDevice
+{
+public:
+    uint16_t input[4] = {0, 0, 0, 0}; // 12 bit counts on AIN0 - AIN3
+    double clock_factor = 1.0;        // Conversion time multiplier: 1.1 = oscillator 10% slow
+    uint32_t conversion_count = 0;
+    uint32_t alert_count = 0;
+    uint32_t early_result_reads = 0; // Conversion register read while a single-shot conversion was still running
+
+    int write(const uint8_t *data, size_t size, bool nostop) override
+    {
+        (void)nostop;
+        this->update();
+        this->pointer = data[0] & ADS1X15_REG_POINTER_MASK;
+        if (size >= 3)
+        {
+            uint16_t value = (uint16_t)((data[1] << 8) | data[2]);
+            switch (this->pointer)
+            {
+            case ADS1X15_REG_POINTER_CONFIG:
+                this->writeConfig(value);
+                break;
+            case ADS1X15_REG_POINTER_LOWTHRESH:
+                this->low_threshold = value;
+                break;
+            case ADS1X15_REG_POINTER_HITHRESH:
+                this->high_threshold = value;
+                break;
+            }
+        }
+        return (int)size;
+    }
+
+    int read(uint8_t *data, size_t size, bool nostop) override
+    {
+        (void)nostop;
+        this->update();
+        uint16_t value = 0;
+        switch (this->pointer)
+        {
+        case ADS1X15_REG_POINTER_CONVERT:
+            value = this->conversion;
+            if (this->busy && !this->continuous)
+            {
+                this->early_result_reads++;
+            }
+            break;
+        case ADS1X15_REG_POINTER_CONFIG:
+            value = (this->config & ~ADS1X15_REG_CONFIG_OS_MASK) | (this->busy ? ADS1X15_REG_CONFIG_OS_BUSY : ADS1X15_REG_CONFIG_OS_NOTBUSY);
+            break;
+        case ADS1X15_REG_POINTER_LOWTHRESH:
+            value = this->low_threshold;
+            break;
+        case ADS1X15_REG_POINTER_HITHRESH:
+            value = this->high_threshold;
+            break;
+        }
+        for (size_t i = 0; i < size; i++)
+        {
+            data[i] = (i == 0) ? (uint8_t)(value >> 8) : ((i == 1) ? (uint8_t)value : 0);
+        }
+        return (int)size;
+    }
+
+    /**
+     * @brief True once for every ALERT/RDY pulse since the last call (the falling edge the GPIO interrupt sees)
+     *
+     */
+    bool takeAlert()
+    {
+        this->update();
+        if (this->alert_pending == 0)
+        {
+            return false;
+        }
+        this->alert_pending--;
+        return true;
+    }
+
+    /**
+     * @brief Time the running conversion finishes, 0 when idle
+     *
+     */
+    uint64_t getConversionEndUs()
+    {
+        this->update();
+        return this->busy ? this->conversion_end_us : 0;
+    }
+
+    /**
+     * @brief AIN the result in the conversion register belongs to
+     *
+     */
+    uint8_t getResultChannel()
+    {
+        this->update();
+        return this->result_channel;
+    }
+
+private:
+    uint8_t pointer = 0;
+    uint16_t config = 0x8583; // Power up default: single-shot, 1600 SPS, comparator disabled
+    uint16_t conversion = 0;
+    uint16_t low_threshold = 0x8000;
+    uint16_t high_threshold = 0x7FFF;
+    bool busy = false;
+    bool continuous = false;
+    uint8_t conversion_channel = 0;
+    uint8_t result_channel = 0;
+    uint64_t conversion_end_us = 0;
+    uint32_t alert_pending = 0;
+
+    uint8_t muxChannel()
+    {
+        return (uint8_t)(((this->config & ADS1X15_REG_CONFIG_MUX_MASK) - ADS1X15_REG_CONFIG_MUX_SINGLE_0) >> 12) & 0x03;
+    }
+
+    uint64_t periodUs()
+    {
+        static const uint32_t rates[8] = {128, 250, 490, 920, 1600, 2400, 3300, 3300};
+        uint32_t rate = rates[(this->config & ADS1X15_REG_CONFIG_RATE_MASK) >> 5];
+        return (uint64_t)(1000000.0 / rate * this->clock_factor + 0.5);
+    }
+
+    bool isConversionReadyMode()
+    {
+        return (this->high_threshold & 0x8000) && !(this->low_threshold & 0x8000) &&
+               (this->config & ADS1X15_REG_CONFIG_CQUE_MASK) != ADS1X15_REG_CONFIG_CQUE_NONE;
+    }
+
+    void startConversion(uint64_t start_us)
+    {
+        this->busy = true;
+        this->conversion_channel = this->muxChannel();
+        this->conversion_end_us = start_us + this->periodUs();
+    }
+
+    void writeConfig(uint16_t value)
+    {
+        this->config = value;
+        uint64_t now_us = time_us_64();
+        if (!(value & ADS1X15_REG_CONFIG_MODE_MASK))
+        {
+            // Continuous: a running conversion finishes on the input it started with
+            if (!this->continuous)
+            {
+                this->continuous = true;
+                if (!this->busy)
+                {
+                    this->startConversion(now_us + HOST_ADS1015_WAKE_UP_US);
+                }
+            }
+            return;
+        }
+        this->continuous = false;
+        if ((value & ADS1X15_REG_CONFIG_OS_MASK) && !this->busy)
+        {
+            this->startConversion(now_us + HOST_ADS1015_WAKE_UP_US);
+        }
+    }
+
+    void update()
+    {
+        uint64_t now_us = time_us_64();
+        while (this->busy && now_us >= this->conversion_end_us)
+        {
+            this->conversion = (uint16_t)(this->input[this->conversion_channel] << HOST_ADS1015_RESULT_SHIFT);
+            this->result_channel = this->conversion_channel;
+            this->conversion_count++;
+            this->busy = false;
+            if (this->isConversionReadyMode())
+            {
+                this->alert_pending++;
+                this->alert_count++;
+            }
+            if (this->continuous)
+            {
+                this->startConversion(this->conversion_end_us);
+            }
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef __HOST_EEPROM_24LC32_H__
+#define __HOST_EEPROM_24LC32_H__
+
+#include <stdint.h>
+#include <string.h>
+#include "HostSdk.h"
+
+#define HOST_EEPROM_SIZE 4096
+#define HOST_EEPROM_PAGE_SIZE 32
+#define HOST_EEPROM_WRITE_CYCLE_US 5000 // Page write time, the device does not acknowledge its address meanwhile
+
+#define HOST_EEPROM_CUT_TORN 0  // The first cut_bytes bytes are programmed, the next one is garbled
+#define HOST_EEPROM_CUT_MIXED 1 // Every byte of the page write is either old or new
+
+/**
+ * @brief Thrown out of the I2C transfer when the power fails during a page write
+ *
+ */
+struct HostPowerLoss
+{
+};
+
+/**
+ * @brief Simulated 24LC32 on a host I2C bus: two address bytes set the address pointer, data bytes after them are
+ * one page write that wraps inside its 32 byte page. Reads are sequential from the address pointer. During the
+ * write cycle the device does not acknowledge its address.
+ *
+ * Power loss: data write number cut_write (counted from 0 since the last powerCycle()) programs only part of its
+ * bytes, then HostPowerLoss is thrown out of the transfer.
+ *
+ */
+class HostEeprom24LC32 : public HostI2cDevice
+{
+public:
+    uint8_t memory[HOST_EEPROM_SIZE];
+    long data_writes = 0;
+    long cut_write = -1;
+    int cut_mode = HOST_EEPROM_CUT_TORN;
+    int cut_bytes = 0;
+    uint32_t random_state = 1;
+
+    HostEeprom24LC32()
+    {
+        memset(this->memory, 0xFF, sizeof(this->memory));
+    }
+
+    int write(const uint8_t *data, size_t size, bool nostop) override
+    {
+        (void)nostop;
+        if (this->isBusy() || size < 2)
+        {
+            return PICO_ERROR_GENERIC;
+        }
+        this->pointer = ((data[0] << 8) | data[1]) & (HOST_EEPROM_SIZE - 1);
+        if (size == 2)
+        {
+            return (int)size;
+        }
+        size_t length = size - 2;
+        long write_index = this->data_writes++;
+        bool cut = (write_index == this->cut_write);
+        for (size_t i = 0; i < length; i++)
+        {
+            uint16_t address = (this->pointer & ~(HOST_EEPROM_PAGE_SIZE - 1)) | ((this->pointer + i) & (HOST_EEPROM_PAGE_SIZE - 1));
+            uint8_t value = data[i + 2];
+            if (!cut)
+            {
+                this->memory[address] = value;
+            }
+            else if (this->cut_mode == HOST_EEPROM_CUT_MIXED)
+            {
+                if (this->random() & 1)
+                {
+                    this->memory[address] = value;
+                }
+            }
+            else if ((int)i < this->cut_bytes)
+            {
+                this->memory[address] = value;
+            }
+            else if ((int)i == this->cut_bytes)
+            {
+                // Interrupted while programming: some bits of the new value, at least one bit wrong
+                uint8_t changed = (uint8_t)((this->random() | 1) & ((this->memory[address] ^ value) | 0x01));
+                this->memory[address] ^= changed;
+            }
+        }
+        if (cut)
+        {
+            throw HostPowerLoss();
+        }
+        this->busy_until_us = time_us_64() + HOST_EEPROM_WRITE_CYCLE_US;
+        return (int)size;
+    }
+
+    int read(uint8_t *data, size_t size, bool nostop) override
+    {
+        (void)nostop;
+        if (this->isBusy())
+        {
+            return PICO_ERROR_GENERIC;
+        }
+        for (size_t i = 0; i < size; i++)
+        {
+            data[i] = this->memory[this->pointer];
+            this->pointer = (this->pointer + 1) & (HOST_EEPROM_SIZE - 1);
+        }
+        return (int)size;
+    }
+
+    bool isBusy()
+    {
+        return time_us_64() < this->busy_until_us;
+    }
+
+    /**
+     * @brief Power off and on: the write cycle in progress is over, the data write count restarts
+     *
+     */
+    void powerCycle()
+    {
+        this->busy_until_us = 0;
+        this->data_writes = 0;
+        this->cut_write = -1;
+    }
+
+protected:
+    uint16_t pointer = 0;
+    uint64_t busy_until_us = 0;
+
+    uint32_t random()
+    {
+        this->random_state = this->random_state * 1103515245 + 12345;
+        return this->random_state >> 8;
+    }
+};
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef __UART_RX_RING_H__
+#define __UART_RX_RING_H__
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <deque>
+#include "pico/stdlib.h"
+#include "hardware/uart.h"
+
+#define UART_RX_RING_BITS 10
+#define UART_RX_RING_SIZE (1 << UART_RX_RING_BITS)
+#define UART_RX_RING_MASK (UART_RX_RING_SIZE - 1)
+
+/**
+ * @brief Host stand-in for the DMA receive ring, with the interface of UartRx/inc/UartRxRing.h. The test delivers
+ * the bytes of the line with receive(), a byte that finds the ring full overwrites nothing and is counted as lost.
+ *
+ */
+class UartRxRing
+{
+protected:
+    std::deque<uint8_t> received;
+    uint32_t high_water = 0;
+    uint32_t overrun_count = 0;
+    uint32_t lost_bytes = 0;
+
+public:
+    UartRxRing(uart_inst_t *uart) {}
+    void init() {}
+    uint32_t available() { return this->received.size(); }
+    bool read(uint8_t *c)
+    {
+        if (this->received.empty())
+        {
+            return false;
+        }
+        *c = this->received.front();
+        this->received.pop_front();
+        return true;
+    }
+    uint32_t getHighWater() { return this->high_water; }
+    uint32_t getOverrunCount() { return this->overrun_count; }
+    uint32_t getLostBytes() { return this->lost_bytes; }
+    void resetStatistics() { this->high_water = 0; }
+
+    void receive(uint8_t c)
+    {
+        if (this->received.size() >= UART_RX_RING_SIZE)
+        {
+            this->overrun_count++;
+            this->lost_bytes++;
+            return;
+        }
+        this->received.push_back(c);
+        if (this->received.size() > this->high_water)
+        {
+            this->high_water = this->received.size();
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef __UART_TX_RING_H__
+#define __UART_TX_RING_H__
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <deque>
+#include "pico/stdlib.h"
+#include "hardware/uart.h"
+
+#define UART_TX_RING_BITS 10
+#define UART_TX_RING_SIZE (1 << UART_TX_RING_BITS)
+#define UART_TX_RING_MASK (UART_TX_RING_SIZE - 1)
+
+/**
+ * @brief Host stand-in for the DMA transmit ring, with the interface of UartTx/inc/UartTxRing.h. The firmware
+ * ring uses one static buffer per UART, a chain simulation needs one ring per board. The test plays the line:
+ * takeByte() removes the next byte once its line time is over.
+ *
+ */
+class UartTxRing
+{
+protected:
+    std::deque<uint8_t> pending;
+    uint32_t high_water = 0;
+
+public:
+    UartTxRing(uart_inst_t *uart) {}
+    void init() {}
+    void service() {}
+    bool write(const uint8_t *data, uint32_t length)
+    {
+        if (length > this->getFree())
+        {
+            return false;
+        }
+        this->pending.insert(this->pending.end(), data, data + length);
+        if (this->pending.size() > this->high_water)
+        {
+            this->high_water = this->pending.size();
+        }
+        return true;
+    }
+    uint32_t getFree() { return UART_TX_RING_SIZE - this->pending.size(); }
+    uint32_t getUsed() { return this->pending.size(); }
+    uint32_t getHighWater() { return this->high_water; }
+    uint32_t getStallCount() { return 0; }
+    uint32_t getStallUs() { return 0; }
+    uint32_t getStallMaxUs() { return 0; }
+    void resetStatistics() { this->high_water = 0; }
+
+    bool takeByte(uint8_t *c)
+    {
+        if (this->pending.empty())
+        {
+            return false;
+        }
+        *c = this->pending.front();
+        this->pending.pop_front();
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,355 @@
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <stdlib.h>
+#include <string.h>
+#include "HostSdk.h"
+#include "pico/util/queue.h"
+#include "hardware/pio.h"
+
+#define HOST_GPIO_COUNT 30
+#define HOST_I2C_DEFAULT_BAUDRATE 100000
+#define HOST_I2C_BITS_PER_BYTE 9 // 8 data bits and the ACK
+#define HOST_I2C_FRAME_BITS 2    // START and STOP condition
+
+struct i2c_inst
+{
+    uint baudrate;
+    HostI2cDevice *devices[HOST_I2C_ADDRESS_COUNT];
+};
+
+static i2c_inst_t host_i2c_instances[2] = {{HOST_I2C_DEFAULT_BAUDRATE, {}}, {HOST_I2C_DEFAULT_BAUDRATE, {}}};
+i2c_inst_t *i2c0 = &host_i2c_instances[0];
+i2c_inst_t *i2c1 = &host_i2c_instances[1];
+
+struct uart_inst
+{
+    uint baudrate;
+    uart_hw_t hw;
+};
+
+static uart_inst_t host_uart_instances[2] = {};
+uart_inst_t *uart0 = &host_uart_instances[0];
+uart_inst_t *uart1 = &host_uart_instances[1];
+PIO pio0 = NULL;
+PIO pio1 = NULL;
+static alarm_id_t host_alarm_count = 0;
+
+static uint64_t host_now_us = 0;
+static bool host_gpio_level[HOST_GPIO_COUNT] = {};
+
+// Test control
+
+void host_time_set_us(uint64_t now_us)
+{
+    host_now_us = now_us;
+}
+
+void host_time_advance_us(uint64_t delta_us)
+{
+    host_now_us += delta_us;
+}
+
+void host_i2c_attach(i2c_inst_t *i2c, uint8_t address, HostI2cDevice *device)
+{
+    i2c->devices[address & (HOST_I2C_ADDRESS_COUNT - 1)] = device;
+}
+
+void host_i2c_detach_all()
+{
+    for (i2c_inst_t &instance : host_i2c_instances)
+    {
+        memset(instance.devices, 0, sizeof(instance.devices));
+    }
+}
+
+/**
+ * @brief Bus time of a transfer of size data bytes: address byte, data bytes and the START/STOP condition
+ *
+ * @param i2c
+ * @param size
+ * @return uint32_t
+ */
+uint32_t host_i2c_get_transfer_us(i2c_inst_t *i2c, size_t size)
+{
+    uint64_t bits = (size + 1) * HOST_I2C_BITS_PER_BYTE + HOST_I2C_FRAME_BITS;
+    return (uint32_t)((bits * 1000000 + i2c->baudrate - 1) / i2c->baudrate);
+}
+
+void host_gpio_set(uint gpio, bool value)
+{
+    host_gpio_level[gpio % HOST_GPIO_COUNT] = value;
+}
+
+// pico/stdlib.h
+
+uint64_t time_us_64()
+{
+    return host_now_us;
+}
+
+uint32_t time_us_32()
+{
+    return (uint32_t)host_now_us;
+}
+
+void sleep_us(uint64_t us)
+{
+    host_now_us += us;
+}
+
+void sleep_ms(uint32_t ms)
+{
+    host_now_us += (uint64_t)ms * 1000;
+}
+
+void busy_wait_us_32(uint32_t delay_us)
+{
+    host_now_us += delay_us;
+}
+
+void busy_wait_us(uint64_t delay_us)
+{
+    host_now_us += delay_us;
+}
+
+void busy_wait_ms(uint32_t delay_ms)
+{
+    host_now_us += (uint64_t)delay_ms * 1000;
+}
+
+void tight_loop_contents()
+{
+}
+
+alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback, void *user_data, bool fire_if_past)
+{
+    (void)ms;
+    (void)callback;
+    (void)user_data;
+    (void)fire_if_past;
+    return ++host_alarm_count;
+}
+
+bool cancel_alarm(alarm_id_t alarm_id)
+{
+    (void)alarm_id;
+    return true;
+}
+
+bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback, void *user_data, repeating_timer_t *out)
+{
+    out->delay_us = delay_us;
+    out->callback = callback;
+    out->user_data = user_data;
+    return true;
+}
+
+// hardware/sync.h: the tests run the interrupt handlers from the test thread
+
+uint32_t save_and_disable_interrupts()
+{
+    return 0;
+}
+
+void restore_interrupts(uint32_t status)
+{
+    (void)status;
+}
+
+void __dmb()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+void __compiler_memory_barrier()
+{
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+}
+
+// hardware/gpio.h
+
+void gpio_init(uint gpio)
+{
+    host_gpio_level[gpio % HOST_GPIO_COUNT] = false;
+}
+
+void gpio_set_dir(uint gpio, bool out)
+{
+    (void)gpio;
+    (void)out;
+}
+
+void gpio_put(uint gpio, bool value)
+{
+    host_gpio_level[gpio % HOST_GPIO_COUNT] = value;
+}
+
+bool gpio_get(uint gpio)
+{
+    return host_gpio_level[gpio % HOST_GPIO_COUNT];
+}
+
+void gpio_pull_up(uint gpio)
+{
+    host_gpio_level[gpio % HOST_GPIO_COUNT] = true;
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn)
+{
+    (void)gpio;
+    (void)fn;
+}
+
+// hardware/uart.h
+
+uart_hw_t *uart_get_hw(uart_inst_t *uart)
+{
+    return &uart->hw;
+}
+
+uint uart_set_baudrate(uart_inst_t *uart, uint baudrate)
+{
+    uart->baudrate = baudrate;
+    return baudrate;
+}
+
+// hardware/pio.h
+
+void pio_sm_put(PIO pio, uint sm, uint32_t data)
+{
+    (void)pio;
+    (void)sm;
+    (void)data;
+}
+
+// hardware/i2c.h
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate)
+{
+    return i2c_set_baudrate(i2c, baudrate);
+}
+
+void i2c_deinit(i2c_inst_t *i2c)
+{
+    (void)i2c;
+}
+
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate)
+{
+    i2c->baudrate = baudrate;
+    return baudrate;
+}
+
+void i2c_set_slave_mode(i2c_inst_t *i2c, bool slave, uint8_t addr)
+{
+    (void)i2c;
+    (void)slave;
+    (void)addr;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop)
+{
+    HostI2cDevice *device = i2c->devices[addr & (HOST_I2C_ADDRESS_COUNT - 1)];
+    if (device == NULL)
+    {
+        // Address NACK: only the address byte is on the bus
+        host_now_us += host_i2c_get_transfer_us(i2c, 0);
+        return PICO_ERROR_GENERIC;
+    }
+    host_now_us += host_i2c_get_transfer_us(i2c, len);
+    return device->write(src, len, nostop);
+}
+
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop)
+{
+    HostI2cDevice *device = i2c->devices[addr & (HOST_I2C_ADDRESS_COUNT - 1)];
+    if (device == NULL)
+    {
+        host_now_us += host_i2c_get_transfer_us(i2c, 0);
+        return PICO_ERROR_GENERIC;
+    }
+    // The device shifts its data out right after the address byte
+    uint32_t address_us = host_i2c_get_transfer_us(i2c, 0);
+    host_now_us += address_us;
+    int result = device->read(dst, len, nostop);
+    host_now_us += host_i2c_get_transfer_us(i2c, len) - address_us;
+    return result;
+}
+
+// pico/util/queue.h: ring buffer, safe between threads like the SDK queue is between cores
+
+static std::mutex host_queue_mutex;
+
+void queue_init(queue_t *q, uint element_size, uint element_count)
+{
+    q->data = (uint8_t *)calloc(element_count, element_size);
+    q->element_size = element_size;
+    q->element_count = element_count;
+    q->read_index = 0;
+    q->level = 0;
+}
+
+void queue_free(queue_t *q)
+{
+    free(q->data);
+    q->data = NULL;
+}
+
+uint queue_get_level(queue_t *q)
+{
+    std::lock_guard<std::mutex> lock(host_queue_mutex);
+    return q->level;
+}
+
+bool queue_is_empty(queue_t *q)
+{
+    return queue_get_level(q) == 0;
+}
+
+bool queue_is_full(queue_t *q)
+{
+    return queue_get_level(q) == q->element_count;
+}
+
+bool queue_try_add(queue_t *q, const void *data)
+{
+    std::lock_guard<std::mutex> lock(host_queue_mutex);
+    if (q->level == q->element_count)
+    {
+        return false;
+    }
+    uint write_index = (q->read_index + q->level) % q->element_count;
+    memcpy(q->data + write_index * q->element_size, data, q->element_size);
+    q->level++;
+    return true;
+}
+
+bool queue_try_remove(queue_t *q, void *data)
+{
+    std::lock_guard<std::mutex> lock(host_queue_mutex);
+    if (q->level == 0)
+    {
+        return false;
+    }
+    memcpy(data, q->data + q->read_index * q->element_size, q->element_size);
+    q->read_index = (q->read_index + 1) % q->element_count;
+    q->level--;
+    return true;
+}
+
+void queue_add_blocking(queue_t *q, const void *data)
+{
+    while (!queue_try_add(q, data))
+    {
+        std::this_thread::yield();
+    }
+}
+
+void queue_remove_blocking(queue_t *q, void *data)
+{
+    while (!queue_try_remove(q, data))
+    {
+        std::this_thread::yield();
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef __HOST_SDK_H__
+#define __HOST_SDK_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+
+/**
+ * @brief Host side of the stubbed Pico SDK used by the tests in RaspberryPiPico/test.
+ *
+ * Time is virtual: it only moves when the test advances it or the firmware waits (sleep_*, busy_wait_*)
+ * or transfers bytes on an I2C bus. An I2C transfer takes the time of its bits at the bus baudrate. A device
+ * sees a write once all bytes are on the bus and answers a read right after the address byte.
+ *
+ */
+
+#define HOST_I2C_ADDRESS_COUNT 128
+
+/**
+ * @brief Simulated I2C device. Return the number of bytes acknowledged or PICO_ERROR_GENERIC for a NACK
+ *
+ */
+class HostI2cDevice
+{
+public:
+    virtual ~HostI2cDevice() {}
+    virtual int write(const uint8_t *data, size_t size, bool nostop) = 0;
+    virtual int read(uint8_t *data, size_t size, bool nostop) = 0;
+};
+
+void host_time_set_us(uint64_t now_us);
+void host_time_advance_us(uint64_t delta_us);
+
+void host_i2c_attach(i2c_inst_t *i2c, uint8_t address, HostI2cDevice *device);
+void host_i2c_detach_all();
+uint32_t host_i2c_get_transfer_us(i2c_inst_t *i2c, size_t size);
+
+void host_gpio_set(uint gpio, bool value);
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef __HOST_HARDWARE_I2C_H__
+#define __HOST_HARDWARE_I2C_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef unsigned int uint;
+typedef struct i2c_inst i2c_inst_t;
+
+extern i2c_inst_t *i2c0;
+extern i2c_inst_t *i2c1;
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate);
+void i2c_deinit(i2c_inst_t *i2c);
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate);
+void i2c_set_slave_mode(i2c_inst_t *i2c, bool slave, uint8_t addr);
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop);
+
+#endif
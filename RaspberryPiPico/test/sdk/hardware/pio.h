@@ -0,0 +1,15 @@
+#ifndef __HOST_HARDWARE_PIO_H__
+#define __HOST_HARDWARE_PIO_H__
+
+#include "pico/stdlib.h"
+
+typedef struct pio_hw pio_hw_t;
+typedef pio_hw_t *PIO;
+
+extern PIO pio0;
+extern PIO pio1;
+
+// TX FIFO writes are dropped
+void pio_sm_put(PIO pio, uint sm, uint32_t data);
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef __HOST_HARDWARE_SYNC_H__
+#define __HOST_HARDWARE_SYNC_H__
+
+#include <stdint.h>
+
+uint32_t save_and_disable_interrupts();
+void restore_interrupts(uint32_t status);
+void __dmb();
+void __compiler_memory_barrier();
+
+#endif
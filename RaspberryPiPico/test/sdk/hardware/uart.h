@@ -0,0 +1,33 @@
+#ifndef __HOST_HARDWARE_UART_H__
+#define __HOST_HARDWARE_UART_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef unsigned int uint;
+typedef struct uart_inst uart_inst_t;
+
+extern uart_inst_t *uart0;
+extern uart_inst_t *uart1;
+
+// Raw interrupt status (receive errors) and interrupt clear registers only
+typedef struct
+{
+    volatile uint32_t ris;
+    volatile uint32_t icr;
+} uart_hw_t;
+
+#define UART_UARTRIS_OERIS_BITS 0x00000400
+#define UART_UARTRIS_BERIS_BITS 0x00000200
+#define UART_UARTRIS_PERIS_BITS 0x00000100
+#define UART_UARTRIS_FERIS_BITS 0x00000080
+#define UART_UARTICR_OEIC_BITS 0x00000400
+#define UART_UARTICR_BEIC_BITS 0x00000200
+#define UART_UARTICR_PEIC_BITS 0x00000100
+#define UART_UARTICR_FEIC_BITS 0x00000080
+
+uart_hw_t *uart_get_hw(uart_inst_t *uart);
+uint uart_set_baudrate(uart_inst_t *uart, uint baudrate);
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef __HOST_PICO_STDLIB_H__
+#define __HOST_PICO_STDLIB_H__
+
+// Host build of the Pico SDK subset used by the firmware modules (see HostSdk.h)
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef unsigned int uint;
+
+#define PICO_OK 0
+#define PICO_ERROR_TIMEOUT -1
+#define PICO_ERROR_GENERIC -2
+
+#define __isr
+#define __not_in_flash_func(func_name) func_name
+#define __time_critical_func(func_name) func_name
+#define count_of(a) (sizeof(a) / sizeof((a)[0]))
+
+uint64_t time_us_64();
+uint32_t time_us_32();
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+void busy_wait_us_32(uint32_t delay_us);
+void busy_wait_us(uint64_t delay_us);
+void busy_wait_ms(uint32_t delay_ms);
+void tight_loop_contents();
+
+// pico/time.h alarms: never fire on the host, the tests call the callbacks themselves
+typedef int32_t alarm_id_t;
+typedef int64_t (*alarm_callback_t)(alarm_id_t id, void *user_data);
+alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback, void *user_data, bool fire_if_past);
+bool cancel_alarm(alarm_id_t alarm_id);
+typedef struct repeating_timer repeating_timer_t;
+typedef bool (*repeating_timer_callback_t)(repeating_timer_t *rt);
+struct repeating_timer
+{
+    int64_t delay_us;
+    repeating_timer_callback_t callback;
+    void *user_data;
+};
+bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback, void *user_data, repeating_timer_t *out);
+
+#include "hardware/sync.h"
+#include "hardware/gpio.h"
+#include "hardware/uart.h"
+
+#endif